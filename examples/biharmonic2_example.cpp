@@ -112,6 +112,7 @@ int main(int argc, char *argv[])
     index_t smoothness = 2;
     bool last = false;
     bool second = false;
+    index_t scatter = 0;
 
     std::string fn;
 
@@ -121,6 +122,8 @@ int main(int argc, char *argv[])
     cmd.addInt("l", "refinementLoop", "Number of refinement steps",  numRefine);
     cmd.addString("f", "file", "Input geometry file (with .xml)", fn);
 
+    cmd.addInt("", "scatter", "Accumulation of element contributions: (0) critical sections; (1) thread-local buffers", scatter);
+
     cmd.addSwitch("last", "Solve problem only on the last level of h-refinement", last);
     cmd.addSwitch("plot", "Create a ParaView visualization file with the solution", plot);
 
@@ -193,6 +196,7 @@ int main(int argc, char *argv[])
 
     //! [Problem setup]
     gsExprAssembler<real_t> A(1,1);
+    A.options().setInt("scatter", scatter);
     //gsInfo<<"Active options:\n"<< A.options() <<"\n";
 
     // Elements used for numerical integration
@@ -0,0 +1,100 @@
+/** @file functionExpr_example.cpp
+
+    @brief Compares the assembly throughput of a right-hand side given
+    as a string (gsFunctionExpr) with the same function given as
+    compiled C++ code. With --jit the string is translated to native
+    code at runtime (see gsFunctionExpr::compile).
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+// The source function f(x,y) = 2 pi^2 sin(pi x) sin(pi y) as a C++ functor
+class sourceFunctor : public gsFunction<real_t>
+{
+public:
+    short_t domainDim() const { return 2; }
+
+    short_t targetDim() const { return 1; }
+
+    void eval_into(const gsMatrix<real_t>& u, gsMatrix<real_t>& result) const
+    {
+        const real_t pi = EIGEN_PI;
+        result.resize(1, u.cols());
+        for (index_t p = 0; p != u.cols(); ++p)
+            result(0,p) = 2*pi*pi * math::sin(pi*u(0,p)) * math::sin(pi*u(1,p));
+    }
+
+    GISMO_CLONE_FUNCTION(sourceFunctor)
+};
+
+int main(int argc, char *argv[])
+{
+    index_t numRefine  = 3;
+    index_t numElevate = 1;
+    index_t numRuns    = 1;
+    bool jit = false;
+
+    gsCmdLine cmd("Assembly throughput of a string-defined source term vs. a C++ functor.");
+    cmd.addInt( "e", "degreeElevation", "Number of degree elevation steps", numElevate );
+    cmd.addInt( "r", "uniformRefine", "Number of uniform h-refinement steps", numRefine );
+    cmd.addInt( "n", "runs", "Number of assembly runs per source term", numRuns );
+    cmd.addSwitch("jit", "Compile the string expression to native code", jit);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    gsMultiPatch<> mp( *gsNurbsCreator<>::BSplineSquare() );
+    gsMultiBasis<> dbasis(mp);
+    dbasis.degreeElevate(numElevate);
+    for (index_t r = 0; r < numRefine; ++r)
+        dbasis.uniformRefine();
+
+    gsFunctionExpr<> fstr("2*pi^2*sin(pi*x)*sin(pi*y)", 2);
+    sourceFunctor    fcpp;
+    if ( jit && !fstr.compile() )
+        gsWarn<< "Compilation failed, using the interpreter.\n";
+
+#ifdef _OPENMP
+    gsInfo<< "Available threads: "<< omp_get_max_threads() <<"\n";
+#endif
+    gsInfo<< "Elements: "<< dbasis.totalElements() <<", degree: "
+          << dbasis.maxCwiseDegree() <<"\n";
+
+    gsExprAssembler<> A(1,1);
+    A.setIntegrationElements(dbasis);
+    gsExprAssembler<>::geometryMap G = A.getMap(mp);
+    gsExprAssembler<>::space u = A.getSpace(dbasis);
+    u.setup();
+    A.initVector();
+
+    gsStopwatch timer;
+    gsMatrix<> rhs[2];
+    const gsFunction<> * src[2] = {&fstr, &fcpp};
+    const char * name[2] = {"gsFunctionExpr", "C++ functor"};
+    for (index_t i = 0; i != 2; ++i)
+    {
+        auto ff = A.getCoeff(*src[i], G);
+        timer.restart();
+        for (index_t k = 0; k != numRuns; ++k)
+        {
+            A.clearRhs();
+            A.assemble( u * ff * meas(G) );
+        }
+        const double t = timer.stop();
+        rhs[i] = A.rhs();
+        gsInfo<< std::setw(15) << name[i] <<": "<< t/numRuns <<" s/assembly, "
+              << (double)dbasis.totalElements()*numRuns/t <<" elements/s\n";
+    }
+
+    const real_t err = (rhs[0]-rhs[1]).norm();
+    gsInfo<< "Difference of the right-hand sides: "<< err <<"\n";
+    return err < 1e-8 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+/** @file hDomainQuery_example.cpp
+
+    @brief Measures the queries of the hierarchical domain tree
+    (gsHDomain) on a tree with many leaves.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+#include <random>
+
+using namespace gismo;
+
+typedef gsHDomain<2> hDomain;
+typedef hDomain::point point;
+
+// Makes a tree on an n x n grid of level 0 in which every other cell
+// (checkerboard pattern) is refined to level 1. The cells are inserted
+// in random order.
+void makeCheckerboard(hDomain & tree, index_t n)
+{
+    point upp;
+    upp.setConstant(n);
+    tree.init(upp);
+
+    std::vector<index_t> cells;
+    cells.reserve(n*n/2+1);
+    for (index_t j = 0; j != n; ++j)
+        for (index_t i = j%2; i < n; i += 2)
+            cells.push_back(j*n+i);
+    std::mt19937 gen(42);
+    std::shuffle(cells.begin(), cells.end(), gen);
+
+    point k1, k2;
+    for (size_t c = 0; c != cells.size(); ++c)
+    {
+        k1 << cells[c]%n, cells[c]/n;
+        k2 = k1.array() + 1;
+        tree.insertBox(2*k1, 2*k2, 1);
+    }
+    tree.makeCompressed();
+}
+
+int main(int argc, char *argv[])
+{
+    index_t n        = 1000;
+    index_t nBoxes   = 100;
+    index_t nQueries = 1000000;
+
+    gsCmdLine cmd("Timings of the queries of the hierarchical domain tree.");
+    cmd.addInt( "n", "cells", "Number of cells per direction (n^2 leaves)", n );
+    cmd.addInt( "b", "boxCells", "Number of cells per direction for getBoxes (whose merging of the boxes is quadratic)", nBoxes );
+    cmd.addInt( "q", "queries", "Number of queries", nQueries );
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    gsStopwatch timer;
+    hDomain tree;
+    makeCheckerboard(tree, n);
+    const real_t tBuild = timer.stop();
+    const std::pair<int,int> paths = tree.minMaxPath();
+    gsInfo << "Tree with "<< tree.leafSize() <<" leaves, "<< tree.size()
+           <<" nodes, path lengths "<< paths.first <<".."<< paths.second
+           <<", built in "<< tBuild <<" s\n";
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<index_t> cell(0, n-1);
+    std::vector<point, point::aalloc> low(nQueries), upp(nQueries);
+    for (index_t q = 0; q != nQueries; ++q)
+    {
+        // boxes of one or two cells of level 0
+        low[q] << cell(gen), cell(gen);
+        upp[q] = low[q].array() + 1;
+        if (q%2 && low[q][0] + 1 < n) ++upp[q][0];
+    }
+
+    // query3 and query4 of a box of a single cell give its level
+    bool ok = true;
+    index_t sum = 0;
+    timer.restart();
+    for (index_t q = 0; q != nQueries; ++q)
+        sum += tree.query3(low[q], upp[q], 0);
+    const real_t tQuery3 = timer.stop();
+    timer.restart();
+    for (index_t q = 0; q != nQueries; ++q)
+        sum -= tree.query4(low[q], upp[q], 0);
+    const real_t tQuery4 = timer.stop();
+    for (index_t q = 0; q < nQueries; q += 2)
+    {
+        const int lvl = (low[q][0] + low[q][1]) % 2 == 0 ? 1 : 0;
+        ok &= ( tree.query3(low[q], upp[q], 0) == lvl &&
+                tree.levelOf(low[q], 0) == lvl );
+    }
+    gsInfo << "query3      : "<< tQuery3/nQueries*1e9 <<" ns per query\n"
+           << "query4      : "<< tQuery4/nQueries*1e9 <<" ns per query\n";
+
+    timer.restart();
+    for (index_t q = 0; q != nQueries; ++q)
+        sum += tree.levelOf(low[q], 0);
+    gsInfo << "levelOf     : "<< timer.stop()/nQueries*1e9 <<" ns per query\n";
+
+    timer.restart();
+    for (hDomain::literator it = tree.beginLeafIterator(); it.good(); it.next())
+        sum += it.level();
+    gsInfo << "leaf iterate: "<< timer.stop()/tree.leafSize()*1e9 <<" ns per leaf ("<< sum <<")\n";
+
+    timer.restart();
+    hDomain copy(tree);
+    gsInfo << "copy        : "<< timer.stop() <<" s\n";
+    ok &= ( copy.leafSize() == tree.leafSize() );
+
+    hDomain small;
+    makeCheckerboard(small, nBoxes);
+    gsMatrix<index_t> b1, b2;
+    gsVector<index_t> level;
+    timer.restart();
+    small.getBoxes(b1, b2, level);
+    gsInfo << "getBoxes    : "<< timer.stop() <<" s for "<< small.leafSize() <<" leaves ("
+           << level.size() <<" boxes)\n";
+    // the refined cells touch only at their corners
+    ok &= ( (level.array() == 1).count() == (nBoxes*nBoxes+1)/2 );
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
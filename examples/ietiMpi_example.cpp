@@ -0,0 +1,230 @@
+/** @file ietiMpi_example.cpp
+
+    @brief Weak scaling benchmark for the distributed IETI-DP solver.
+
+    Each process owns a fixed number of patches of a grid of squares
+    and assembles, factorizes and applies only its own local problems.
+    Only the contributions to the Lagrange multipliers and to the
+    primal problem are exchanged between the processes. The number of
+    patches grows with the number of processes (weak scaling).
+
+    Execute (eg. with 4 processes):
+       mpirun -np 4 ./bin/ietiMpi_example
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    /************** Define command line options *************/
+
+    index_t columns = 2;
+    index_t rows = 2;
+    index_t refinements = 3;
+    index_t degree = 2;
+    real_t tolerance = 1.e-8;
+    index_t maxIterations = 100;
+
+    gsCmdLine cmd("Weak scaling of the distributed IETI-DP solver.\n"
+        "Execute (eg. with 4 processes):                                       "
+        "  *  mpirun -np 4 ./bin/ietiMpi_example");
+    cmd.addInt   ("x", "Columns",               "Number of columns of patches per process", columns);
+    cmd.addInt   ("y", "Rows",                  "Number of rows of patches", rows);
+    cmd.addInt   ("r", "Refinements",           "Number of uniform h-refinement steps to perform before solving", refinements);
+    cmd.addInt   ("p", "Degree",                "Degree of the B-spline discretization space", degree);
+    cmd.addReal  ("t", "Solver.Tolerance",      "Stopping criterion for linear solver", tolerance);
+    cmd.addInt   ("",  "Solver.MaxIterations",  "Maximum iterations for linear solver", maxIterations);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    const gsMpi & mpi = gsMpi::init(argc, argv);
+    gsMpiComm comm = mpi.worldComm();
+    const index_t nProcs = comm.size();
+    const index_t rank   = comm.rank();
+
+    if (rank==0)
+        gsInfo << "Run ietiMpi_example on " << nProcs << " processes with options:\n" << cmd << std::endl;
+
+    gsStopwatch timer;
+
+    /******************* Define geometry ********************/
+
+    // Process p owns the columns p*columns, ..., (p+1)*columns-1 of the grid
+    gsMultiPatch<> mp = gsNurbsCreator<>::BSplineSquareGrid(nProcs*columns, rows, 1);
+    const index_t nPatches = mp.nPatches();
+    const index_t patchesPerProcess = columns*rows;
+    const index_t firstPatch = rank*patchesPerProcess;
+    const index_t lastPatch  = firstPatch+patchesPerProcess;
+
+    gsFunctionExpr<> f( "2*sin(x)*cos(y)", 2 );
+    gsFunctionExpr<> gD( "sin(x)*cos(y)", 2 );
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it < mp.bEnd(); ++it)
+        bc.addCondition( *it, condition_type::dirichlet, &gD );
+    bc.setGeoMap(mp);
+
+    gsMultiBasis<> mb(mp);
+    for ( size_t i = 0; i < mb.nBases(); ++ i )
+        mb[i].setDegreePreservingMultiplicity(degree);
+    for ( index_t i = 0; i < refinements; ++i )
+        mb.uniformRefine();
+
+    /********* Setup assembler and assemble matrix **********/
+
+    typedef gsExprAssembler<>::geometryMap geometryMap;
+    typedef gsExprAssembler<>::space       space;
+    typedef gsExprAssembler<>::solution    solution;
+
+    // The dof mappers and the jump matrices only consist of index
+    // information, so every process sets them up for all patches
+    gsIetiMapper<> ietiMapper;
+    {
+        gsExprAssembler<> assembler;
+        space u = assembler.getSpace(mb);
+        u.setup(bc, dirichlet::interpolation, 0);
+        ietiMapper.init( mb, u.mapper(), u.fixedPart() );
+    }
+    ietiMapper.cornersAsPrimals();
+    ietiMapper.computeJumpMatrices(true, true);
+
+    gsIetiSystem<> ieti;
+    ieti.reserve(patchesPerProcess+1);
+    ieti.setCommunicator(comm);
+
+    gsScaledDirichletPrec<> prec;
+    prec.reserve(patchesPerProcess);
+    prec.setCommunicator(comm);
+
+    gsPrimalSystem<> primal(ietiMapper.nPrimalDofs());
+
+    index_t localDofs = 0;
+    for (index_t k=firstPatch; k<lastPatch; ++k)
+    {
+        gsBoundaryConditions<> bc_local;
+        bc.getConditionsForPatch(k,bc_local);
+        gsMultiPatch<> mp_local = mp[k];
+        gsMultiBasis<> mb_local = mb[k];
+
+        gsExprAssembler<> assembler(1,1);
+        assembler.setIntegrationElements(mb_local);
+        geometryMap G = assembler.getMap(mp_local);
+        space u = assembler.getSpace(mb_local);
+        bc_local.setGeoMap(mp_local);
+        u.setup(bc_local, dirichlet::interpolation, 0);
+        ietiMapper.initFeSpace(u,k);
+        auto ff = assembler.getCoeff(f, G);
+        assembler.initSystem();
+        assembler.assemble( igrad(u, G) * igrad(u, G).tr() * meas(G), u * ff * meas(G) );
+
+        gsSparseMatrix<real_t, RowMajor> jumpMatrix  = ietiMapper.jumpMatrix(k);
+        gsSparseMatrix<>                 localMatrix = assembler.matrix();
+        gsMatrix<>                       localRhs    = assembler.rhs();
+        localDofs += localMatrix.rows();
+
+        prec.addSubdomain(
+            gsScaledDirichletPrec<>::restrictToSkeleton(
+                jumpMatrix,
+                localMatrix,
+                ietiMapper.skeletonDofs(k)
+            )
+        );
+
+        primal.handleConstraints(
+            ietiMapper.primalConstraints(k),
+            ietiMapper.primalDofIndices(k),
+            jumpMatrix,
+            localMatrix,
+            localRhs
+        );
+
+        ieti.addSubdomain(
+            jumpMatrix.moveToPtr(),
+            makeMatrixOp(localMatrix.moveToPtr()),
+            give(localRhs)
+        );
+    }
+
+    // The primal problem is solved redundantly on all processes
+    primal.sumOverProcesses(comm);
+    gsLinearOperator<>::Ptr primalSolver = makeSparseCholeskySolver(primal.localMatrix());
+    ieti.addSharedSubdomain(
+        primal.jumpMatrix().moveToPtr(),
+        makeMatrixOp(primal.localMatrix().moveToPtr()),
+        give(primal.localRhs()),
+        primalSolver
+    );
+
+    /**************** Setup solver and solve ****************/
+
+    prec.setupMultiplicityScaling();
+    gsMatrix<> rhsForSchur = ieti.rhsForSchurComplement();
+    real_t setupTime = timer.stop();
+
+    timer.restart();
+    // The initial guess has to agree on all processes
+    gsMatrix<> lambda;
+    lambda.setZero( ieti.nLagrangeMultipliers(), 1 );
+    gsMatrix<> errorHistory;
+    gsConjugateGradient<> PCG( ieti.schurComplement(), prec.preconditioner() );
+    PCG.setOptions( cmd.getGroup("Solver") ).solveDetailed( rhsForSchur, lambda, errorHistory );
+
+    std::vector< gsMatrix<> > localSolutions = primal.distributePrimalSolution(
+        ieti.constructSolutionFromLagrangeMultipliers(lambda)
+    );
+    real_t solveTime = timer.stop();
+
+    /****************** Compute the error *******************/
+
+    real_t l2err2 = 0;
+    for (index_t k=firstPatch; k<lastPatch; ++k)
+    {
+        gsBoundaryConditions<> bc_local;
+        bc.getConditionsForPatch(k,bc_local);
+        gsMultiPatch<> mp_local = mp[k];
+        gsMultiBasis<> mb_local = mb[k];
+
+        gsExprAssembler<> assembler(1,1);
+        assembler.setIntegrationElements(mb_local);
+        gsExprEvaluator<> ev(assembler);
+        geometryMap G = assembler.getMap(mp_local);
+        space u = assembler.getSpace(mb_local);
+        bc_local.setGeoMap(mp_local);
+        u.setup(bc_local, dirichlet::interpolation, 0);
+        ietiMapper.initFeSpace(u,k);
+        solution u_sol = assembler.getSolution(u, localSolutions[k-firstPatch]);
+        auto u_ex = ev.getVariable(gD, G);
+        l2err2 += ev.integral( (u_sol - u_ex).sqNorm() * meas(G) );
+    }
+
+    comm.sum(&l2err2, 1);
+    comm.sum(&localDofs, 1);
+    const real_t maxSetupTime = comm.max(setupTime);
+    const real_t maxSolveTime = comm.max(solveTime);
+
+    /******************** Print end Exit ********************/
+
+    const index_t iter = errorHistory.rows()-1;
+    const bool success = errorHistory(iter,0) < tolerance;
+    if (rank==0)
+    {
+        gsInfo << "Patches:            " << nPatches << " (" << patchesPerProcess << " per process)\n"
+               << "Local dofs:         " << localDofs << "\n"
+               << "Lagrange mult.:     " << ieti.nLagrangeMultipliers() << "\n"
+               << "Primal dofs:        " << ietiMapper.nPrimalDofs() << "\n"
+               << "Iterations:         " << iter << (success ? "" : " (tolerance not reached)") << "\n"
+               << "Setup time:         " << maxSetupTime << " s\n"
+               << "Solve time:         " << maxSolveTime << " s\n"
+               << "L2 error:           " << math::sqrt(l2err2) << "\n";
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+/** @file kroneckerOp_example.cpp
+
+    @brief Checks gsKroneckerOp against the assembled Kronecker product
+    and measures the application of the tensor-product preconditioners
+    of gsPatchPreconditionersCreator on a 3D patch.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+// Returns the Kronecker product of the matrices \a mats
+gsMatrix<> kron(const std::vector< gsMatrix<> > & mats)
+{
+    gsMatrix<> result = mats[0];
+    for (size_t k = 1; k < mats.size(); ++k)
+    {
+        const gsMatrix<> & B = mats[k];
+        gsMatrix<> tmp(result.rows() * B.rows(), result.cols() * B.cols());
+        for (index_t i = 0; i < result.rows(); ++i)
+            for (index_t j = 0; j < result.cols(); ++j)
+                tmp.block(i * B.rows(), j * B.cols(), B.rows(), B.cols()) = result(i, j) * B;
+        result.swap(tmp);
+    }
+    return result;
+}
+
+// Times \a numApply applications of \a op for 1, 2, 4, ... threads
+void benchmark(const std::string & name, const gsLinearOperator<> & op, index_t numApply)
+{
+#   ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#   else
+    const int maxThreads = 1;
+#   endif
+    gsMatrix<> x, f;
+    f.setRandom(op.cols(), 1);
+    op.apply(f, x); // warm-up, allocates the workspace
+    gsInfo << name << ":\n";
+    for (int nt = 1; nt <= maxThreads; nt = (nt < maxThreads && 2*nt > maxThreads) ? maxThreads : 2*nt)
+    {
+#       ifdef _OPENMP
+        omp_set_num_threads(nt);
+#       endif
+        gsStopwatch timer;
+        for (index_t k = 0; k < numApply; ++k)
+            op.apply(f, x);
+        gsInfo << "  " << nt << " thread(s): " << timer.stop() / numApply << " s per application\n";
+    }
+#   ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#   endif
+}
+
+int main(int argc, char *argv[])
+{
+    index_t numDofs  = 216;
+    index_t degree   = 3;
+    index_t numApply = 5;
+    bool    scms     = false;
+
+    gsCmdLine cmd("Checks and benchmarks the application of Kronecker product operators.");
+    cmd.addInt   ("n", "dofs", "Number of basis functions per direction of the 3D patch", numDofs);
+    cmd.addInt   ("p", "degree", "Spline degree", degree);
+    cmd.addInt   ("a", "apply", "Number of applications per measurement", numApply);
+    cmd.addSwitch("scms", "Also measure the subspace corrected mass smoother", scms);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    // Correctness: dense, sparse and general factors, several right-hand sides
+    {
+        std::vector< gsMatrix<> > mats(3);
+        mats[0].setRandom(3, 4);
+        mats[1].setRandom(5, 3);
+        mats[2].setRandom(4, 6);
+        const gsSparseMatrix<> sparse = mats[2].sparseView();
+
+        std::vector<gsLinearOperator<>::Ptr> ops(3);
+        ops[0] = makeMatrixOp(mats[0]);
+        ops[1] = gsScaledOp<>::make(makeMatrixOp(mats[1]), 1); // general operator
+        ops[2] = makeMatrixOp(sparse);
+        gsKroneckerOp<> kronOp(ops);
+
+        gsMatrix<> input, x;
+        input.setRandom(kronOp.cols(), 3);
+        kronOp.apply(input, x);
+        kronOp.apply(input, x); // reusing the workspace
+        const real_t err = (x - kron(mats) * input).norm() / x.norm();
+        gsInfo << "Relative error of gsKroneckerOp: " << err << "\n";
+        if (err > 1e-12)
+            return EXIT_FAILURE;
+    }
+
+    gsKnotVector<> kv(0, 1, numDofs - degree - 1, degree + 1);
+    gsTensorBSplineBasis<3> basis(kv, kv, kv);
+
+    gsBoundaryConditions<> bc;
+    for (index_t ps = 1; ps <= 6; ++ps)
+        bc.addCondition(0, ps, condition_type::dirichlet, NULL);
+
+    gsStopwatch timer;
+    gsLinearOperator<>::Ptr fd = gsPatchPreconditionersCreator<>::fastDiagonalizationOp(basis, bc);
+    gsInfo << "\nDoFs: " << fd->rows() << ", setup of fast diagonalization: " << timer.stop() << " s\n";
+
+    benchmark("Mass matrix", *gsPatchPreconditionersCreator<>::massMatrixOp(basis, bc), numApply);
+    benchmark("Fast diagonalization", *fd, numApply);
+    if (scms)
+        benchmark("Subspace corrected mass smoother",
+                  *gsPatchPreconditionersCreator<>::subspaceCorrectedMassSmootherOp(basis, bc), numApply);
+
+    return EXIT_SUCCESS;
+}
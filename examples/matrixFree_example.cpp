@@ -0,0 +1,129 @@
+/** @file matrixFree_example.cpp
+
+    @brief Solves a Poisson problem with a matrix-free operator of the
+    expression assembler and compares it with the assembled matrix.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+// Returns the inverse of the diagonal \a diag as a linear operator
+gsLinearOperator<>::Ptr inverseDiagonalOp(const gsMatrix<> & diag)
+{
+    gsSparseMatrix<> Dinv(diag.rows(), diag.rows());
+    Dinv.reserve(gsVector<index_t>::Constant(diag.rows(), 1));
+    for (index_t i = 0; i != diag.rows(); ++i)
+        Dinv.insert(i,i) = (real_t)(1) / diag.at(i);
+    Dinv.makeCompressed();
+    return makeMatrixOp(Dinv.moveToPtr());
+}
+
+int main(int argc, char *argv[])
+{
+    index_t numRefine = 2;
+    index_t degree    = 4;
+    real_t  tolerance = 1e-8;
+    index_t maxIter   = 1000;
+    bool    planar    = false;
+
+    gsCmdLine cmd("Matrix-free vs. assembled operator for the Poisson equation.");
+    cmd.addInt ("r", "uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt ("p", "degree", "Spline degree", degree);
+    cmd.addReal("t", "tolerance", "Tolerance of the conjugate gradient method", tolerance);
+    cmd.addInt ("i", "iter", "Maximum number of iterations", maxIter);
+    cmd.addSwitch("planar", "Solve on the unit square instead of the unit cube", planar);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    gsMultiPatch<> mp;
+    if (planar)
+        mp.addPatch( gsNurbsCreator<>::BSplineSquare(1) );
+    else
+        mp.addPatch( gsNurbsCreator<>::BSplineCube(1) );
+    mp.computeTopology();
+
+    const short_t d = mp.domainDim();
+    gsFunctionExpr<> f(planar ? "2*pi^2*sin(pi*x)*sin(pi*y)"
+                              : "3*pi^2*sin(pi*x)*sin(pi*y)*sin(pi*z)", d);
+    gsFunctionExpr<> s(planar ? "sin(pi*x)*sin(pi*y)"
+                              : "sin(pi*x)*sin(pi*y)*sin(pi*z)", d);
+
+    gsBoundaryConditions<> bc;
+    for (gsMultiPatch<>::const_biterator it = mp.bBegin(); it != mp.bEnd(); ++it)
+        bc.addCondition(*it, condition_type::dirichlet, &s);
+    bc.setGeoMap(mp);
+
+    gsMultiBasis<> dbasis(mp, true);
+    dbasis.setDegree(degree);
+    for (index_t r = 0; r < numRefine; ++r)
+        dbasis.uniformRefine();
+
+    gsExprAssembler<> A(1,1);
+    A.setIntegrationElements(dbasis);
+    gsExprAssembler<>::geometryMap G = A.getMap(mp);
+    gsExprAssembler<>::space u = A.getSpace(dbasis);
+    u.setup(bc, dirichlet::l2Projection, 0);
+    auto ff = A.getCoeff(f, G);
+
+    auto bf = igrad(u, G) * igrad(u, G).tr() * meas(G);
+
+    A.initSystem();
+    gsInfo << "Degree: "<< degree <<", DoFs: "<< A.numDofs() <<"\n";
+
+    gsStopwatch timer;
+    A.assemble(u * ff * meas(G)); // right-hand side only
+    const gsMatrix<> rhs = A.rhs();
+    gsInfo << "Right-hand side: "<< timer.stop() <<" s\n";
+
+    // Matrix-free operator and Jacobi preconditioner
+    timer.restart();
+    gsExprOp<real_t,decltype(bf)>::Ptr mfOp = makeExprOp(A, bf);
+    gsLinearOperator<>::Ptr mfPrec = inverseDiagonalOp(mfOp->diagonal());
+    gsInfo << "Matrix-free setup (diagonal): "<< timer.stop() <<" s\n";
+
+    gsMatrix<> xMf;
+    gsConjugateGradient<> cgMf(mfOp, mfPrec);
+    cgMf.setTolerance(tolerance);
+    cgMf.setMaxIterations(maxIter);
+    timer.restart();
+    cgMf.solve(rhs, xMf);
+    const real_t mfTime = timer.stop();
+    gsInfo << "Matrix-free CG:  "<< cgMf.iterations() <<" iterations, "
+           << mfTime <<" s ("<< mfTime / cgMf.iterations() <<" s per iteration)\n";
+
+    // Assembled matrix
+    timer.restart();
+    A.initSystem();
+    A.assemble(bf);
+    const gsSparseMatrix<> mat = A.giveMatrix();
+    gsInfo << "Matrix assembly: "<< timer.stop() <<" s, "<< mat.nonZeros() <<" nonzeros ("
+           << mat.nonZeros() * (sizeof(real_t)+sizeof(index_t)) / 1048576. <<" MB)\n";
+
+    gsMatrix<> x;
+    gsConjugateGradient<> cg(mat, inverseDiagonalOp(mat.diagonal().eval()));
+    cg.setTolerance(tolerance);
+    cg.setMaxIterations(maxIter);
+    timer.restart();
+    cg.solve(rhs, x);
+    const real_t time = timer.stop();
+    gsInfo << "Assembled CG:    "<< cg.iterations() <<" iterations, "
+           << time <<" s ("<< time / cg.iterations() <<" s per iteration)\n";
+
+    gsInfo << "Difference of the solutions: "<< (x - xMf).norm() / x.norm() <<"\n";
+
+    // Error of the matrix-free solution
+    gsExprEvaluator<> ev(A);
+    gsExprAssembler<>::solution u_sol = A.getSolution(u, xMf);
+    auto u_ex = ev.getVariable(s, G);
+    gsInfo << "L2 error: "<< math::sqrt( ev.integral( (u_ex - u_sol).sqNorm() * meas(G) ) ) <<"\n";
+
+    return EXIT_SUCCESS;
+}
@@ -47,6 +47,7 @@ int main(int argc, char *argv[])
     std::string boundaryConditions("d");
     std::string out;
     bool plot = false;
+    bool benchmark = false;
 
     gsCmdLine cmd("Solves a PDE with an isogeometric discretization using a multigrid solver.");
     cmd.addString("g", "Geometry",              "Geometry file", geometry);
@@ -73,6 +74,7 @@ int main(int argc, char *argv[])
     cmd.addString("b", "BoundaryConditions",    "Boundary conditions", boundaryConditions);
     cmd.addString("",  "out",                   "Write solution and used options to file", out);
     cmd.addSwitch(     "plot",                  "Plot the result with Paraview", plot);
+    cmd.addSwitch(     "benchmark",             "Measure the time of a multigrid cycle for 1, 2, 4, ... threads", benchmark);
 
     try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
 
@@ -298,6 +300,10 @@ int main(int argc, char *argv[])
             smootherOp = makeJacobiOp(mg->matrix(i));
         else if ( smoother == "GaussSeidel" || smoother == "gs" )
             smootherOp = makeGaussSeidelOp(mg->matrix(i));
+        else if ( smoother == "MulticolorGaussSeidel" || smoother == "mcgs" )
+            smootherOp = makeMulticolorGaussSeidelOp(mg->matrix(i));
+        else if ( smoother == "Chebyshev" || smoother == "cheb" )
+            smootherOp = makeChebyshevOp(mg->matrix(i));
         else if ( smoother == "IncompleteLU" || smoother == "ilu" )
             smootherOp = makeIncompleteLUOp(mg->matrix(i));
         else if ( smoother == "SubspaceCorrectedMassSmoother" || smoother == "scms" )
@@ -313,7 +319,7 @@ int main(int argc, char *argv[])
         else
         {
             gsInfo << "\n\nThe chosen smoother is unknown.\n\nKnown are:\n  Richardson (r)\n  Jacobi (j)\n  GaussSeidel (gs)"
-                      "\n  IncompleteLU (ilu)\n  SubspaceCorrectedMassSmoother (scms)\n  Hybrid (hyb)\n\n";
+                      "\n  MulticolorGaussSeidel (mcgs)\n  Chebyshev (cheb)\n  IncompleteLU (ilu)\n  SubspaceCorrectedMassSmoother (scms)\n  Hybrid (hyb)\n\n";
             return EXIT_FAILURE;
         }
 
@@ -333,6 +339,32 @@ int main(int argc, char *argv[])
     } // end for
     //! [Define smoothers3]
 
+    if (benchmark)
+    {
+#       ifdef _OPENMP
+        const int maxThreads = omp_get_max_threads();
+#       else
+        const int maxThreads = 1;
+#       endif
+        const index_t numCycles = 5;
+        gsMatrix<> bx;
+        gsInfo << "\nTime per multigrid cycle (" << assembler.matrix().rows() << " dofs):\n";
+        for (int nt = 1; nt <= maxThreads; nt = (nt < maxThreads && 2*nt > maxThreads) ? maxThreads : 2*nt)
+        {
+#           ifdef _OPENMP
+            omp_set_num_threads(nt);
+#           endif
+            mg->apply(assembler.rhs(), bx); // warm-up
+            gsStopwatch timer;
+            for (index_t k = 0; k < numCycles; ++k)
+                mg->apply(assembler.rhs(), bx);
+            gsInfo << "  " << nt << " thread(s): " << timer.stop() / numCycles << " s\n";
+        }
+#       ifdef _OPENMP
+        omp_set_num_threads(maxThreads);
+#       endif
+    }
+
     gsMatrix<> errorHistory;
 
     //! [Initial guess]
@@ -26,6 +26,8 @@ int main(int argc, char *argv[])
     index_t maxIter = 100;
     index_t method = 1;
     bool last = false;
+    bool reuse = false;
+    index_t cacheMB = 0;
 
     gsCmdLine cmd("Tutorial on solving a non-linear Poisson problem.");
     cmd.addInt("m","method","Method to use: 0: Newton with automated Jacobian, 1: Newton with Precomputed Jacobian, 2: Picard iteration", method);
@@ -35,6 +37,8 @@ int main(int argc, char *argv[])
     cmd.addInt( "r", "uniformRefine", "Number of Uniform h-refinement loops",  numRefine );
     //cmd.addString( "f", "file", "Input XML file", fn );
     cmd.addSwitch("last", "Solve solely for the last level of h-refinement", last);
+    cmd.addInt("", "mapCache", "Size (in MB) of the cache for the geometry map data (0: no caching)", cacheMB);
+    cmd.addSwitch("reuse", "Keep the sparsity pattern and reassemble only the values in the non-linear loop", reuse);
     cmd.addSwitch("plot", "Create a ParaView visualization file with the solution", plot);
 
     try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
@@ -92,6 +96,7 @@ int main(int argc, char *argv[])
     //! [Problem setup]
     gsExprAssembler<> A(1,1);
     //A.setOptions(Aopt);
+    A.options().setSwitch("reusePattern", reuse);
 
     gsInfo<<"Active options:\n"<< A.options() <<"\n";
 
@@ -103,6 +108,7 @@ int main(int argc, char *argv[])
     // Elements used for numerical integration
     A.setIntegrationElements(dbasis);
     gsExprEvaluator<> ev(A);
+    A.exprData()->setMapCache(cacheMB * 1048576);
 
     // Set the geometry map
     geometryMap G = A.getMap(mp);
@@ -249,6 +255,13 @@ int main(int argc, char *argv[])
     gsInfo<<"  Assembly: "<< ma_time    <<"\n";
     gsInfo<<"   Solving: "<< slv_time   <<"\n";
     gsInfo<<"     Norms: "<< err_time   <<"\n";
+    if (0!=cacheMB)
+    {
+        size_t hits, misses;
+        const size_t bytes = A.exprData()->mapCacheStats(hits, misses);
+        gsInfo<<" Map cache: "<< hits <<" hits, "<< misses <<" misses, "
+              << bytes / 1048576. <<" MB\n";
+    }
 
     //! [Error and convergence rates]
     gsInfo<< "\nL2 error: "<<std::scientific<<std::setprecision(3)<<l2err.transpose()<<"\n";
@@ -0,0 +1,73 @@
+/** @file paraviewFormats_example.cpp
+
+    @brief Compares the write time and the file size of the VTK data
+    formats (ascii, binary and compressed) supported by
+    gsParaviewDataSet and gsParaviewCollection.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    index_t numPoints  = 10000;
+    index_t numPatches = 2;
+    bool keep = false;
+
+    gsCmdLine cmd("Write time and file size of the VTK output formats.");
+    cmd.addInt( "n", "numPoints", "Number of sample points per patch", numPoints );
+    cmd.addInt( "m", "patches", "Number of patches per direction of the cube grid", numPatches );
+    cmd.addSwitch("keep", "Keep the written files", keep);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    gsMultiPatch<> mp = gsNurbsCreator<>::BSplineCubeGrid(numPatches, numPatches, numPatches);
+    gsFunctionExpr<> f("sin(pi*x)*cos(pi*y)*z", 3);
+    gsField<> field(mp, f, false);
+
+    gsInfo<< "Writing "<< mp.nPieces() <<" patches with "<< numPoints <<" points each\n";
+
+    const std::string path = gsFileManager::getTempPath();
+    const char * formats[3] = {"ascii", "binary", "compressed"};
+    for (int i = 0; i != 3; ++i)
+    {
+        gsOptionList opt = gsParaviewDataSet::defaultOptions();
+        opt.setInt("numPoints", numPoints);
+        opt.setString("format", formats[i]);
+
+        gsStopwatch timer;
+        gsParaviewDataSet ds(path + "paraviewFormats_" + formats[i], &mp, nullptr, opt);
+        ds.addField(field, "SolutionField");
+        ds.save();
+        const real_t time = timer.stop();
+
+        const std::vector<std::string> fnames = ds.filenames();
+        size_t bytes = 0;
+        for (size_t k = 0; k != fnames.size(); ++k)
+        {
+            std::ifstream file(fnames[k].c_str(), std::ios_base::binary | std::ios_base::ate);
+            if (!file)
+            {
+                gsWarn<< "Missing output file "<< fnames[k] <<"\n";
+                return EXIT_FAILURE;
+            }
+            bytes += static_cast<size_t>(file.tellg());
+            file.close();
+            if (!keep)
+                std::remove(fnames[k].c_str());
+        }
+
+        gsInfo<< std::setw(10) << formats[i] <<": "<< time <<" s, "
+              << bytes/1024 <<" KiB\n";
+    }
+
+    return EXIT_SUCCESS;
+}
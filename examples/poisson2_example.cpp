@@ -24,6 +24,7 @@ int main(int argc, char *argv[])
     index_t numRefine  = 5;
     index_t numElevate = 0;
     bool last = false;
+    index_t scatter = -1;
     std::string fn("pde/poisson2d_bvp.xml");
 
     gsCmdLine cmd("Tutorial on solving a Poisson problem.");
@@ -32,6 +33,7 @@ int main(int argc, char *argv[])
     cmd.addInt( "r", "uniformRefine", "Number of Uniform h-refinement loops",  numRefine );
     cmd.addString( "f", "file", "Input XML file", fn );
     cmd.addSwitch("last", "Solve solely for the last level of h-refinement", last);
+    cmd.addInt("", "scatter", "Accumulation of element contributions: (0) critical sections; (1) thread-local buffers (default: from input file)", scatter);
     cmd.addSwitch("plot", "Create a ParaView visualization file with the solution", plot);
 
     try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
@@ -85,7 +87,10 @@ int main(int argc, char *argv[])
 
     //! [Problem setup]
     gsExprAssembler<> A(1,1);
-    A.setOptions(Aopt);
+    // Options of the file, the others keep their default values
+    A.options().update(Aopt, gsOptionList::addIfUnknown);
+    if (-1!=scatter)
+        A.options().setInt("scatter",scatter);
 
     gsInfo<<"Active options:\n"<< A.options() <<"\n";
 
@@ -0,0 +1,122 @@
+/** @file thbEvaluation_example.cpp
+
+    @brief Compares the evaluation throughput of a THB-spline basis
+    with the one of a tensor B-spline basis at the quadrature nodes of
+    their elements.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+// Evaluates values and derivatives up to order n at the quadrature
+// nodes of all elements, returns the elapsed time per element
+real_t evalElements(const gsBasis<> & basis, int n, index_t numRuns)
+{
+    gsGaussRule<> qr(basis, 1.0, 1); // degree+1 nodes per direction
+    gsMatrix<> nodes;
+    gsVector<> weights;
+    std::vector<gsMatrix<> > ders;
+
+    gsStopwatch timer;
+    for (index_t k = 0; k != numRuns; ++k)
+    {
+        typename gsBasis<>::domainIter domIt = basis.makeDomainIterator();
+        for (; domIt->good(); domIt->next())
+        {
+            qr.mapTo(domIt->lowerCorner(), domIt->upperCorner(), nodes, weights);
+            basis.evalAllDers_into(nodes, n, ders);
+        }
+    }
+    return timer.stop() / (numRuns * basis.numElements());
+}
+
+int main(int argc, char *argv[])
+{
+    index_t numRefine  = 3;
+    index_t numLevels  = 3;
+    index_t degree     = 2;
+    index_t numRuns    = 1;
+    bool volume = false;
+
+    gsCmdLine cmd("Evaluation throughput of THB-splines vs. tensor B-splines.");
+    cmd.addInt( "r", "uniformRefine", "Number of uniform refinement steps of the coarsest level", numRefine );
+    cmd.addInt( "l", "levels", "Number of levels of the THB-spline basis", numLevels );
+    cmd.addInt( "p", "degree", "Spline degree", degree );
+    cmd.addInt( "n", "runs", "Number of evaluation runs", numRuns );
+    cmd.addSwitch("volume", "Use trivariate bases", volume);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+    gsKnotVector<> kv(0, 1, (1<<numRefine)-1, degree+1);
+    gsBasis<>::uPtr tensor, thb;
+    if (volume)
+    {
+        gsTensorBSplineBasis<3> tb(kv, kv, kv);
+        gsTHBSplineBasis<3> * hb = new gsTHBSplineBasis<3>(tb);
+        gsMatrix<> box(3, 2);
+        box.col(0).setZero();
+        // refine towards the corner at the origin
+        for (index_t l = 1; l < numLevels; ++l)
+        {
+            box.col(1).setConstant( math::pow((real_t)0.5, (real_t)l) );
+            hb->refine(box);
+        }
+        tensor = tb.clone();
+        thb = gsBasis<>::uPtr(hb);
+    }
+    else
+    {
+        gsTensorBSplineBasis<2> tb(kv, kv);
+        gsTHBSplineBasis<2> * hb = new gsTHBSplineBasis<2>(tb);
+        gsMatrix<> box(2, 2);
+        box.col(0).setZero();
+        for (index_t l = 1; l < numLevels; ++l)
+        {
+            box.col(1).setConstant( math::pow((real_t)0.5, (real_t)l) );
+            hb->refine(box);
+        }
+        tensor = tb.clone();
+        thb = gsBasis<>::uPtr(hb);
+    }
+
+    gsInfo<< "Tensor basis: "<< tensor->size() <<" functions, "<< tensor->numElements() <<" elements\n"
+          << "THB basis   : "<< thb->size()    <<" functions, "<< thb->numElements()    <<" elements\n";
+
+    const char * what[3] = {"values", "up to 1st derivatives", "up to 2nd derivatives"};
+    for (int n = 0; n != 3; ++n)
+    {
+        const real_t tt = evalElements(*tensor, n, numRuns);
+        const real_t th = evalElements(*thb   , n, numRuns);
+        gsInfo<< std::setw(22) << what[n] <<": tensor "<< tt*1e6 <<" us/element, THB "
+              << th*1e6 <<" us/element, ratio "<< th/tt <<"\n";
+    }
+
+    // The batched THB evaluation must agree with the evaluation of
+    // the single basis functions
+    gsMatrix<> u(thb->dim(), 100);
+    u.setRandom();
+    u.array() = (u.array() + 1) / 2;
+    gsMatrix<index_t> act;
+    gsMatrix<> val, single;
+    thb->active_into(u, act);
+    thb->eval_into(u, val);
+    real_t err = 0;
+    for (index_t p = 0; p != u.cols(); ++p)
+        for (index_t j = 0; j != act.rows(); ++j)
+        {
+            if (j != 0 && act(j,p) == 0) break;
+            thb->evalSingle_into(act(j,p), u.col(p), single);
+            err = math::max(err, math::abs(single.value() - val(j,p)));
+        }
+    gsInfo<< "Maximum deviation from single function evaluation: "<< err <<"\n";
+
+    return err < 1e-12 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,72 @@
+/** @file topology_example.cpp
+
+    @brief Measures the time spent in gsMultiPatch::computeTopology
+    for grids of patches of increasing size.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char *argv[])
+{
+    index_t maxPatches = 1000;
+    bool volume = false;
+
+    gsCmdLine cmd("Timing of the topology computation for grids of patches.");
+    cmd.addInt   ("n", "patches", "Largest number of patches (grids of 1k, 10k, 100k.. patches up to this size)", maxPatches);
+    cmd.addSwitch("volume", "Use a grid of cubes instead of squares", volume);
+    try { cmd.getValues(argc,argv); } catch (int rv) { return rv; }
+
+#ifdef _OPENMP
+    gsInfo<< "Available threads: "<< omp_get_max_threads() <<"\n";
+#endif
+
+    gsStopwatch timer;
+    for (index_t target = 1000; target <= maxPatches; target *= 10)
+    {
+        // Grid with (at least) target patches
+        const index_t d = volume ? 3 : 2;
+        const index_t n = cast<real_t,index_t>(math::ceil(math::pow((real_t)target, (real_t)1/(real_t)d)));
+        const index_t l = volume ? n : 1;
+
+        gsMultiPatch<> mp;
+        for (index_t i = 0; i < n; ++i)
+            for (index_t j = 0; j < n; ++j)
+                for (index_t k = 0; k < l; ++k)
+                {
+                    if (volume)
+                        mp.addPatch(gsNurbsCreator<>::BSplineCube(1, 0.5+i, 0.5+j, 0.5+k));
+                    else
+                        mp.addPatch(gsNurbsCreator<>::BSplineSquare(1, i, j));
+                }
+
+        timer.restart();
+        mp.computeTopology();
+        const double t = timer.stop();
+
+        // Every pair of neighboring patches shares one interface
+        const index_t nIfc = volume ? 3*n*n*(n-1) : 2*n*(n-1);
+        const index_t nBdr = volume ? 6*n*n       : 4*n;
+        gsInfo<< std::setw(7) << mp.nPatches() <<" patches: "<< t <<" s, "
+              << mp.nInterfaces() <<" interfaces, "<< mp.nBoundary() <<" boundaries\n";
+
+        if ( nIfc != static_cast<index_t>(mp.nInterfaces()) ||
+             nBdr != static_cast<index_t>(mp.nBoundary()) )
+        {
+            gsWarn<< "Wrong topology, expected "<< nIfc <<" interfaces and "
+                  << nBdr <<" boundaries.\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
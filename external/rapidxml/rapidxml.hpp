@@ -3,6 +3,7 @@
 
 
 #include <stdio.h> // G+Smo: for snprintf
+#include <string>  // G+Smo: for std::string
 
 
 // Copyright (C) 2006, 2009 Marcin Kalicinski
@@ -1394,6 +1395,7 @@ namespace rapidxml
     protected:
         int max_Id;
         unsigned m_float_precision;
+        std::string m_encoding;
 
     public:
         xml_node<Ch> * makeRoot()
@@ -1431,6 +1433,10 @@ namespace rapidxml
         inline unsigned getFloatPrecision() const {return m_float_precision;}
 
         inline void setFloatPrecision(const unsigned k) { m_float_precision = k; }
+
+        inline const std::string & getEncoding() const {return m_encoding;}
+
+        inline void setEncoding(const std::string & enc) { m_encoding = enc; }
         //end G+Smo
     public:
 
@@ -1440,6 +1446,7 @@ namespace rapidxml
         //G+Smo
         , max_Id(-1)
         , m_float_precision(16)
+        , m_encoding("ascii")
         //end G+Smo
         { }
 
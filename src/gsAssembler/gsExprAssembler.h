@@ -42,6 +42,16 @@ private:
     std::vector<gsFeSpaceData<T>*> m_vrow;
     std::vector<gsFeSpaceData<T>*> m_vcol;
 
+    // Positions of the element matrices in the values of the system
+    // matrix, per (row space, column space), patch and element. Used
+    // for numeric-only reassembly (option "reusePattern")
+    typedef std::vector<std::vector<std::vector<index_t> > > _slotCache;
+    typedef std::pair<const gsDofMapper*,const gsDofMapper*> _slotKey;
+    typedef std::map<_slotKey,_slotCache> _slotMap;
+    _slotMap m_slots;
+    index_t  m_slotsNnz; // number of nonzeros the cached positions refer to
+    size_t   m_patternSig; // fingerprint of the spaces the pattern was made for
+
     typedef typename gsExprHelper<T>::nullExpr    nullExpr;
 
 public:
@@ -72,7 +82,7 @@ public:
     /// \param _cBlocks Number of spaces for solution variables
     gsExprAssembler(index_t _rBlocks = 1, index_t _cBlocks = 1)
     : m_exprdata(gsExprHelper<T>::make()), m_gmap(nullptr), m_options(defaultOptions()),
-      m_vrow(_rBlocks,nullptr), m_vcol(_cBlocks,nullptr)
+      m_vrow(_rBlocks,nullptr), m_vcol(_cBlocks,nullptr), m_slotsNnz(0), m_patternSig(0)
     { }
 
     // The copy constructor replicates the same environent but does
@@ -295,12 +305,35 @@ public:
     }
 
     /// \brief Initializes the sparse matrix only
+    ///
+    /// If the option "reusePattern" is set and the matrix has already
+    /// been assembled, its sparsity pattern is kept and only the values
+    /// are set to zero. The following assembly scatters the element
+    /// contributions directly into the stored pattern. The pattern is
+    /// the one of the first assembly after it was (re-)created; it is
+    /// discarded if the degrees of freedom (dof mappers) or the
+    /// elements of the mesh have changed since then.
     void initMatrix()
     {
         resetDimensions();
-        clearMatrix(false);
+        clearMatrix(m_options.getSwitch("reusePattern") && hasPattern() &&
+                    m_patternSig==_spaceSignature());
+    }
+
+    /// \brief Returns true if the matrix has a (compressed) sparsity
+    /// pattern which fits the current spaces
+    bool hasPattern() const
+    {
+        return m_matrix.isCompressed() && 0!=m_matrix.nonZeros() &&
+            m_matrix.rows()==numTestDofs() && m_matrix.cols()==numDofs();
     }
 
+    /// \brief Discards the sparsity pattern of the matrix, which is
+    /// otherwise kept if the option "reusePattern" is set.
+    /// \note Must be called if the expressions to be assembled couple
+    /// further degrees of freedom
+    void clearPattern() { clearMatrix(false); }
+
     void clearRhs() { m_rhs.setZero(); }
 
     /**
@@ -314,6 +347,9 @@ public:
             std::fill(m_matrix.valuePtr(),
                       m_matrix.valuePtr() + m_matrix.nonZeros(), 0.);
         } else {
+            _slotMap().swap(m_slots);
+            if (m_options.getSwitch("reusePattern"))
+                m_patternSig = _spaceSignature();
             m_matrix = gsSparseMatrix<T>(numTestDofs(), numDofs());
 
             if (0 == m_matrix.rows() || 0 == m_matrix.cols())
@@ -397,6 +433,21 @@ public:
     template<class expr> void assembleJacobianIfc(const ifContainer & iFaces,
                                                   const expr residual, solution  u);
 
+    /// \brief Applies the matrix of the bilinear form \a bf (as it
+    /// would be assembled by assemble(bf)) to the coefficients \a x
+    /// and writes the result in \a y, without assembling the matrix.
+    ///
+    /// The element matrices are computed on the fly and multiplied
+    /// with the local coefficients. The rows and columns of fixed
+    /// (eliminated) DoFs are omitted.
+    /// \sa gsExprOp
+    template<class expr> void apply(const expr & bf, const gsMatrix<T> & x,
+                                    gsMatrix<T> & y);
+
+    /// \brief Computes the diagonal of the matrix of the bilinear form
+    /// \a bf without assembling the matrix, eg. for Jacobi smoothing
+    template<class expr> void assembleDiagonal(const expr & bf, gsMatrix<T> & diag);
+
 private:
 
     void _blockDims(gsVector<index_t> & rowSizes,
@@ -426,6 +477,162 @@ private:
     /// Called internally by the init* functions
     void resetDimensions();
 
+    // Thread-local accumulation buffers, used for lock-free scatter
+    // of the element contributions (option "scatter" set to 1)
+    struct _buffer
+    {
+        gsSparseEntries<T> entries; // matrix contributions (triplets)
+        gsSparseMatrix<T>  matrix;  // compressed matrix contributions
+        gsMatrix<T>        rhs;     // right-hand side contributions
+
+        // Merges the compressed contributions of two buffers
+        struct merge
+        {
+            void operator()(_buffer & res, _buffer & other) const
+            {
+                util::gsThreadedSum sum;
+                sum(res.matrix, other.matrix);
+                sum(res.rhs, other.rhs);
+            }
+        };
+    };
+    typedef util::gsThreaded<_buffer> _buffers;
+
+    /// \brief Returns true if the option "scatter" is set to 1, ie.
+    /// the element contributions are accumulated in thread-local buffers
+    bool _threadLocal() const { return 1==m_options.askInt("scatter", 0); }
+
+    /// \brief Merges the thread-local buffers \a buf into the global
+    /// system by a pairwise (tree) reduction. Must be called by all
+    /// threads of the team.
+    void _reduceBuffers(_buffers & buf);
+
+    /// \brief Prepares the cached positions of the element matrices of
+    /// the expressions \a args in the sparsity pattern. Returns false if
+    /// the matrix has no pattern yet, ie. the pattern is being created
+    template<class... expr> bool _initSlots(const std::tuple<expr...> & args);
+
+    /// \brief Returns a fingerprint of the degrees of freedom of all
+    /// spaces and of the elements of the mesh, used to detect that the
+    /// sparsity pattern and the cached positions are out of date
+    size_t _spaceSignature() const
+    {
+        size_t h = m_sdata.size();
+        auto combine = [&h](size_t v) { util::hash_combine(h, v); };
+        for (typename std::list<gsFeSpaceData<T> >::const_iterator
+                 it = m_sdata.begin(); it != m_sdata.end(); ++it)
+        {
+            const gsDofMapper & dm = it->mapper;
+            combine(std::hash<const void*>()(it->fs));
+            if (!dm.isFinalized()) continue;
+            combine(static_cast<size_t>(dm.freeSize()));
+            combine(static_cast<size_t>(dm.size()));
+            for (size_t c = 0; c != dm.componentsSize(); ++c)
+            {
+                const gsVector<index_t> v = dm.asVector(c);
+                for (index_t i = 0; i != v.size(); ++i)
+                    combine(static_cast<size_t>(v[i]));
+            }
+        }
+        if (m_exprdata->multiBasisSet())
+        {
+            const gsMultiBasis<T> & mb = m_exprdata->multiBasis();
+            for (size_t p = 0; p != mb.nBases(); ++p)
+                combine(mb.basis(p).numElements());
+        }
+        return h;
+    }
+
+    // Creates the position caches for the matrix expressions
+    struct __slotKeys
+    {
+        gsExprAssembler & ea;
+        explicit __slotKeys(gsExprAssembler & _ea) : ea(_ea) { }
+
+        template <typename E> void operator() (const gismo::expr::_expr<E> & ee)
+        {
+            if (!E::isMatrix()) return;
+            _slotCache & sc = ea.m_slots[_slotKey(&ee.rowVar().mapper(), &ee.colVar().mapper())];
+            if (!sc.empty()) return;
+            const gsMultiBasis<T> & mb = ea.m_exprdata->multiBasis();
+            sc.resize(mb.nBases());
+            for (size_t p = 0; p != sc.size(); ++p)
+                sc[p].resize(mb.basis(p).makeDomainIterator()->numElements());
+        }
+
+        void operator() (const expr::_expr<expr::gsNullExpr<T> > &) {}
+    };
+
+    // Applies the bilinear form \a bf element by element to \a x
+    // (or computes the diagonal if x is a null pointer)
+    template<class expr> void _applyElementwise(const expr & bf,
+                                                const gsMatrix<T> * x,
+                                                gsMatrix<T> & y);
+
+    // Multiplies the element matrices with the local coefficients and
+    // accumulates the result (matrix-free operator application)
+    struct _apply
+    {
+        const gsMatrix<T> * m_x; // null pointer: diagonal extraction
+        gsMatrix<T>       & m_y;
+        const gsVector<T> & m_quWeights;
+        gsMatrix<T>         localMat, localX, localY;
+        gsVector<index_t>   rowInd, colInd; // global indices, -1 if fixed
+
+        _apply(const gsMatrix<T> * _x, gsMatrix<T> & _y,
+               const gsVector<T> & _quWeights)
+        : m_x(_x), m_y(_y), m_quWeights(_quWeights)
+        { }
+
+        template <typename E> void operator() (const gismo::expr::_expr<E> & ee)
+        {
+            GISMO_ASSERT(E::isMatrix(), "Expecting a bilinear form");
+            ee.quadrature(m_quWeights, localMat);
+            indices(ee.rowVar(), rowInd);
+            indices(ee.colVar(), colInd);
+            GISMO_ASSERT( rowInd.size()==localMat.rows() && colInd.size()==localMat.cols(),
+                          "Invalid local matrix (expected "<<rowInd.size() <<"x"<< colInd.size() <<")" );
+
+            if (nullptr==m_x)
+            {
+                for (index_t j = 0; j != colInd.size(); ++j)
+                    for (index_t i = 0; i != rowInd.size(); ++i)
+                        if (-1!=rowInd[i] && rowInd[i]==colInd[j])
+                            m_y.at(rowInd[i]) += localMat(i,j);
+                return;
+            }
+
+            // Gather, multiply, scatter
+            localX.resize(colInd.size(), m_x->cols());
+            for (index_t j = 0; j != colInd.size(); ++j)
+                if (-1==colInd[j])
+                    localX.row(j).setZero();
+                else
+                    localX.row(j) = m_x->row(colInd[j]);
+            localY.noalias() = localMat * localX;
+            for (index_t i = 0; i != rowInd.size(); ++i)
+                if (-1!=rowInd[i])
+                    m_y.row(rowInd[i]) += localY.row(i);
+        }
+
+        void operator() (const expr::_expr<expr::gsNullExpr<T> > &) {}
+
+        // Global indices of the local basis functions of \a u, ordered
+        // as the rows/columns of the local matrix
+        static void indices(const expr::gsFeSpace<T> & u, gsVector<index_t> & ind)
+        {
+            const gsDofMapper & map = u.mapper();
+            const gsMatrix<index_t> & act = u.data().actives;
+            ind.resize(act.rows()*u.dim());
+            for (index_t c = 0, k = 0; c != u.dim(); ++c)
+                for (index_t i = 0; i != act.rows(); ++i, ++k)
+                {
+                    const index_t ii = map.index(act.at(i),u.data().patchId,c);
+                    ind[k] = map.is_free_index(ii) ? ii : -1;
+                }
+        }
+    };
+
     // Prints the expression to a text stream
     struct __printExpr
     {
@@ -455,6 +662,11 @@ private:
         gsMatrix<T>       & m_rhs;
         const gsVector<T> & m_quWeights;
         bool m_elim;
+        bool m_keepZeros;
+        bool m_missing;
+        _buffer *           m_buf;
+        _slotMap *          m_slots;
+        size_t              m_elId;
         gsMatrix<T>         localMat;
         gsMatrix<T>         aux;
 
@@ -462,11 +674,36 @@ private:
               gsMatrix<T>       & _rhs,
               const gsVector<>  & _quWeights)
         : m_matrix(_matrix), m_rhs(_rhs),
-          m_quWeights(_quWeights), m_elim(true)
+          m_quWeights(_quWeights), m_elim(true), m_keepZeros(false),
+          m_missing(false), m_buf(nullptr), m_slots(nullptr), m_elId(0)
         { }
 
         void setElim(bool elim) {m_elim = elim;}
 
+        /// Insert zero entries of the element matrices as well, so
+        /// that the sparsity pattern contains all couplings
+        void setKeepZeros(bool keep) {m_keepZeros = keep;}
+
+        /// Scatter the element matrices into the positions cached in
+        /// \a slots (numeric-only reassembly)
+        void setSlots(_slotMap * slots) {m_slots = slots;}
+
+        /// Sets the index of the current element on the patch
+        void setElement(size_t id) {m_elId = id;}
+
+        /// True if an element matrix had an entry outside of the
+        /// cached sparsity pattern (it was not scattered)
+        bool missingEntry() const {return m_missing;}
+
+        /// Accumulate into the (thread-local) buffer \a buf instead
+        /// of the global system. No locking takes place in this case.
+        void setBuffer(_buffer * buf)
+        {
+            m_buf = buf;
+            if (nullptr!=m_buf && m_buf->rhs.rows()!=m_rhs.rows())
+                m_buf->rhs.setZero(m_rhs.rows(), m_rhs.cols());
+        }
+
         template <typename E> void operator() (const gismo::expr::_expr<E> & ee)
         {
             // ------- Compute  -------
@@ -474,8 +711,14 @@ private:
 
             //  ------- Accumulate  -------
             if (E::isMatrix())
-                if (m_elim) push<true,true>(ee.rowVar(), ee.colVar());
+            {
+                std::vector<index_t> * slots = elementSlots(ee.rowVar(), ee.colVar());
+                if (nullptr!=slots)
+                    if (m_elim) pushCached<true>(ee.rowVar(), ee.colVar(), *slots);
+                    else pushCached<false>(ee.rowVar(), ee.colVar(), *slots);
+                else if (m_elim) push<true,true>(ee.rowVar(), ee.colVar());
                 else push<true,false>(ee.rowVar(), ee.colVar());
+            }
             else if (E::isVector())
                 if (m_elim) push<false,true>(ee.rowVar(), ee.colVar());
                 else push<false,false>(ee.rowVar(), ee.colVar());
@@ -492,10 +735,9 @@ private:
                                gsMatrix<T> & lm)
         {
             // ------- Compute  -------
-            const T * w = m_quWeights.data();
-            lm.noalias() = (*w) * ee.eval(0);
-            for (index_t k = 1; k != m_quWeights.rows(); ++k)
-                lm.noalias() += (*(++w)) * ee.eval(k);
+            // The expression is evaluated on all quadrature nodes of
+            // the element at once, wherever its nodes support this
+            ee.quadrature(m_quWeights, lm);
         }
 
         template <typename E> void diff(const gismo::expr::_expr<E> & ee,
@@ -590,7 +832,7 @@ private:
 
                                 for (index_t j = 0; j != colInd0.rows(); ++j)
                                 {
-                                    if ( 0 == localMat(rls+i,cls+j) ) continue;
+                                    if ( 0 == localMat(rls+i,cls+j) && !m_keepZeros ) continue;
 
                                     const index_t jj = colMap.index(colInd0.at(j),u.data().patchId,c); // N_j
                                     if ( colMap.is_free_index(jj) )
@@ -598,16 +840,27 @@ private:
                                         // If matrix is symmetric, we could
                                         // store only lower triangular part
                                         //if ( (!symm) || jj <= ii )
-#                                       pragma omp critical (acc_m_matrix)
-                                        m_matrix.coeffRef(ii, jj) += localMat(rls+i,cls+j);
+                                        if (m_buf)
+                                            m_buf->entries.add(ii, jj, localMat(rls+i,cls+j));
+                                        else
+                                        {
+#                                           pragma omp critical (acc_m_matrix)
+                                            m_matrix.coeffRef(ii, jj) += localMat(rls+i,cls+j);
+                                        }
                                     }
                                     else if (elim) // colMap.is_boundary_index(jj) )
                                     {
                                         // Symmetric treatment of eliminated BCs
                                         // GISMO_ASSERT(1==m_rhs.cols(), "-");
-#                                       pragma omp critical (acc_m_rhs)
-                                        m_rhs.at(ii) -= localMat(rls+i,cls+j) *
-                                            fixedDofs.at(colMap.global_to_bindex(jj));
+                                        if (m_buf)
+                                            m_buf->rhs.at(ii) -= localMat(rls+i,cls+j) *
+                                                fixedDofs.at(colMap.global_to_bindex(jj));
+                                        else
+                                        {
+#                                           pragma omp critical (acc_m_rhs)
+                                            m_rhs.at(ii) -= localMat(rls+i,cls+j) *
+                                                fixedDofs.at(colMap.global_to_bindex(jj));
+                                        }
                                     }
                                 }
                             }
@@ -615,14 +868,114 @@ private:
                         else
                         {
                             //The right-hand side can have more than one columns
-#                           pragma omp critical (acc_m_rhs)
-                            m_rhs.row(ii) += localMat.row(rls+i);
+                            if (m_buf)
+                                m_buf->rhs.row(ii) += localMat.row(rls+i);
+                            else
+                            {
+#                               pragma omp critical (acc_m_rhs)
+                                m_rhs.row(ii) += localMat.row(rls+i);
+                            }
                         }
                     }
                 }
             }
         }//push
 
+        // Returns the cached positions for the current element, or a
+        // null pointer if no cache is used
+        std::vector<index_t> * elementSlots(const expr::gsFeSpace<T> & v,
+                                            const expr::gsFeSpace<T> & u)
+        {
+            if (nullptr==m_slots) return nullptr;
+            typename _slotMap::iterator it = m_slots->find(_slotKey(&v.mapper(), &u.mapper()));
+            if (m_slots->end()==it) return nullptr;
+            return &it->second[v.data().patchId][m_elId];
+        }
+
+        // Returns the position of entry (i,j) in the values of the
+        // matrix, or -3 if it is not in the sparsity pattern
+        index_t position(const index_t i, const index_t j) const
+        {
+            const index_t * inner = m_matrix.innerIndexPtr();
+            const index_t * beg = inner + m_matrix.outerIndexPtr()[j];
+            const index_t * end = inner + m_matrix.outerIndexPtr()[j+1];
+            const index_t * pos = std::lower_bound(beg, end, i);
+            return (pos!=end && *pos==i) ? pos - inner : -3;
+        }
+
+        // Scatters the local matrix into the compressed global matrix
+        // using the cached positions \a slots. On the first visit of an
+        // element the positions are looked up in the sparsity pattern.
+        // Entries of eliminated (fixed) columns are marked by -1, the
+        // ones of fixed rows by -2. An element with entries outside of
+        // the pattern is not scattered but reported by missingEntry(),
+        // since throwing is not possible inside the parallel region.
+        template<bool elim>
+        void pushCached(const expr::gsFeSpace<T> & v,
+                        const expr::gsFeSpace<T> & u,
+                        std::vector<index_t> & slots)
+        {
+            const index_t nr = localMat.rows(), nc = localMat.cols();
+            const gsDofMapper & rowMap = v.mapper();
+            const gsDofMapper & colMap = u.mapper();
+            const gsMatrix<index_t> & rowInd0 = v.data().actives;
+            const gsMatrix<index_t> & colInd0 = u.data().actives;
+            const index_t nri = rowInd0.rows(), nci = colInd0.rows();
+            GISMO_ASSERT( nri*v.dim()==nr && nci*u.dim()==nc,
+                          "Invalid local matrix (expected "<<nri*v.dim() <<"x"<< nci*u.dim() <<"), got\n" << localMat );
+
+            if (slots.empty())
+            {
+                slots.resize(nr*nc);
+                index_t * s = slots.data();
+                for (index_t j = 0; j != nc; ++j)
+                {
+                    const index_t jj = colMap.index(colInd0.at(j%nci),u.data().patchId,j/nci);
+                    for (index_t i = 0; i != nr; ++i, ++s)
+                    {
+                        const index_t ii = rowMap.index(rowInd0.at(i%nri),v.data().patchId,i/nri);
+                        *s = ( !rowMap.is_free_index(ii) ? -2 :
+                               (colMap.is_free_index(jj) ? position(ii,jj) : -1) );
+                    }
+                }
+                if (std::find(slots.begin(), slots.end(), -3) != slots.end())
+                {
+                    m_missing = true;
+                    slots.clear();
+                    return;
+                }
+            }
+            GISMO_ASSERT(static_cast<index_t>(slots.size())==nr*nc, "Cached positions do not fit the element matrix");
+
+            T * val = m_matrix.valuePtr();
+            const index_t * s = slots.data();
+            for (index_t j = 0; j != nc; ++j)
+                for (index_t i = 0; i != nr; ++i, ++s)
+                {
+                    if (0 <= *s)
+                    {
+#                       pragma omp atomic
+                        val[*s] += localMat(i,j);
+                    }
+                    else if (elim && -1 == *s && 0 != localMat(i,j))
+                    {
+                        // Symmetric treatment of eliminated BCs
+                        const gsMatrix<T> & fixedDofs = u.fixedPart();
+                        const index_t ii = rowMap.index(rowInd0.at(i%nri),v.data().patchId,i/nri);
+                        const index_t jj = colMap.index(colInd0.at(j%nci),u.data().patchId,j/nci);
+                        if (m_buf)
+                            m_buf->rhs.at(ii) -= localMat(i,j) *
+                                fixedDofs.at(colMap.global_to_bindex(jj));
+                        else
+                        {
+#                           pragma omp critical (acc_m_rhs)
+                            m_rhs.at(ii) -= localMat(i,j) *
+                                fixedDofs.at(colMap.global_to_bindex(jj));
+                        }
+                    }
+                }
+        }//pushCached
+
     };
 
 }; // gsExprAssembler
@@ -642,6 +995,8 @@ gsOptionList gsExprAssembler<T>::defaultOptions()
     opt.addSwitch("overInt", "Apply over-integration on boundary elements or not?", false);
     opt.addSwitch("flipSide", "Flip side of interface where integration is performed.", false);
     opt.addSwitch("movingInterface", "Used in interface assembly when interface is not stationary.", false);
+    opt.addInt ("scatter", "Accumulation of element contributions: (0) critical sections on the global system; (1) thread-local buffers merged by a parallel reduction",0);
+    opt.addSwitch("reusePattern", "Keep the sparsity pattern of the matrix in initSystem() and reassemble only its values, scattered into cached positions", false);
     return opt;
 
     /// dirichlet treatment? elimination ????
@@ -733,6 +1088,34 @@ template<class T> void gsExprAssembler<T>::resetDimensions()
     }
 }
 
+template<class T> void gsExprAssembler<T>::_reduceBuffers(_buffers & buf)
+{
+    // Compress the thread-local contributions (in parallel)
+    _buffer & mine = buf.mine();
+    if (0!=mine.entries.size())
+    {
+        mine.matrix.resize(m_matrix.rows(), m_matrix.cols());
+        mine.matrix.setFrom(mine.entries);
+    }
+    gsSparseEntries<T>().swap(mine.entries); // release memory
+
+    // Pairwise reduction, log2(nt) steps
+    _buffer & all = buf.combine(typename _buffer::merge());
+
+#   pragma omp master
+    {
+        // Add into the reserved pattern of the global matrix (a sparse
+        // sum would allocate a new matrix)
+        for (index_t k = 0; k < all.matrix.outerSize(); ++k)
+            for (typename gsSparseMatrix<T>::iterator it(all.matrix,k); it; ++it)
+                m_matrix.coeffRef(it.row(), it.col()) += it.value();
+        if (0!=all.rhs.size())
+            m_rhs += all.rhs;
+        buf.clear();
+    }
+#   pragma omp barrier
+}
+
 template<size_t I, class op, typename... Ts>
 void op_tuple_impl (op & _op, const std::tuple<Ts...> &tuple)
 {
@@ -745,14 +1128,39 @@ template<class op, typename... Ts>
 void op_tuple (op & _op, const std::tuple<Ts...> &tuple)
 { op_tuple_impl<0>(_op,tuple); }
 
+template<class T>
+template<class... expr>
+bool gsExprAssembler<T>::_initSlots(const std::tuple<expr...> & args)
+{
+    // The cached positions are valid as long as the pattern is
+    // unchanged and it was created for the current spaces
+    const bool valid = hasPattern() && m_patternSig==_spaceSignature();
+    if (!valid || m_matrix.nonZeros()!=m_slotsNnz)
+        _slotMap().swap(m_slots);
+    if (!valid) return false;
+    m_slotsNnz = m_matrix.nonZeros();
+
+    __slotKeys keys(*this);
+    op_tuple(keys, args);
+    return true;
+}
+
 template<class T>
 template<class... expr>
 void gsExprAssembler<T>::assemble(const expr &... args)
 {
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized, matrix().cols() = "<<matrix().cols()<<"!="<<numDofs()<<" = numDofs()");
 
-    bool failed = false;
-#pragma omp parallel shared(failed)
+    // Thread-local buffers (empty if scattering directly to the system)
+    _buffers buf;
+    const bool threadLocal = _threadLocal();
+
+    // Numeric-only reassembly into the stored sparsity pattern
+    const bool reuse  = m_options.getSwitch("reusePattern");
+    const bool cached = reuse && _initSlots(std::make_tuple(args...));
+
+    bool failed = false, missing = false;
+#pragma omp parallel shared(failed,missing,buf)
 {
 #   ifdef _OPENMP
     const int tid = omp_get_thread_num();
@@ -770,6 +1178,9 @@ void gsExprAssembler<T>::assemble(const expr &... args)
     _eval ee(m_matrix, m_rhs, quWeights);
     const index_t elim = m_options.getInt("DirichletStrategy");
     ee.setElim(dirichlet::elimination==elim);
+    if (threadLocal) ee.setBuffer(&buf.mine());
+    ee.setKeepZeros(reuse);
+    if (cached) ee.setSlots(&m_slots);
 
     // Note: omp thread will loop over all patches and will work on Ep/nt
     // elements, where Ep is the elements on the patch.
@@ -783,10 +1194,13 @@ void gsExprAssembler<T>::assemble(const expr &... args)
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements of patchInd
+        // (elId: index of the element on the patch)
 #       ifdef _OPENMP
-        for ( domIt->next(tid); domIt->good() && (!failed); domIt->next(nt) )
+        size_t elId = tid;
+        for ( domIt->next(tid); domIt->good() && (!failed); domIt->next(nt), elId += nt )
 #       else
-        for (; domIt->good(); domIt->next() )
+        size_t elId = 0;
+        for (; domIt->good(); domIt->next(), ++elId )
 #       endif
         {
             // Map the Quadrature rule to the element
@@ -817,10 +1231,27 @@ void gsExprAssembler<T>::assemble(const expr &... args)
 
 
             // Assemble contributions of the element
+            ee.setElement(elId);
             op_tuple(ee, arg_tpl);
+
+            // An entry outside of the reused pattern (see pushCached)
+            if (ee.missingEntry())
+            {
+                #pragma omp atomic write
+                missing = true;
+                #pragma omp atomic write
+                failed = true;
+                break;
+            }
         }
     }
+
+    if (threadLocal) _reduceBuffers(buf);
 }//omp parallel
+    if (missing) // the cached positions are incomplete
+        _slotMap().swap(m_slots);
+    GISMO_ENSURE(!missing,"The expressions couple entries which are not in the "
+                 "sparsity pattern, call clearPattern() first.");
     // Throw something else?? (floating point exception?)
     GISMO_ENSURE(!failed,"Assembly failed due to an error");
     m_matrix.makeCompressed();
@@ -833,14 +1264,29 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
 
     if ( BCs.empty() || 0==numDofs() ) return;
+
+    // Thread-local buffers (empty if scattering directly to the system)
+    _buffers buf;
+    const bool threadLocal = _threadLocal();
+
+    // With "reusePattern", the couplings of the boundary terms become
+    // part of the pattern; if entries are added to an existing pattern,
+    // the cached positions of assemble() are no longer valid
+    const bool reuse = m_options.getSwitch("reusePattern");
+    const index_t nnz = m_matrix.nonZeros();
+
+    bool failed = false;
+#pragma omp parallel shared(failed,buf)
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
     m_exprdata->setMutSource(*BCs.front().get().function()); //initialize once
 
-// #pragma omp parallel
-// {
-// #   ifdef _OPENMP
-//     const int tid = omp_get_thread_num();
-//     const int nt  = omp_get_num_threads();
-// #   endif
     auto arg_tpl = std::make_tuple(args...);
     m_exprdata->parse(arg_tpl);
     m_exprdata->activateFlags(SAME_ELEMENT);
@@ -849,9 +1295,13 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
     gsVector<T> quWeights;               // quadrature weights
 
     _eval ee(m_matrix, m_rhs, quWeights);
+    if (threadLocal) ee.setBuffer(&buf.mine());
+    ee.setKeepZeros(reuse);
 
-//#   pragma omp parallel for
-    for (typename bcRefList::const_iterator iit = BCs.begin(); iit!= BCs.end(); ++iit)
+    // Note: the boundary elements of all sides are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
+    for (typename bcRefList::const_iterator iit = BCs.begin(); iit!= BCs.end() && (!failed); ++iit)
     {
         const boundary_condition<T> * it = &iit->get();
 
@@ -866,8 +1316,10 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements
-        for (; domIt->good(); domIt->next() )
+        for (; domIt->good() && (!failed); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                            m_exprdata->points(), quWeights);
@@ -875,17 +1327,35 @@ void gsExprAssembler<T>::assembleBdr(const bcRefList & BCs, expr&... args)
             if (m_exprdata->points().cols()==0)
                 continue;
 
+// Activate the try-catch only if G+Smo is not in DEBUG
+#ifdef NDEBUG
             // Perform required pre-computations on the quadrature nodes
+            try
+            {
+            m_exprdata->precompute(it->patch(), it->side());
+            }
+            catch (...)
+            {
+                #pragma omp atomic write
+                failed = true;
+                break;
+            }
+#else
             m_exprdata->precompute(it->patch(), it->side());
+#endif
 
             // Assemble contributions of the element
             op_tuple(ee, arg_tpl);
         }
     }
 
-//}//omp parallel
+    if (threadLocal) _reduceBuffers(buf);
+}//omp parallel
 
+    GISMO_ENSURE(!failed,"Assembly failed due to an error");
     m_matrix.makeCompressed();
+    if (m_matrix.nonZeros()!=nnz)
+        _slotMap().swap(m_slots);
 }
 
 
@@ -897,6 +1367,24 @@ void gsExprAssembler<T>::assembleBdr(const bContainer & bnd, expr&... args)
 
     if ( bnd.size()==0 || 0==numDofs() ) return;
 
+    // Thread-local buffers (empty if scattering directly to the system)
+    _buffers buf;
+    const bool threadLocal = _threadLocal();
+
+    // Boundary couplings are kept in the pattern (see above)
+    const bool reuse = m_options.getSwitch("reusePattern");
+    const index_t nnz = m_matrix.nonZeros();
+
+    bool failed = false;
+#pragma omp parallel shared(failed,buf)
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
     auto arg_tpl = std::make_tuple(args...);
     m_exprdata->parse(arg_tpl);
 
@@ -904,11 +1392,14 @@ void gsExprAssembler<T>::assembleBdr(const bContainer & bnd, expr&... args)
     gsVector<T> quWeights;               // quadrature weights
 
     _eval ee(m_matrix, m_rhs, quWeights);
+    if (threadLocal) ee.setBuffer(&buf.mine());
+    ee.setKeepZeros(reuse);
 
-//#   pragma omp parallel for
-
+    // Note: the boundary elements of all sides are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
     for (gsBoxTopology::const_biterator it = bnd.begin();
-         it != bnd.end(); ++it )
+         it != bnd.end() && (!failed); ++it )
     {
         QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(it->patch),
                                     m_options, it->side().direction());
@@ -919,8 +1410,10 @@ void gsExprAssembler<T>::assembleBdr(const bContainer & bnd, expr&... args)
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements
-        for (; domIt->good(); domIt->next() )
+        for (; domIt->good() && (!failed); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                            m_exprdata->points(), quWeights);
@@ -928,17 +1421,35 @@ void gsExprAssembler<T>::assembleBdr(const bContainer & bnd, expr&... args)
             if (m_exprdata->points().cols()==0)
                 continue;
 
+// Activate the try-catch only if G+Smo is not in DEBUG
+#ifdef NDEBUG
             // Perform required pre-computations on the quadrature nodes
+            try
+            {
             m_exprdata->precompute(it->patch, it->side());
+            }
+            catch (...)
+            {
+                #pragma omp atomic write
+                failed = true;
+                break;
+            }
+#else
+            m_exprdata->precompute(it->patch, it->side());
+#endif
 
             // Assemble contributions of the element
             op_tuple(ee, arg_tpl);
         }
     }
 
-//}//omp parallel
+    if (threadLocal) _reduceBuffers(buf);
+}//omp parallel
 
+    GISMO_ENSURE(!failed,"Assembly failed due to an error");
     m_matrix.makeCompressed();
+    if (m_matrix.nonZeros()!=nnz)
+        _slotMap().swap(m_slots);
 }
 
 template<class T> template<class... expr>
@@ -946,8 +1457,24 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
 {
     GISMO_ASSERT(matrix().cols()==numDofs(), "System not initialized");
 
-// #pragma omp parallel
-// {
+    // Thread-local buffers (empty if scattering directly to the system)
+    _buffers buf;
+    const bool threadLocal = _threadLocal();
+
+    // Interface couplings are kept in the pattern (see assembleBdr)
+    const bool reuse = m_options.getSwitch("reusePattern");
+    const index_t nnz = m_matrix.nonZeros();
+
+    bool failed = false;
+#pragma omp parallel shared(failed,buf)
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
     typedef typename gsFunction<T>::uPtr ifacemap;
 
     auto arg_tpl = std::make_tuple(args...);
@@ -958,13 +1485,17 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
     typename gsQuadRule<T>::uPtr QuRule;
     gsVector<T> quWeights;// quadrature weights
     _eval ee(m_matrix, m_rhs, quWeights);
+    if (threadLocal) ee.setBuffer(&buf.mine());
+    ee.setKeepZeros(reuse);
 
     const bool flipSide = m_options.askSwitch("flipSide", false);
 
+    // Note: the interface elements of all interfaces are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
     ifacemap interfaceMap;
-// #   pragma omp for
     for (gsBoxTopology::const_iiterator it = iFaces.begin();
-         it != iFaces.end(); ++it )
+         it != iFaces.end() && (!failed); ++it )
     {
         // If flipSide switch is enabled, then the integration will be
         // performed on the opposite side of the interface
@@ -972,12 +1503,9 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
         const index_t patch1 = iFace.first() .patch;
         const index_t patch2 = iFace.second().patch;
 
-        if (iFace.type() == interaction::conforming)
-            interfaceMap = gsAffineFunction<T>::make( iFace.dirMap(), iFace.dirOrientation(),
-                                                      m_exprdata->multiBasis().basis(patch1).support(),
-                                                      m_exprdata->multiBasis().basis(patch2).support() );
-        else
-            interfaceMap = gsCPPInterface<T>::make(getGeometryMap(), m_exprdata->multiBasis(), iFace);
+        // The interface map is created on the first element
+        // visited by this thread
+        interfaceMap.reset();
 
         QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patch1),
                                    m_options, iFace.first().side().direction());
@@ -988,8 +1516,20 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
         m_exprdata->getElement().set(*domIt, quWeights);
 
         // Start iteration over elements
-        for (; domIt->good(); domIt->next() )
+        for (; domIt->good() && (!failed); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
+            if (!interfaceMap)
+            {
+                if (iFace.type() == interaction::conforming)
+                    interfaceMap = gsAffineFunction<T>::make( iFace.dirMap(), iFace.dirOrientation(),
+                                                              m_exprdata->multiBasis().basis(patch1).support(),
+                                                              m_exprdata->multiBasis().basis(patch2).support() );
+                else
+                    interfaceMap = gsCPPInterface<T>::make(getGeometryMap(), m_exprdata->multiBasis(), iFace);
+            }
+
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                            m_exprdata->points(), quWeights);
@@ -998,8 +1538,22 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
             if (m_exprdata->points().cols()==0)
                 continue;
 
+// Activate the try-catch only if G+Smo is not in DEBUG
+#ifdef NDEBUG
             // Perform required pre-computations on the quadrature nodes
+            try
+            {
             m_exprdata->precompute(iFace);
+            }
+            catch (...)
+            {
+                #pragma omp atomic write
+                failed = true;
+                break;
+            }
+#else
+            m_exprdata->precompute(iFace);
+#endif
 
             //eg.
             // uL*vL/2 + uR*vL/2  - uL*vR/2 - uR*vR/2
@@ -1010,8 +1564,13 @@ void gsExprAssembler<T>::assembleIfc(const ifContainer & iFaces, expr... args)
         }
     }
 
-// }//omp parallel
+    if (threadLocal) _reduceBuffers(buf);
+}//omp parallel
+
+    GISMO_ENSURE(!failed,"Assembly failed due to an error");
     m_matrix.makeCompressed();
+    if (m_matrix.nonZeros()!=nnz)
+        _slotMap().swap(m_slots);
 }
 
 template<class T> template<class expr>
@@ -1206,6 +1765,102 @@ void gsExprAssembler<T>::assembleJacobianIfc(const ifContainer & iFaces,
     m_matrix.makeCompressed();
 }
 
+template<class T> template<class expr>
+void gsExprAssembler<T>::apply(const expr & bf, const gsMatrix<T> & x,
+                               gsMatrix<T> & y)
+{
+    GISMO_ASSERT(x.rows()==numDofs(), "Invalid size of the input, expected "
+                 <<numDofs()<<" rows, got "<<x.rows());
+    y.setZero(numTestDofs(), x.cols());
+    _applyElementwise(bf, &x, y);
+}
+
+template<class T> template<class expr>
+void gsExprAssembler<T>::assembleDiagonal(const expr & bf, gsMatrix<T> & diag)
+{
+    GISMO_ASSERT(numTestDofs()==numDofs(), "The matrix is not square");
+    diag.setZero(numDofs(), 1);
+    _applyElementwise(bf, nullptr, diag);
+}
+
+template<class T> template<class expr>
+void gsExprAssembler<T>::_applyElementwise(const expr & bf, const gsMatrix<T> * x,
+                                           gsMatrix<T> & y)
+{
+    GISMO_ASSERT(expr::isMatrix(), "Expecting a bilinear form");
+
+    // Thread-local results, merged by a parallel reduction
+    util::gsThreaded<gsMatrix<T> > buf;
+
+    bool failed = false;
+#pragma omp parallel shared(failed,buf)
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   endif
+    auto arg_tpl = std::make_tuple(bf);
+
+    m_exprdata->parse(arg_tpl);
+    m_exprdata->activateFlags(SAME_ELEMENT);
+
+    typename gsQuadRule<T>::uPtr QuRule; // Quadrature rule
+
+    gsVector<T> quWeights; // quadrature weights
+    gsMatrix<T> & mine = buf.mine();
+    mine.setZero(y.rows(), y.cols());
+    _apply ee(x, mine, quWeights);
+
+    for (unsigned patchInd = 0; patchInd < m_exprdata->multiBasis().nBases() && (!failed); ++patchInd)
+    {
+        QuRule = gsQuadrature::getPtr(m_exprdata->multiBasis().basis(patchInd), m_options);
+
+        // Initialize domain element iterator for current patch
+        typename gsBasis<T>::domainIter domIt =
+            m_exprdata->multiBasis().basis(patchInd).makeDomainIterator();
+        m_exprdata->getElement().set(*domIt,quWeights);
+
+        // Start iteration over elements of patchInd
+#       ifdef _OPENMP
+        for ( domIt->next(tid); domIt->good() && (!failed); domIt->next(nt) )
+#       else
+        for (; domIt->good(); domIt->next() )
+#       endif
+        {
+            // Map the Quadrature rule to the element
+            QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
+                           m_exprdata->points(), quWeights);
+
+            if (m_exprdata->points().cols()==0)
+                continue;
+
+#ifdef NDEBUG
+            try
+            {
+            m_exprdata->precompute(patchInd);
+            }
+            catch (...)
+            {
+                #pragma omp atomic write
+                failed = true;
+                break;
+            }
+#else
+            m_exprdata->precompute(patchInd);
+#endif
+
+            // Apply the element matrix
+            op_tuple(ee, arg_tpl);
+        }
+    }
+
+    gsMatrix<T> & all = buf.combine();
+#   pragma omp master
+    y += all;
+}//omp parallel
+    GISMO_ENSURE(!failed,"Operator application failed due to an error");
+}
+
 template<class T>
 void gsExprAssembler<T>::quPointsWeights(std::vector<gsMatrix<T> >&  cPoints, std::vector<gsVector<T> > & cWeights)
 {
@@ -356,23 +356,46 @@ private:
     template<class E>
     void computeGrid_impl(const expr::_expr<E> & expr, const index_t patchInd);
 
+    // Accumulates the values of \a e at all quadrature nodes into \a res
+    template<class _op, class E> static inline
+    void quad_acc(const E & e, const gsVector<T> & w, T & res)
+    {
+        for (index_t k = 0; k != w.rows(); ++k) // loop over quad. nodes
+            _op::acc(e.eval(k), w[k], res);
+    }
+
     struct plus_op
     {
         static inline T init() { return 0; }
         static inline void acc(const T contrib, const T w, T & res)
         { res += w * contrib; }
+        // Sums are computed on all nodes of the element at once
+        template<class E> static inline
+        void quad(const E & e, const gsVector<T> & w, T & res)
+        {
+            if (0==w.rows()) return;
+            T val;
+            e.quadrature(w, val);
+            res += val;
+        }
     };
     struct min_op
     {
         static inline T init() { return math::limits::max(); }
         static inline void acc (const T contrib, const T, T & res)
         { res = math::min(contrib, res); } //note: min/max are not atomic
+        template<class E> static inline
+        void quad(const E & e, const gsVector<T> & w, T & res)
+        { quad_acc<min_op>(e, w, res); }
     };
     struct max_op
     {
         static inline T init() { return math::limits::min(); }
         static inline void acc (const T contrib, const T, T & res)
         { res = math::max(contrib, res); }
+        template<class E> static inline
+        void quad(const E & e, const gsVector<T> & w, T & res)
+        { quad_acc<max_op>(e, w, res); }
     };
 
 };
@@ -401,8 +424,8 @@ T gsExprEvaluator<T>::compute_impl(const expr::_expr<E> & expr)
     m_exprdata->parse(_arg);
     m_exprdata->activateFlags(SAME_ELEMENT);
     
-    // Computed value on element
-    T elVal;
+    // Computed value on element, accumulated value of the thread
+    T elVal, thVal = _op::init();
     index_t c = 0;
     for (unsigned patchInd=0; patchInd < m_exprdata->multiBasis().nBases(); ++patchInd)
     {
@@ -435,8 +458,7 @@ T gsExprEvaluator<T>::compute_impl(const expr::_expr<E> & expr)
 
             // Compute on element
             elVal = _op::init();
-            for (index_t k = 0; k != quWeights.rows(); ++k) // loop over quad. nodes
-                _op::acc(_arg.eval(k), quWeights[k], elVal);
+            _op::quad(_arg, quWeights, elVal);
 
             if ( storeElWise )
             {
@@ -448,11 +470,13 @@ T gsExprEvaluator<T>::compute_impl(const expr::_expr<E> & expr)
 #               endif
             }
 
-#           pragma omp critical (_op_acc)
-            _op::acc(elVal, 1, m_value);
+            _op::acc(elVal, 1, thVal);
         }
     }
 
+    // Merge the thread-local values once
+#   pragma omp critical (_op_acc)
+    _op::acc(thVal, 1, m_value);
 }//omp parallel
     return m_value;
 }
@@ -468,6 +492,19 @@ T gsExprEvaluator<T>::computeBdr_impl(const expr::_expr<E> & expr,
 
     //expr.print(gsInfo);
 
+    m_value = _op::init();
+    m_elWise.clear();
+
+#pragma omp parallel
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
+
     gsQuadRule<T> QuRule;  // Quadrature rule
     gsVector<T> quWeights; // quadrature weights
 
@@ -477,9 +514,11 @@ T gsExprEvaluator<T>::computeBdr_impl(const expr::_expr<E> & expr,
 
     // Computed value
     T elVal;
-    m_value = _op::init();
-    m_elWise.clear();
+    T thVal = _op::init(); // thread-local value
 
+    // Note: the boundary elements of all sides are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
     for (typename gsBoxTopology::const_biterator bit = //!! not multipatch!
              bdrlist.begin(); bit != bdrlist.end(); ++bit)
     {
@@ -492,8 +531,10 @@ T gsExprEvaluator<T>::computeBdr_impl(const expr::_expr<E> & expr,
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements
-        for (; domIt->good(); domIt->next() )
+        for (; domIt->good(); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
             // Map the Quadrature rule to the element
             QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                           m_exprdata->points(), quWeights);
@@ -503,14 +544,17 @@ T gsExprEvaluator<T>::computeBdr_impl(const expr::_expr<E> & expr,
 
             // Compute on element
             elVal = _op::init();
-            for (index_t k = 0; k != quWeights.rows(); ++k) // loop over quadrature nodes
-                _op::acc(_arg.eval(k), quWeights[k], elVal);
+            _op::quad(_arg, quWeights, elVal);
 
-            _op::acc(elVal, 1, m_value);
+            _op::acc(elVal, 1, thVal);
             //if ( storeElWise ) m_elWise.push_back( elVal );
         }
     }
 
+#   pragma omp critical (_op_acc)
+    _op::acc(thVal, 1, m_value);
+}//omp parallel
+
     return m_value;
 }
 
@@ -526,6 +570,19 @@ T gsExprEvaluator<T>::computeBdrBc_impl(const bcRefList & BCs,
     //expr.print(gsInfo);
 
     if ( BCs.empty() ) return 0;
+
+    m_value = _op::init();
+    m_elWise.clear();
+
+#pragma omp parallel
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
     m_exprdata->setMutSource(*BCs.front().get().function()); //initialize once
 
     typename gsQuadRule<T>::uPtr QuRule; // Quadrature rule  ---->OUT
@@ -537,9 +594,11 @@ T gsExprEvaluator<T>::computeBdrBc_impl(const bcRefList & BCs,
 
     // Computed value
     T elVal;
-    m_value = _op::init();
-    m_elWise.clear();
+    T thVal = _op::init(); // thread-local value
 
+    // Note: the boundary elements of all sides are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
     for (typename bcRefList::const_iterator iit = BCs.begin(); iit!= BCs.end(); ++iit)
     {
         const boundary_condition<T> * it = &iit->get();
@@ -556,8 +615,10 @@ T gsExprEvaluator<T>::computeBdrBc_impl(const bcRefList & BCs,
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements
-        for (; domIt->good(); domIt->next() )
+        for (; domIt->good(); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                           m_exprdata->points(), quWeights);
@@ -570,14 +631,17 @@ T gsExprEvaluator<T>::computeBdrBc_impl(const bcRefList & BCs,
 
             // Compute on element
             elVal = _op::init();
-            for (index_t k = 0; k != quWeights.rows(); ++k) // loop over quadrature nodes
-                _op::acc(_arg.eval(k), quWeights[k], elVal);
+            _op::quad(_arg, quWeights, elVal);
 
-            _op::acc(elVal, 1, m_value);
+            _op::acc(elVal, 1, thVal);
             //if ( storeElWise ) m_elWise.push_back( elVal );
         }
     }
 
+#   pragma omp critical (_op_acc)
+    _op::acc(thVal, 1, m_value);
+}//omp parallel
+
     return m_value;
 }
 
@@ -585,6 +649,21 @@ template<class T>
 template<class E, class _op>
 T gsExprEvaluator<T>::computeInterface_impl(const expr::_expr<E> & expr, const intContainer & iFaces)
 {
+    // Computed value
+    m_value = _op::init();
+    //if ( storeElWise )
+    m_elWise.assign(iFaces.size(), _op::init());
+
+#pragma omp parallel
+{
+#   ifdef _OPENMP
+    const int tid = omp_get_thread_num();
+    const int nt  = omp_get_num_threads();
+#   else
+    const int tid = 0;
+    const int nt  = 1;
+#   endif
+
     auto arg_tpl = expr.val();
     m_exprdata->parse(arg_tpl);
     // m_exprdata->activateFlags(SAME_ELEMENT);
@@ -592,27 +671,22 @@ T gsExprEvaluator<T>::computeInterface_impl(const expr::_expr<E> & expr, const i
     typename gsQuadRule<T>::uPtr QuRule;
     gsVector<T> quWeights; // quadrature weights
 
-    // Computed value
-    T elVal;
-    m_value = _op::init();
-    //if ( storeElWise )
-    m_elWise.reserve(m_exprdata->multiBasis().topology().nInterfaces());
-    m_elWise.clear();
+    // Thread-local values per interface
+    std::vector<T> thVals(iFaces.size(), _op::init());
 
+    // Note: the interface elements of all interfaces are distributed
+    // round-robin over the threads
+    index_t cnt = 0;
     ifacemap interfaceMap;
-    for (typename gsBoxTopology::const_iiterator iit =
-             iFaces.begin(); iit != iFaces.end(); ++iit)
+    for (size_t i = 0; i != iFaces.size(); ++i)
     {
-        const boundaryInterface & iFace = *iit;
+        const boundaryInterface & iFace = iFaces[i];
         const index_t patch1 = iFace.first().patch;
         const index_t patch2 = iFace.second().patch;
 
-        if (iFace.type() == interaction::conforming)
-            interfaceMap = gsAffineFunction<T>::make( iFace.dirMap(), iFace.dirOrientation(),
-                                                      m_exprdata->multiBasis().basis(patch1).support(),
-                                                      m_exprdata->multiBasis().basis(patch2).support() );
-        else
-            interfaceMap = gsCPPInterface<T>::make(m_exprdata->multiPatch(), m_exprdata->multiBasis(), iFace);
+        // The interface map is created on the first element
+        // visited by this thread
+        interfaceMap.reset();
 
         //gsRemapInterface<T> interfaceMap(m_exprdata->multiPatch(),
         //                                 m_exprdata->multiBasis(),
@@ -629,9 +703,21 @@ T gsExprEvaluator<T>::computeInterface_impl(const expr::_expr<E> & expr, const i
         m_exprdata->getElement().set(*domIt,quWeights);
 
         // Start iteration over elements
-        elVal = _op::init();
-        for (; domIt->good(); domIt->next() )
+        T & elVal = thVals[i];
+        for (; domIt->good(); domIt->next(), ++cnt )
         {
+            if ( tid != cnt % nt ) continue;
+
+            if (!interfaceMap)
+            {
+                if (iFace.type() == interaction::conforming)
+                    interfaceMap = gsAffineFunction<T>::make( iFace.dirMap(), iFace.dirOrientation(),
+                                                              m_exprdata->multiBasis().basis(patch1).support(),
+                                                              m_exprdata->multiBasis().basis(patch2).support() );
+                else
+                    interfaceMap = gsCPPInterface<T>::make(m_exprdata->multiPatch(), m_exprdata->multiBasis(), iFace);
+            }
+
             // Map the Quadrature rule to the element
             QuRule->mapTo( domIt->lowerCorner(), domIt->upperCorner(),
                            m_exprdata->points(), quWeights);
@@ -641,16 +727,18 @@ T gsExprEvaluator<T>::computeInterface_impl(const expr::_expr<E> & expr, const i
             m_exprdata->precompute(iFace);
 
             // Compute on element
-            for (index_t k = 0; k != quWeights.rows(); ++k) // loop over qu-nodes
-            {
-                _op::acc(arg_tpl.eval(k), quWeights[k], elVal);
-            }
+            _op::quad(arg_tpl, quWeights, elVal);
         }
-        _op::acc(elVal, 1, m_value);
-        //if ( storeElWise )
-            m_elWise.push_back( elVal );
     }
 
+#   pragma omp critical (_op_acc)
+    for (size_t i = 0; i != iFaces.size(); ++i)
+        _op::acc(thVals[i], 1, m_elWise[i]);
+}//omp parallel
+
+    for (size_t i = 0; i != m_elWise.size(); ++i)
+        _op::acc(m_elWise[i], 1, m_value);
+
     return m_value;
 }
 
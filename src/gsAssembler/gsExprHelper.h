@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gsAssembler/gsExpressions.h>
+#include <gsAssembler/gsMapDataCache.h>
 #include <gsUtils/gsThreaded.h>
 
 namespace gismo
@@ -29,12 +30,13 @@ private:
     gsExprHelper(const gsExprHelper &);
 
     gsExprHelper() : m_mirror(nullptr), mesh_ptr(nullptr),
-                     mutSrc(nullptr), mutMap(nullptr)
+                     mutMap(nullptr), m_mapCacheSize(0)
     { }
 
     explicit gsExprHelper(gsExprHelper * m)
     : m_mirror(memory::make_shared_not_owned(m)),
-      mesh_ptr(m->mesh_ptr), mutSrc(nullptr), mutMap(nullptr)
+      mesh_ptr(m->mesh_ptr), mutMap(nullptr),
+      m_mapCacheSize(m->m_mapCacheSize)
     { }
 
 private:
@@ -60,13 +62,19 @@ private:
 
     // mutable pair of variable and data,
     // ie. not uniquely assigned to a gsFunctionSet
-    const gsFunctionSet<T> * mutSrc;
+    // (the source is thread-local, since different threads may
+    // work on different boundary conditions)
+    util::gsThreaded<const gsFunctionSet<T> *> mutSrc;
     const gsFunctionSet<T> * mutMap;
     thFuncData               mutData;
 
     // Represents the current element
     expr::gsFeElement<T> m_element;
 
+    // Thread-local caches of the geometry map data (see setMapCache)
+    util::gsThreaded<gsMapDataCache<T> > m_mapCache;
+    size_t m_mapCacheSize; // total capacity in bytes, zero: no caching
+
 public:
     typedef memory::unique_ptr<gsExprHelper> uPtr;
     typedef memory::shared_ptr<gsExprHelper>  Ptr;
@@ -197,7 +205,7 @@ public:
 
     void setMutSource(const gsFunctionSet<T> & func)
     {
-        mutSrc = &func;
+        mutSrc.mine() = &func;
     }
 
     //void clearMutSource() ?
@@ -221,7 +229,11 @@ private:
     inline gsExprHelper & iface()
     {
         if (nullptr==m_mirror )
-            m_mirror = memory::make_shared(new gsExprHelper(this));
+        {
+#           pragma omp critical (m_mirror_first_touch)
+            if (nullptr==m_mirror )
+                m_mirror = memory::make_shared(new gsExprHelper(this));
+        }
         return *m_mirror;
     }
 
@@ -313,14 +325,14 @@ public:
         {
             //gsInfo<<"\nGot BC composition\n";
             mutMap = &sym.inner().source();
-            if (nullptr!=mutSrc)
+            if (nullptr!=mutSrc.mine())
             {
 #               pragma omp critical (m_fdata_first_touch)
                 const_cast<expr::gsComposition<T>&>(sym)
                     .setData( mutData );
 
                 const_cast<expr::gsComposition<T>&>(sym)
-                    .setSource(*mutSrc);
+                    .setSource(*mutSrc.mine());
             }
             else
                 gsWarn<<"\nSomething went terribly wrong here (add gsComposition).\n";
@@ -373,31 +385,104 @@ public:
         else
         {
             //gsDebug<<"\nGot a mutable variable.\n";
-            if (nullptr!=mutSrc)
+            if (nullptr!=mutSrc.mine())
             {
 #               pragma omp critical (m_fdata_first_touch)
                 const_cast<expr::symbol_expr<E>&>(sym)
                     .setData( mutData );
 
                 const_cast<expr::symbol_expr<E>&>(sym)
-                    .setSource(*mutSrc);
+                    .setSource(*mutSrc.mine());
             }
             else
                 gsWarn<<"\nSomething went wrong here (add symbol_expr).\n";
         }
     }
 
+    /// \brief Enables caching of the geometry map data computed by
+    /// precompute, with a total size of at most \a bytes (zero
+    /// disables the cache).
+    ///
+    /// The data of an element is reused as long as the geometry map,
+    /// the element, the quadrature rule and the requested quantities
+    /// are unchanged, eg. in Newton iterations, time stepping or when
+    /// the same geometry is used by several assemblers/evaluators
+    /// sharing this helper. The least recently used data is evicted
+    /// first. Call clearMapCache() if the geometry is modified. The
+    /// cache stays disabled for coefficient types which are not
+    /// supported by gsMapDataCache.
+    /// \note To be called outside of parallel regions
+    void setMapCache(size_t bytes)
+    {
+        if (!gsMapDataCache<T>::supported()) bytes = 0;
+        m_mapCacheSize = bytes;
+        for (size_t i = 0; i != m_mapCache.size(); ++i)
+            if (m_mapCache.touched(i))
+                m_mapCache[i].setCapacity(bytes / m_mapCache.size());
+        if (isMirrored()) m_mirror->setMapCache(bytes);
+    }
+
+    /// Returns the capacity of the geometry map cache in bytes
+    size_t mapCacheSize() const { return m_mapCacheSize; }
+
+    /// Removes all geometry map data from the cache
+    void clearMapCache()
+    {
+        for (size_t i = 0; i != m_mapCache.size(); ++i)
+            if (m_mapCache.touched(i))
+                m_mapCache[i].clear();
+        if (isMirrored()) m_mirror->clearMapCache();
+    }
+
+    /// \brief Returns the numbers of successful (\a hits) and failed
+    /// (\a misses) look-ups in the geometry map cache, as well as
+    /// the size of the cached data in bytes
+    size_t mapCacheStats(size_t & hits, size_t & misses, bool reset = false)
+    {
+        size_t bytes = 0;
+        hits = misses = 0;
+        for (size_t i = 0; i != m_mapCache.size(); ++i)
+            if (m_mapCache.touched(i))
+            {
+                hits   += m_mapCache[i].hits();
+                misses += m_mapCache[i].misses();
+                bytes  += m_mapCache[i].bytes();
+                if (reset) m_mapCache[i].resetStats();
+            }
+        if (isMirrored())
+        {
+            size_t h, m;
+            bytes += m_mirror->mapCacheStats(h, m, reset);
+            hits += h;
+            misses += m;
+        }
+        return bytes;
+    }
+
     void precompute(const index_t patchIndex = 0,
                     boundary::side bs = boundary::none)
     {
         //First compute the maps
         for (MapDataIt it = m_mdata.begin(); it != m_mdata.end(); ++it)
         {
-            it->second.mine().points.swap(m_points.mine());//swap
-            it->second.mine().side    = bs;
-            it->second.mine().patchId = patchIndex;
-            it->first->function(patchIndex).computeMap(it->second.mine());
-            it->second.mine().points.swap(m_points.mine());
+            gsMapData<T> & md = it->second.mine();
+            md.points.swap(m_points.mine());//swap
+            md.side    = bs;
+            md.patchId = patchIndex;
+            if (0!=m_mapCacheSize)
+            {
+                gsMapDataCache<T> & cache = m_mapCache.mine();
+                cache.setCapacity(m_mapCacheSize / m_mapCache.size());
+                if (!cache.get(it->first, md))
+                {
+                    const unsigned flags = md.flags;
+                    it->first->function(patchIndex).computeMap(md);
+                    cache.put(it->first, md, flags);
+                }
+            }
+            else
+                it->first->function(patchIndex).computeMap(md);
+            md.points.swap(m_points.mine());
         }
 
         for (FuncDataIt it = m_fdata.begin(); it != m_fdata.end(); ++it)
@@ -415,9 +500,9 @@ public:
         }
 
         // Mutable variable to treat BCs
-        if (nullptr!=mutSrc && 0!=mutData.mine().flags)
+        if (nullptr!=mutSrc.mine() && 0!=mutData.mine().flags)
         {
-            mutSrc->piece(patchIndex)
+            mutSrc.mine()->piece(patchIndex)
                 .compute( mutMap ? m_mdata[mutMap].mine().values[0]
                           : m_points, mutData );
         }
@@ -0,0 +1,102 @@
+/** @file gsExprOp.h
+
+    @brief Matrix-free linear operator of a bilinear form given as an
+    isogeometric expression.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#pragma once
+
+#include <gsAssembler/gsExprAssembler.h>
+#include <gsSolver/gsLinearOperator.h>
+
+namespace gismo
+{
+
+/**
+   @brief Linear operator realizing the matrix of a bilinear form \a E
+   without storing it.
+
+   The operator is defined by the same expression which is passed to
+   gsExprAssembler::assemble, eg. igrad(u,G) * igrad(u,G).tr() * meas(G).
+   Every application computes the element matrices on the fly and
+   multiplies them with the local coefficients (see
+   gsExprAssembler::apply), so that the memory requirement is
+   independent of the number of couplings. The rows and columns of
+   fixed (eliminated) DoFs are omitted, as in the assembled matrix.
+
+   The operator can be used with the iterative solvers and with
+   gsMultiGridOp. The diagonal, eg. for Jacobi smoothing, is available
+   by diagonal().
+
+   \note The assembler (and the spaces registered in it) must outlive
+   the operator; gsExprAssembler::initSystem must have been called.
+
+   \ingroup Assembler
+*/
+template<class T, class E>
+class gsExprOp GISMO_FINAL : public gsLinearOperator<T>
+{
+public:
+
+    /// Shared pointer for gsExprOp
+    typedef memory::shared_ptr<gsExprOp> Ptr;
+
+    /// Unique pointer for gsExprOp
+    typedef memory::unique_ptr<gsExprOp> uPtr;
+
+    /// Constructor taking the assembler \a ea and the bilinear form \a bf
+    gsExprOp(gsExprAssembler<T> & ea, const E & bf)
+    : m_ea(&ea), m_bf(bf)
+    { }
+
+    /// Make function returning a smart pointer
+    static uPtr make(gsExprAssembler<T> & ea, const E & bf)
+    { return uPtr( new gsExprOp(ea, bf) ); }
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    { m_ea->apply(m_bf, input, x); }
+
+    index_t rows() const { return m_ea->numTestDofs(); }
+
+    index_t cols() const { return m_ea->numDofs(); }
+
+    /// Computes the diagonal of the operator in \a diag
+    void diagonal(gsMatrix<T> & diag) const
+    { m_ea->assembleDiagonal(m_bf, diag); }
+
+    /// Returns the diagonal of the operator
+    gsMatrix<T> diagonal() const
+    {
+        gsMatrix<T> diag;
+        diagonal(diag);
+        return diag;
+    }
+
+private:
+    gsExprAssembler<T> * m_ea; ///< Assembler holding the spaces
+    E m_bf;                    ///< The bilinear form
+};
+
+/** @brief Returns a matrix-free operator of the bilinear form \a bf,
+  * registered in the assembler \a ea.
+  *
+  * Example:
+  * \code
+  * gsLinearOperator<>::Ptr op = makeExprOp(A, igrad(u,G) * igrad(u,G).tr() * meas(G));
+  * \endcode
+  *
+  * \relates gsExprOp
+  */
+template<class T, class E>
+typename gsExprOp<T,E>::uPtr makeExprOp(gsExprAssembler<T> & ea, const E & bf)
+{ return gsExprOp<T,E>::make(ea, bf); }
+
+} // namespace gismo
@@ -169,6 +169,19 @@ public:
 #  define AutoReturn_t typename util::conditional<ScalarValued,real_t,MatExprType>::type
 #endif
 
+/*
+  Helpers for accumulating weighted evaluations in quadrature(),
+  for scalar as well as for matrix-valued results
+*/
+template<class T, class V> inline void quad_assign(T & res, const T w, const V & v)
+{ res = w * v; }
+template<class T, class V> inline void quad_assign(gsMatrix<T> & res, const T w, const V & v)
+{ res.noalias() = w * v; }
+template<class T, class V> inline void quad_add(T & res, const T w, const V & v)
+{ res += w * v; }
+template<class T, class V> inline void quad_add(gsMatrix<T> & res, const T w, const V & v)
+{ res.noalias() += w * v; }
+
 /**
    \brief Base class for all expressions
 */
@@ -229,6 +242,24 @@ public:
     MatExprType eval(const index_t k) const
     { return static_cast<E const&>(*this).eval(k); }
 
+    /// Computes the weighted sum \f$\sum_k w_k\,\mathrm{eval}(k)\f$
+    /// over all evaluation points into \a res (a scalar or a matrix)
+    template<class R>
+    void quadrature(const gsVector<Scalar> & w, R & res) const
+    { static_cast<E const&>(*this).quadrature_impl(w, res); }
+
+    /// Default implementation of quadrature(), which accumulates the
+    /// evaluation points one by one. Expressions which can be
+    /// evaluated at all points of an element at once hide this function.
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        const E & e = static_cast<E const&>(*this);
+        quad_assign(res, w[0], e.eval(0));
+        for (index_t k = 1; k != w.rows(); ++k)
+            quad_add(res, w[k], e.eval(k));
+    }
+
     /// Returns the transpose of the expression
     tr_expr<E> tr() const
     { return tr_expr<E,false>(static_cast<E const&>(*this)); }
@@ -2669,6 +2700,9 @@ public:
 
     Scalar eval(const index_t k) const { return eval_impl(_u,k); }
 
+    void quadrature_impl(const gsVector<Scalar> & w, Scalar & res) const
+    { quad_impl(_u, w, res); }
+
     // enables expr.val().val()
     inline value_expr<E> val() const { return *this; }
     index_t rows() const { return 0; }
@@ -2693,6 +2727,20 @@ private:
     template<class U> static inline
     typename util::enable_if<!U::ScalarValued,Scalar>::type
     eval_impl(const U & u, const index_t k) { return u.eval(k).value(); }
+
+    template<class U> static inline
+    typename util::enable_if<U::ScalarValued,void>::type
+    quad_impl(const U & u, const gsVector<Scalar> & w, Scalar & res)
+    { u.quadrature(w, res); }
+
+    template<class U> static inline
+    typename util::enable_if<!U::ScalarValued,void>::type
+    quad_impl(const U & u, const gsVector<Scalar> & w, Scalar & res)
+    {
+        gsMatrix<Scalar> tmp;
+        u.quadrature(w, tmp);
+        res = tmp.value();
+    }
 };
 
 template<class E>
@@ -3728,6 +3776,61 @@ public:
         return tmp; // assumes result is not scalarvalued
     }
 
+    // Scalar-valued factors are folded into the weights, the
+    // product of matrix-valued factors is summed over the points
+    // by a single matrix product
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        quad_impl(w, res, util::integral_constant<int, E2::ScalarValued ? 2 :
+                                                   (E1::ScalarValued ? 1 : 0)>());
+    }
+
+private:
+    mutable gsVector<Scalar> m_w;
+    mutable gsMatrix<Scalar> m_A, m_B;
+
+    template<class R>
+    void quad_impl(const gsVector<Scalar> & w, R & res,
+                   util::integral_constant<int,2>) const
+    {
+        m_w.resize(w.rows());
+        for (index_t k = 0; k != w.rows(); ++k)
+            m_w[k] = w[k] * _v.eval(k);
+        _u.quadrature(m_w, res);
+    }
+
+    template<class R>
+    void quad_impl(const gsVector<Scalar> & w, R & res,
+                   util::integral_constant<int,1>) const
+    {
+        m_w.resize(w.rows());
+        for (index_t k = 0; k != w.rows(); ++k)
+            m_w[k] = w[k] * _u.eval(k);
+        _v.quadrature(m_w, res);
+    }
+
+    //  sum_k w_k A_k B_k = [A_1 .. A_n] * [w_1 B_1; .. ; w_n B_n]
+    void quad_impl(const gsVector<Scalar> & w, gsMatrix<Scalar> & res,
+                   util::integral_constant<int,0>) const
+    {
+        const index_t nk = w.rows();
+        m_A = _u.eval(0);
+        m_B = w[0] * _v.eval(0);
+        const index_t c = m_B.rows();
+        GISMO_ASSERT(m_A.cols() == c, "Wrong dimensions "<<m_A.cols()<<"!="<<c<<" in * operation");
+        m_A.conservativeResize(gsEigen::NoChange, c*nk);
+        m_B.conservativeResize(c*nk, gsEigen::NoChange);
+        for (index_t k = 1; k != nk; ++k)
+        {
+            m_A.middleCols(k*c, c) = _u.eval(k);
+            m_B.middleRows(k*c, c) = w[k] * _v.eval(k);
+        }
+        res.noalias() = m_A * m_B;
+    }
+
+public:
+
     index_t rows() const { return E1::ScalarValued ? _v.rows()  : _u.rows(); }
     index_t cols() const { return E2::ScalarValued ? _u.cols()  : _v.cols(); }
     void parse(gsExprHelper<Scalar> & evList) const
@@ -3876,6 +3979,13 @@ public:
 
     }
 
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        _v.quadrature(w, res);
+        res *= _c;
+    }
+
     index_t rows() const { return _v.rows(); }
     index_t cols() const { return _v.cols(); }
 
@@ -4117,6 +4227,19 @@ public:
     AutoReturn_t eval(const index_t k) const
     { return ( _u.eval(k) / _v.eval(k) ); }
 
+    // The (scalar) denominator is folded into the weights
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        m_w.resize(w.rows());
+        for (index_t k = 0; k != w.rows(); ++k)
+            m_w[k] = w[k] / _v.eval(k);
+        _u.quadrature(m_w, res);
+    }
+private:
+    mutable gsVector<Scalar> m_w;
+public:
+
     index_t rows() const { return _u.rows(); }
     index_t cols() const { return _u.cols(); }
 
@@ -4154,6 +4277,13 @@ public:
     AutoReturn_t eval(const index_t k) const
     { return ( _u.eval(k) / _c ); }
 
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        _u.quadrature(w, res);
+        res /= _c;
+    }
+
     index_t rows() const { return _u.rows(); }
     index_t cols() const { return _u.cols(); }
 
@@ -4247,6 +4377,15 @@ public:
         return res;
     }
 
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        R tmp;
+        _u.quadrature(w, res);
+        _v.quadrature(w, tmp);
+        res += tmp;
+    }
+
     index_t rows() const { return _u.rows(); }
     index_t cols() const { return _u.cols(); }
 
@@ -4371,6 +4510,15 @@ public:
         return res;
     }
 
+    template<class R>
+    void quadrature_impl(const gsVector<Scalar> & w, R & res) const
+    {
+        R tmp;
+        _u.quadrature(w, res);
+        _v.quadrature(w, tmp);
+        res -= tmp;
+    }
+
     index_t rows() const { return _u.rows(); }
     index_t cols() const { return _u.cols(); }
 
@@ -0,0 +1,216 @@
+/** @file gsMapDataCache.h
+
+    @brief Element-level cache of geometry map evaluations
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#pragma once
+
+#include <gsCore/gsFuncData.h>
+
+#include <list>
+#include <unordered_map>
+
+namespace gismo
+{
+
+/**
+   @brief Cache of computed geometry map data (values, Jacobians,
+   measures, normals, ...) on the evaluation points of an element.
+
+   An entry is identified by the geometry map, the patch, the side,
+   the evaluation flags and the evaluation points themselves, ie. by
+   the element together with the quadrature rule. The total size of
+   the stored data is bounded by the capacity; the least recently used
+   entries are evicted first.
+
+   The cache does not notice changes of the geometry map; clear() has
+   to be called after the geometry has been modified.
+
+   The points are hashed by value (see util::hash_value), therefore
+   the cache is disabled (see supported()) for coefficient types which
+   do not provide util::hash_value.
+
+   \note A cache object is not thread-safe; gsExprHelper keeps one per
+   thread.
+
+   \ingroup Assembler
+*/
+template<class T>
+class gsMapDataCache
+{
+private:
+    struct _entry
+    {
+        const void * map;
+        unsigned     flags; // requested flags
+        size_t       hash;
+        size_t       bytes;
+        gsMapData<T> data;
+    };
+
+    typedef std::list<_entry> _list; // front: most recently used
+    typedef std::unordered_multimap<size_t,typename _list::iterator> _index;
+
+    _list  m_lru;
+    _index m_index;
+    size_t m_capacity, m_bytes;
+    size_t m_hits, m_misses;
+
+public:
+
+    /// Constructor, \a capacity is the maximum size of the data in bytes
+    explicit gsMapDataCache(size_t capacity = 0)
+    : m_capacity(capacity), m_bytes(0), m_hits(0), m_misses(0)
+    { }
+
+    /// True if the cache can be used for the coefficient type T
+    static bool supported() { return util::has_hash_value<T>::value; }
+
+    /// \brief Looks up the data of the map \a map on the points
+    /// md.points, for the patch, side and flags set in \a md. On
+    /// success the data is copied to \a md and true is returned.
+    bool get(const void * map, gsMapData<T> & md)
+    {
+        if (!supported())
+        {
+            ++m_misses;
+            return false;
+        }
+        const size_t h = hash(map, md, md.flags);
+        std::pair<typename _index::iterator,typename _index::iterator>
+            range = m_index.equal_range(h);
+        for (typename _index::iterator it = range.first; it != range.second; ++it)
+        {
+            const _entry & e = *it->second;
+            if ( e.map == map && e.data.patchId == md.patchId &&
+                 e.data.side.m_index == md.side.m_index && e.flags == md.flags &&
+                 e.data.points.rows() == md.points.rows() &&
+                 e.data.points.cols() == md.points.cols() &&
+                 e.data.points == md.points )
+            {
+                m_lru.splice(m_lru.begin(), m_lru, it->second);
+                md = e.data;
+                ++m_hits;
+                return true;
+            }
+        }
+        ++m_misses;
+        return false;
+    }
+
+    /// \brief Stores the data \a md computed for the map \a map, where
+    /// \a flags are the evaluation flags which were requested (the
+    /// computation may add further flags to md.flags)
+    void put(const void * map, const gsMapData<T> & md, unsigned flags)
+    {
+        const size_t b = bytes(md);
+        if (b > m_capacity || !supported()) return;
+        _entry e;
+        e.map   = map;
+        e.flags = flags;
+        e.hash  = hash(map, md, flags);
+        e.bytes = b;
+        e.data  = md;
+        m_lru.push_front(give(e));
+        m_index.insert(std::make_pair(m_lru.front().hash, m_lru.begin()));
+        m_bytes += b;
+        evict();
+    }
+
+    /// Sets the maximum size (in bytes) of the stored data, evicting
+    /// entries if necessary
+    void setCapacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        evict();
+    }
+
+    /// Returns the maximum size (in bytes) of the stored data
+    size_t capacity() const { return m_capacity; }
+
+    /// Returns the size (in bytes) of the stored data
+    size_t bytes() const { return m_bytes; }
+
+    /// Returns the number of stored elements
+    size_t size() const { return m_lru.size(); }
+
+    /// Number of successful look-ups
+    size_t hits() const { return m_hits; }
+
+    /// Number of failed look-ups
+    size_t misses() const { return m_misses; }
+
+    /// Sets the hit/miss statistics to zero
+    void resetStats() { m_hits = m_misses = 0; }
+
+    /// Removes all entries
+    void clear()
+    {
+        m_index.clear();
+        m_lru.clear();
+        m_bytes = 0;
+    }
+
+private:
+
+    // Removes the least recently used entries until the data fits
+    void evict()
+    {
+        while (m_bytes > m_capacity)
+        {
+            const _entry & e = m_lru.back();
+            std::pair<typename _index::iterator,typename _index::iterator>
+                range = m_index.equal_range(e.hash);
+            for (typename _index::iterator it = range.first; it != range.second; ++it)
+                if (&*it->second == &e)
+                {
+                    m_index.erase(it);
+                    break;
+                }
+            m_bytes -= e.bytes;
+            m_lru.pop_back();
+        }
+    }
+
+    static size_t hash(const void * map, const gsMapData<T> & md, unsigned flags)
+    {
+        size_t h = std::hash<const void*>()(map);
+        util::hash_combine(h, static_cast<size_t>(md.patchId));
+        util::hash_combine(h, static_cast<size_t>(md.side.m_index));
+        util::hash_combine(h, static_cast<size_t>(flags));
+        hashValues(h, md.points, util::has_hash_value<T>());
+        return h;
+    }
+
+    // Hashes the values of the points, since look-ups compare them by value
+    static void hashValues(size_t & h, const gsMatrix<T> & pts, std::true_type)
+    {
+        const T * v = pts.data();
+        for (index_t i = 0; i != pts.size(); ++i)
+            util::hash_combine(h, util::hash_value(v[i]));
+    }
+
+    // Not used, the cache is disabled for such types
+    static void hashValues(size_t &, const gsMatrix<T> &, std::false_type) { }
+
+    static size_t bytes(const gsMapData<T> & md)
+    {
+        size_t n = md.points.size() + md.measures.size() + md.fundForms.size()
+            + md.jacInvTr.size() + md.normals.size() + md.outNormals.size()
+            + md.curls.size() + md.divs.size() + md.laplacians.size();
+        for (size_t i = 0; i != md.values.size(); ++i)
+            n += md.values[i].size();
+        return n * sizeof(T) + md.actives.size() * sizeof(index_t)
+            + sizeof(_entry);
+    }
+};
+
+} // namespace gismo
@@ -18,6 +18,8 @@
 namespace gismo
 {
 
+struct gsJITCompilerConfig;
+
 /**
     @brief Class defining a multivariate (real or vector) function
     given by a string mathematical expression.
@@ -34,6 +36,12 @@ namespace gismo
 
     for more details.
 
+    Optionally, the expression can be translated to native code by
+    compile(): the values, the gradients and the second derivatives
+    (obtained by symbolic differentiation) are emitted as C++
+    functions which evaluate whole point matrices, and are compiled
+    by gsJITCompiler into a shared library. The library is cached on
+    disk, so an expression is compiled only once.
 
     The variables used are the ordered list:
 
@@ -145,6 +153,22 @@ public:
     /// \brief Adds another component to this (vector) function
     void addComponent(const std::string & strExpression);
 
+    /// \brief Compiles the expression to native code using the
+    /// compiler configuration \a cfg
+    ///
+    /// Returns false if the expression uses features which cannot
+    /// be translated, or if compilation fails; in that case the
+    /// expression is evaluated by the interpreter as usual. Adding a
+    /// component discards the compiled code.
+    bool compile(const gsJITCompilerConfig & cfg);
+
+    /// \brief Compiles the expression to native code using the
+    /// compiler that G+Smo was built with
+    bool compile();
+
+    /// \brief Returns true if the expression is evaluated by native code
+    bool isCompiled() const;
+
 private:
 
     // initializes the symbol table
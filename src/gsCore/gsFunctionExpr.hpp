@@ -106,6 +106,8 @@
 
 
 #include <gsIO/gsXml.h>
+#include <gsUtils/gsThreaded.h>
+#include <gsCore/gsFunctionExprKernel.h>
 
 namespace
 {
@@ -189,6 +191,9 @@ public:
     typedef exprtk::expression<Numeric_t>    Expression_t;
     typedef exprtk::parser<Numeric_t>        Parser_t;
 
+    // Signature of the native kernels, see gsSymExprKernel
+    typedef void (Kernel_t)(const T *, const int, const T *, T *);
+
 public:
 
     gsFunctionExprPrivate(const short_t _dim)
@@ -196,6 +201,7 @@ public:
     {
         GISMO_ENSURE( dim <= N_VARS, "The number of variables can be at most 7 (x,y,z,w,u,v,t)." );
         init();
+        std::fill(kernel, kernel+3, (Kernel_t*)NULL);
     }
 
     gsFunctionExprPrivate(const gsFunctionExprPrivate & other)
@@ -208,10 +214,36 @@ public:
         expression.reserve(string.size());
         for (size_t i = 0; i!= other.string.size(); ++i)
             addComponent(other.string[i]);
+        // the compiled code is shared
+        library = other.library;
+        std::copy(other.kernel, other.kernel+3, kernel);
+    }
+
+    /// Returns the instance to be used by the calling thread. The
+    /// master thread uses this instance, the other threads use
+    /// private copies which are compiled on first use. The settable
+    /// parameters (eg. time) are synchronized with this instance.
+    gsFunctionExprPrivate & local()
+    {
+#       ifdef _OPENMP
+        if ( 0 == omp_get_thread_num() ) return *this;
+        typename memory::unique_ptr<gsFunctionExprPrivate> & lc = threadCopy.mine();
+        if ( nullptr == lc )
+            lc.reset( new gsFunctionExprPrivate(*this) );
+        std::copy(vars + dim, vars + N_VARS, lc->vars + dim);
+        return *lc;
+#       else
+        return *this;
+#       endif
     }
 
     void addComponent(const std::string & strExpression)
     {
+        // Thread-local copies and compiled code are out of date
+        threadCopy = util::gsThreaded<memory::unique_ptr<gsFunctionExprPrivate> >();
+        library = gsDynamicLibrary();
+        std::fill(kernel, kernel+3, (Kernel_t*)NULL);
+
         string.push_back( strExpression );// Keep string data
         std::string & str = string.back();
         str.erase(std::remove(str.begin(), str.end(),' '), str.end() );
@@ -260,6 +292,93 @@ public:
         //symbol_table.add_constant("C", 1);
     }
 
+    /// Generates and compiles the native kernels for the values,
+    /// the gradients and the second derivatives
+    bool compile(const gsJITCompilerConfig & cfg)
+    {
+        library = gsDynamicLibrary();
+        std::fill(kernel, kernel+3, (Kernel_t*)NULL);
+
+        const char * real = util::is_same<T,double>::value ? "double" :
+            util::is_same<T,float>::value ? "float" :
+            util::is_same<T,long double>::value ? "long double" : NULL;
+        if ( NULL==real )
+        {
+            gsWarn<<"gsFunctionExpr: cannot compile for type "
+                  << util::type<T>::name() <<".\n";
+            return false;
+        }
+
+        typedef internal::gsSymExpr::Ptr Sym;
+        internal::gsSymExprPool   pool;
+        internal::gsSymExprParser parser(pool);
+        const short_t n = static_cast<short_t>(string.size());
+        std::vector<Sym> val(n), grad(n*dim), hess;
+        for (short_t c = 0; c!= n; ++c)
+        {
+            if ( ! (val[c] = parser.parse(string[c])) )
+            {
+                gsWarn<<"gsFunctionExpr: cannot compile "<< string[c]
+                      <<", using the interpreter.\n";
+                return false;
+            }
+
+            for (short_t k = 0; k!=dim; ++k)
+                grad[c*dim+k] = pool.diff(val[c], k);
+            // second derivatives: diagonal, then upper triangle row-wise
+            for (short_t k = 0; k!=dim; ++k)
+                hess.push_back( pool.diff(grad[c*dim+k], k) );
+            for (short_t k = 0; k!=dim; ++k)
+                for (short_t l = k+1; l<dim; ++l)
+                    hess.push_back( pool.diff(grad[c*dim+k], l) );
+        }
+
+        gsJITCompiler jit(cfg);
+        std::ostringstream & src = jit.getKernel();
+        src << "// gsFunctionExpr, dim="<< dim <<":";
+        for (short_t c = 0; c!= n; ++c)
+            src <<" "<< string[c];
+        src <<"\n#include <cmath>\n#include <algorithm>\n"
+            <<"typedef "<< real <<" real;\n"
+            <<"static inline real sgn(const real a) { return real((real(0)<a)-(a<real(0))); }\n\n";
+        internal::gsSymExprKernel(src, pool, "gsFunctionExpr_eval"  , dim, val );
+        internal::gsSymExprKernel(src, pool, "gsFunctionExpr_deriv" , dim, grad);
+        internal::gsSymExprKernel(src, pool, "gsFunctionExpr_deriv2", dim, hess);
+
+        try
+        {
+            library   = jit.build(); // cached by the hash of the source
+            kernel[0] = library.getSymbol<Kernel_t>("gsFunctionExpr_eval"  );
+            kernel[1] = library.getSymbol<Kernel_t>("gsFunctionExpr_deriv" );
+            kernel[2] = library.getSymbol<Kernel_t>("gsFunctionExpr_deriv2");
+        }
+        catch (std::exception & e)
+        {
+            gsWarn<<"gsFunctionExpr: compilation failed ("<< e.what()
+                  <<"), using the interpreter.\n";
+            library = gsDynamicLibrary();
+            std::fill(kernel, kernel+3, (Kernel_t*)NULL);
+            return false;
+        }
+        return true;
+    }
+
+    /// Evaluates native kernel \a i (values, gradients or second
+    /// derivatives) on all points \a u, with \a m entries per point
+    void evalKernel(const int i, const gsMatrix<T> & u, const index_t m,
+                    gsMatrix<T> & result) const
+    {
+        T par[N_VARS]; // the settable parameters
+        for (short_t k = dim; k!=N_VARS; ++k)
+#           ifdef GISMO_WITH_ADIFF
+            par[k] = vars[k].getValue();
+#           else
+            par[k] = vars[k];
+#           endif
+        result.resize(m, u.cols());
+        kernel[i](u.data(), static_cast<int>(u.cols()), par, result.data());
+    }
+
 public:
     mutable Numeric_t         vars[N_VARS];
     SymbolTable_t             symbol_table;
@@ -267,6 +386,13 @@ public:
     std::vector<std::string>  string;
     short_t dim;
 
+    // Private copies of the compiled expressions, one per thread
+    util::gsThreaded<memory::unique_ptr<gsFunctionExprPrivate> > threadCopy;
+
+    // Native code for values, gradients and second derivatives (optional)
+    gsDynamicLibrary library;
+    Kernel_t * kernel[3];
+
 private:
     gsFunctionExprPrivate();
     gsFunctionExprPrivate operator= (const gsFunctionExprPrivate & other);
@@ -488,6 +614,61 @@ const std::string & gsFunctionExpr<T>::expression(int i) const
     return my->string[i];
 }
 
+template<typename T>
+bool gsFunctionExpr<T>::compile()
+{
+    return compile( gsJITCompilerConfig::guess() );
+}
+
+template<typename T>
+bool gsFunctionExpr<T>::compile(const gsJITCompilerConfig & cfg)
+{
+    if ( ! my->compile(cfg) )
+        return false;
+
+    // Check the generated code (values, gradients and second
+    // derivatives) against the interpreter. Without automatic
+    // differentiation the interpreter uses finite differences,
+    // therefore the tolerance grows with the order of the derivative
+    static const char * what[3] = {"values", "derivatives", "second derivatives"};
+    const T tol[3] = {1e-10, 1e-6, 1e-4};
+    gsMatrix<T> pts = gsMatrix<T>::Random(my->dim, 5), ref, val;
+    for (int k = 0; k != 3; ++k)
+    {
+        typename PrivateData_t::Kernel_t * kernel = my->kernel[k];
+        for (int run = 0; run != 2; ++run) // interpreter, then compiled code
+        {
+            gsMatrix<T> & res = (0==run ? ref : val);
+            my->kernel[k] = (0==run ? NULL : kernel);
+            switch (k)
+            {
+            case 0 : eval_into  (pts, res); break;
+            case 1 : deriv_into (pts, res); break;
+            default: deriv2_into(pts, res); break;
+            }
+        }
+
+        for (index_t i = 0; i!=ref.size(); ++i)
+        {
+            const T & a = ref.at(i), & b = val.at(i);
+            if ( (a!=a && b!=b) || math::abs(a-b) <= tol[k] * (1 + math::abs(a)) )
+                continue;
+            gsWarn<<"gsFunctionExpr: compiled "<< what[k] <<" do not match the "
+                  <<"interpreter (" << a <<" vs "<< b <<"), using the interpreter.\n";
+            my->library = gsDynamicLibrary();
+            std::fill(my->kernel, my->kernel+3, (typename PrivateData_t::Kernel_t*)NULL);
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+bool gsFunctionExpr<T>::isCompiled() const
+{
+    return NULL != my->kernel[0];
+}
+
 template<typename T>
 void gsFunctionExpr<T>::set_x (T const & v) const { my->vars[0]= v; }
 
@@ -516,18 +697,20 @@ void gsFunctionExpr<T>::eval_into(const gsMatrix<T>& u, gsMatrix<T>& result) con
                    << my->dim <<", got "<< u.rows() <<")\n"<< *this);
 
     const short_t n = targetDim();
+    if ( my->kernel[0] ) // native code, see compile()
+        return my->evalKernel(0, u, n, result);
     result.resize(n, u.cols());
 
-#pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
 
         for (short_t c = 0; c!= n; ++c) // for all components
 #           ifdef GISMO_WITH_ADIFF
-            result(c,p) = my->expression[c].value().getValue();
+            result(c,p) = lc.expression[c].value().getValue();
 #           else
-            result(c,p) = my->expression[c].value();
+            result(c,p) = lc.expression[c].value();
 #           endif
     }
 }
@@ -542,15 +725,15 @@ void gsFunctionExpr<T>::eval_component_into(const gsMatrix<T>& u, const index_t
                   "Given component number is higher then number of components");
 
     result.resize(1, u.cols());
-#   pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for ( index_t p = 0; p!=u.cols(); ++p )
     {
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
 
 #           ifdef GISMO_WITH_ADIFF
-            result(0,p) = my->expression[comp].value().getValue();
+            result(0,p) = lc.expression[comp].value().getValue();
 #           else
-            result(0,p) = my->expression[comp].value();
+            result(0,p) = lc.expression[comp].value();
 #           endif
     }
 }
@@ -564,22 +747,24 @@ void gsFunctionExpr<T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) co
                    << my->dim <<", got "<< u.rows() <<")");
 
     const short_t n = targetDim();
+    if ( my->kernel[1] ) // native code, see compile()
+        return my->evalKernel(1, u, d*n, result);
     result.resize(d*n, u.cols());
-#   pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
 #       ifdef GISMO_WITH_ADIFF
         for (short_t k = 0; k!=d; ++k)
-            my->vars[k].setVariable(k,d,u(k,p));
+            lc.vars[k].setVariable(k,d,u(k,p));
         for (short_t c = 0; c!= n; ++c) // for all components
-            my->expression[c].value().gradient_into(result.block(c*d,p,d,1));
-            //result.block(c*d,p,d,1) = my->expression[c].value().getGradient(); //fails on constants
+            lc.expression[c].value().gradient_into(result.block(c*d,p,d,1));
+            //result.block(c*d,p,d,1) = lc.expression[c].value().getGradient(); //fails on constants
 #       else
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
         for (short_t c = 0; c!= n; ++c) // for all components
             for ( short_t j = 0; j!=d; j++ ) // for all variables
                 result(c*d + j, p) =
-                    exprtk::derivative<T>(my->expression[c], my->vars[j], 0.00001 ) ;
+                    exprtk::derivative<T>(lc.expression[c], lc.vars[j], 0.00001 ) ;
 #       endif
     }
 }
@@ -593,43 +778,45 @@ void gsFunctionExpr<T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result) c
 
     const short_t n = targetDim();
     const index_t stride = d + d*(d-1)/2;
+    if ( my->kernel[2] ) // native code, see compile()
+        return my->evalKernel(2, u, stride*n, result);
     result.resize(stride*n, u.cols() );
-#   pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for ( index_t p = 0; p!=u.cols(); p++ ) // for all evaluation points
     {
 #       ifndef GISMO_WITH_ADIFF
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
 #       endif
 
         for (short_t c = 0; c!= n; ++c) // for all components
         {
 #           ifdef GISMO_WITH_ADIFF
             for (index_t v = 0; v!=d; ++v)
-                my->vars[v].setVariable(v,d,u(v,p));
-            const DScalar &            ads  = my->expression[c].value();
+                lc.vars[v].setVariable(v,d,u(v,p));
+            const DScalar &            ads  = lc.expression[c].value();
             const DScalar::Hessian_t & Hmat = ads.getHessian(); // note: can fail
 
+            index_t m = c*stride + d;
             for ( index_t k=0; k!=d; ++k)
             {
-                result(k,p) = Hmat(k,k);
-                index_t m = d;
+                result(c*stride+k,p) = Hmat(k,k);
                 for ( index_t l=k+1; l<d; ++l)
                     result(m++,p) = Hmat(k,l);
             }
 #           else
+            index_t m = c*stride + d;
             for (short_t k = 0; k!=d; ++k)
             {
                 // H_{k,k}
-                result(k,p) = exprtk::
-                    second_derivative<T>(my->expression[c], my->vars[k], 0.00001);
+                result(c*stride+k,p) = exprtk::
+                    second_derivative<T>(lc.expression[c], lc.vars[k], 0.00001);
 
-                short_t m = d;
                 for (short_t l=k+1; l<d; ++l)
                 {
                     // H_{k,l}
                     result(m++,p) =
-                        mixed_derivative<T>( my->expression[c], my->vars[k],
-                                             my->vars[l], 0.00001 );
+                        mixed_derivative<T>( lc.expression[c], lc.vars[k],
+                                             lc.vars[l], 0.00001 );
                 }
             }
 #           endif
@@ -650,26 +837,24 @@ gsFunctionExpr<T>::hess(const gsMatrix<T>& u, unsigned coord) const
 
     gsMatrix<T> res(d, d);
 
-#   pragma omp critical (gsFunctionExpr_run)
-{
+    PrivateData_t & lc = my->local(); // thread-local instance
 #   ifdef GISMO_WITH_ADIFF
     for (index_t v = 0; v!=d; ++v)
-        my->vars[v].setVariable(v, d, u(v,0) );
-    my->expression[coord].value().hessian_into(res);
+        lc.vars[v].setVariable(v, d, u(v,0) );
+    lc.expression[coord].value().hessian_into(res);
 #   else
-    copy_n(u.data(), my->dim, my->vars);
+    copy_n(u.data(), my->dim, lc.vars);
     for( index_t j=0; j!=d; ++j )
     {
         res(j,j) = exprtk::
-            second_derivative<T>( my->expression[coord], my->vars[j], 0.00001);
+            second_derivative<T>( lc.expression[coord], lc.vars[j], 0.00001);
 
         for( index_t k = 0; k!=j; ++k )
             res(k,j) = res(j,k) =
-                mixed_derivative<T>( my->expression[coord], my->vars[k],
-                                     my->vars[j], 0.00001 );
+                mixed_derivative<T>( lc.expression[coord], lc.vars[k],
+                                     lc.vars[j], 0.00001 );
     }
 #   endif
-}
     return res;
 }
 
@@ -682,22 +867,22 @@ gsMatrix<T> * gsFunctionExpr<T>::mderiv(const gsMatrix<T> & u,
     const short_t n = targetDim();
     gsMatrix<T> * res= new gsMatrix<T>(n,u.cols()) ;
 
-#   pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for( index_t p=0; p!=res->cols(); ++p )
     {
 #       ifndef GISMO_WITH_ADIFF
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
 #       endif
 
         for (short_t c = 0; c!= n; ++c) // for all components
         {
 #           ifdef GISMO_WITH_ADIFF
             for (index_t v = 0; v!=my->dim; ++v)
-                my->vars[v].setVariable(v, my->dim, u(v,p) );
-            (*res)(c,p) = my->expression[c].value().getHessian()(k,j); //note: can fail
+                lc.vars[v].setVariable(v, my->dim, u(v,p) );
+            (*res)(c,p) = lc.expression[c].value().getHessian()(k,j); //note: can fail
 #           else
             (*res)(c,p) =
-                mixed_derivative<T>( my->expression[c], my->vars[k], my->vars[j], 0.00001 ) ;
+                mixed_derivative<T>( lc.expression[c], lc.vars[k], lc.vars[j], 0.00001 ) ;
 #           endif
         }
     }
@@ -712,24 +897,24 @@ gsMatrix<T> gsFunctionExpr<T>::laplacian(const gsMatrix<T>& u) const
     const short_t n = targetDim();
     gsMatrix<T> res(n,u.cols());
 
-    #   pragma omp critical (gsFunctionExpr_run)
+    PrivateData_t & lc = my->local(); // thread-local instance
     for( index_t p = 0; p != res.cols(); ++p )
     {
 #       ifndef GISMO_WITH_ADIFF
-        copy_n(u.col(p).data(), my->dim, my->vars);
+        copy_n(u.col(p).data(), my->dim, lc.vars);
 #       endif
 
         for (short_t c = 0; c!= n; ++c) // for all components
         {
 #           ifdef GISMO_WITH_ADIFF
             for (index_t v = 0; v!=my->dim; ++v)
-                my->vars[v].setVariable(v, my->dim, u(v,p) );
-            res(c,p) = my->expression[c].value().getHessian().trace();
+                lc.vars[v].setVariable(v, my->dim, u(v,p) );
+            res(c,p) = lc.expression[c].value().getHessian().trace();
 #           else
             T & val = res(c,p);
             for ( index_t j = 0; j!=my->dim; ++j )
                 val += exprtk::
-                    second_derivative<T>( my->expression[c], my->vars[j], 0.00001 );
+                    second_derivative<T>( lc.expression[c], lc.vars[j], 0.00001 );
 #           endif
         }
     }
@@ -0,0 +1,561 @@
+/** @file gsFunctionExprKernel.h
+
+    @brief Symbolic representation of string expressions, used to
+    generate native evaluation kernels for gsFunctionExpr.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#pragma once
+
+#include <gsCore/gsJITCompiler.h>
+
+#include <cctype>
+#include <limits>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+/**
+   @brief Node of a symbolic expression tree.
+
+   Nodes are immutable and are created (and shared) through
+   gsSymExprPool, so that identical sub-expressions are represented
+   by the same node.
+*/
+struct gsSymExpr
+{
+    enum op_t
+    {
+        Num, Var,
+        Add, Sub, Mul, Div, Pow, Neg,
+        Lt, Le, Gt, Ge, Eq, Ne, If,
+        Sin, Cos, Tan, Asin, Acos, Atan, Atan2,
+        Sinh, Cosh, Tanh, Exp, Log, Log10, Sqrt,
+        Abs, Sgn, Floor, Ceil, Min, Max
+    };
+
+    typedef const gsSymExpr * Ptr;
+
+    gsSymExpr(op_t _op, double _val, int _var, Ptr _a, Ptr _b, Ptr _c)
+    : op(_op), val(_val), var(_var), a(_a), b(_b), c(_c) { }
+
+    bool isNum() const { return Num==op; }
+    bool isNum(double v) const { return Num==op && v==val; }
+    bool isLeaf() const { return Num==op || Var==op; }
+
+    op_t   op;
+    double val;
+    int    var;
+    Ptr    a, b, c;
+};
+
+/**
+   @brief Creates, simplifies, differentiates and prints symbolic
+   expressions.
+
+   The pool owns all nodes. Nodes are hash-consed, ie. creating an
+   expression which exists already returns the existing node; the
+   code generator uses this to emit common sub-expressions only
+   once.
+*/
+class gsSymExprPool
+{
+public:
+    typedef gsSymExpr::Ptr Ptr;
+    typedef gsSymExpr      E;
+
+public:
+
+    Ptr num(double v) { return make(E::Num, v, -1); }
+
+    Ptr var(int i) { return make(E::Var, 0, i); }
+
+    Ptr add(Ptr a, Ptr b)
+    {
+        if (a->isNum() && b->isNum()) return num(a->val + b->val);
+        if (a->isNum(0)) return b;
+        if (b->isNum(0)) return a;
+        if (a==b) return mul(num(2),a);
+        return make(E::Add, 0, -1, a, b);
+    }
+
+    Ptr sub(Ptr a, Ptr b)
+    {
+        if (a->isNum() && b->isNum()) return num(a->val - b->val);
+        if (b->isNum(0)) return a;
+        if (a->isNum(0)) return neg(b);
+        if (a==b) return num(0);
+        return make(E::Sub, 0, -1, a, b);
+    }
+
+    Ptr mul(Ptr a, Ptr b)
+    {
+        if (a->isNum() && b->isNum()) return num(a->val * b->val);
+        if (a->isNum(0) || b->isNum(0)) return num(0);
+        if (a->isNum(1)) return b;
+        if (b->isNum(1)) return a;
+        if (a->isNum(-1)) return neg(b);
+        if (b->isNum(-1)) return neg(a);
+        if (b->isNum()) std::swap(a,b); // constants first
+        return make(E::Mul, 0, -1, a, b);
+    }
+
+    Ptr div(Ptr a, Ptr b)
+    {
+        if (a->isNum() && b->isNum() && 0!=b->val) return num(a->val / b->val);
+        if (a->isNum(0)) return num(0);
+        if (b->isNum(1)) return a;
+        return make(E::Div, 0, -1, a, b);
+    }
+
+    Ptr pow(Ptr a, Ptr b)
+    {
+        if (a->isNum() && b->isNum()) return num(std::pow(a->val, b->val));
+        if (b->isNum(0)) return num(1);
+        if (b->isNum(1)) return a;
+        if (b->isNum(2)) return mul(a,a);
+        return make(E::Pow, 0, -1, a, b);
+    }
+
+    Ptr neg(Ptr a)
+    {
+        if (a->isNum()) return num(-a->val);
+        if (E::Neg==a->op) return a->a;
+        return make(E::Neg, 0, -1, a);
+    }
+
+    Ptr fun(E::op_t op, Ptr a, Ptr b = NULL, Ptr c = NULL)
+    {
+        if (E::If==op && a->isNum()) return 0!=a->val ? b : c;
+        if (E::If==op && b==c) return b;
+        return make(op, 0, -1, a, b, c);
+    }
+
+    /// Partial derivative of \a e with respect to variable \a k
+    Ptr diff(Ptr e, int k)
+    {
+        switch (e->op)
+        {
+        case E::Num: return num(0);
+        case E::Var: return num(e->var==k ? 1 : 0);
+        case E::Add: return add(diff(e->a,k), diff(e->b,k));
+        case E::Sub: return sub(diff(e->a,k), diff(e->b,k));
+        case E::Neg: return neg(diff(e->a,k));
+        case E::Mul: return add(mul(diff(e->a,k),e->b), mul(e->a,diff(e->b,k)));
+        case E::Div:
+            return sub(div(diff(e->a,k),e->b), div(mul(e->a,diff(e->b,k)),mul(e->b,e->b)));
+        case E::Pow:
+            if (e->b->isNum()) // power rule
+                return mul(mul(e->b,pow(e->a,num(e->b->val-1))), diff(e->a,k));
+            return mul(e, add(mul(diff(e->b,k), fun(E::Log,e->a)),
+                              div(mul(e->b,diff(e->a,k)), e->a)));
+        case E::Lt: case E::Le: case E::Gt: case E::Ge: case E::Eq: case E::Ne:
+        case E::Sgn: case E::Floor: case E::Ceil:
+            return num(0);
+        case E::If : return fun(E::If, e->a, diff(e->b,k), diff(e->c,k));
+        case E::Min: return fun(E::If, fun(E::Lt,e->a,e->b), diff(e->a,k), diff(e->b,k));
+        case E::Max: return fun(E::If, fun(E::Gt,e->a,e->b), diff(e->a,k), diff(e->b,k));
+        default: break;
+        }
+
+        // Unary functions: chain rule
+        Ptr da = diff(e->a,k);
+        if (E::Atan2==e->op) // atan2(a,b)
+            return div(sub(mul(e->b,da),mul(e->a,diff(e->b,k))),
+                       add(mul(e->a,e->a),mul(e->b,e->b)));
+        if (da->isNum(0)) return da;
+        Ptr a = e->a;
+        switch (e->op)
+        {
+        case E::Sin : return mul(fun(E::Cos,a), da);
+        case E::Cos : return neg(mul(fun(E::Sin,a), da));
+        case E::Tan : return div(da, mul(fun(E::Cos,a),fun(E::Cos,a)));
+        case E::Asin: return div(da, fun(E::Sqrt,sub(num(1),mul(a,a))));
+        case E::Acos: return neg(div(da, fun(E::Sqrt,sub(num(1),mul(a,a)))));
+        case E::Atan: return div(da, add(num(1),mul(a,a)));
+        case E::Sinh: return mul(fun(E::Cosh,a), da);
+        case E::Cosh: return mul(fun(E::Sinh,a), da);
+        case E::Tanh: return mul(sub(num(1),mul(e,e)), da);
+        case E::Exp : return mul(e, da);
+        case E::Log : return div(da, a);
+        case E::Log10: return div(da, mul(num(std::log(10.0)),a));
+        case E::Sqrt: return div(da, mul(num(2),e));
+        case E::Abs : return mul(fun(E::Sgn,a), da);
+        default: GISMO_ERROR("Unknown operation");
+        }
+    }
+
+    /// Writes C++ code for \a e, using the names in \a tmp for
+    /// sub-expressions which were already computed
+    void print(std::ostream & os, Ptr e, const std::map<Ptr,std::string> & tmp) const
+    {
+        std::map<Ptr,std::string>::const_iterator it = tmp.find(e);
+        if (tmp.end()!=it) { os << it->second; return; }
+
+        static const char * bin[] = {"+","-","*","/"};
+        static const char * cmp[] = {"<","<=",">",">=","==","!="};
+        switch (e->op)
+        {
+        case E::Num:
+            os << "real(" << std::scientific
+               << std::setprecision(std::numeric_limits<double>::max_digits10)
+               << e->val << ")";
+            return;
+        case E::Var: os << "_v" << e->var; return;
+        case E::Add: case E::Sub: case E::Mul: case E::Div:
+            os << "("; print(os,e->a,tmp); os << bin[e->op-E::Add];
+            print(os,e->b,tmp); os << ")";
+            return;
+        case E::Neg: os << "(-"; print(os,e->a,tmp); os << ")"; return;
+        case E::Lt: case E::Le: case E::Gt: case E::Ge: case E::Eq: case E::Ne:
+            os << "(("; print(os,e->a,tmp); os << cmp[e->op-E::Lt];
+            print(os,e->b,tmp); os << ")?real(1):real(0))";
+            return;
+        case E::If:
+            os << "(("; print(os,e->a,tmp); os << ")!=real(0)?";
+            print(os,e->b,tmp); os << ":"; print(os,e->c,tmp); os << ")";
+            return;
+        case E::Sgn:
+            os << "sgn("; print(os,e->a,tmp); os << ")";
+            return;
+        default:
+            break;
+        }
+        os << "std::" << name(e->op) << "(";
+        print(os,e->a,tmp);
+        if (e->b) { os << ","; print(os,e->b,tmp); }
+        os << ")";
+    }
+
+    /// Returns the operation of the function \a name, or Num if
+    /// there is no function with that name
+    static E::op_t function(const std::string & name)
+    {
+        for (int i = E::Pow; i <= E::Max; ++i)
+            if (name == gsSymExprPool::name(static_cast<E::op_t>(i)))
+                return static_cast<E::op_t>(i);
+        return E::Num;
+    }
+
+    static const char * name(E::op_t op)
+    {
+        switch (op)
+        {
+        case E::Pow  : return "pow";
+        case E::If   : return "if";
+        case E::Sin  : return "sin";
+        case E::Cos  : return "cos";
+        case E::Tan  : return "tan";
+        case E::Asin : return "asin";
+        case E::Acos : return "acos";
+        case E::Atan : return "atan";
+        case E::Atan2: return "atan2";
+        case E::Sinh : return "sinh";
+        case E::Cosh : return "cosh";
+        case E::Tanh : return "tanh";
+        case E::Exp  : return "exp";
+        case E::Log  : return "log";
+        case E::Log10: return "log10";
+        case E::Sqrt : return "sqrt";
+        case E::Abs  : return "abs";
+        case E::Sgn  : return "sgn";
+        case E::Floor: return "floor";
+        case E::Ceil : return "ceil";
+        case E::Min  : return "min";
+        case E::Max  : return "max";
+        default      : return "";
+        }
+    }
+
+    /// Number of arguments of function \a op
+    static int arity(E::op_t op)
+    {
+        switch (op)
+        {
+        case E::If   : return 3;
+        case E::Pow  : case E::Atan2: return 2;
+        case E::Min  : case E::Max  : return -1; // variadic
+        default      : return 1;
+        }
+    }
+
+private:
+
+    Ptr make(E::op_t op, double val, int var,
+             Ptr a = NULL, Ptr b = NULL, Ptr c = NULL)
+    {
+        std::ostringstream key;
+        key << op << ':' << std::hexfloat << val << ':' << var << ':'
+            << a << ':' << b << ':' << c;
+        memory::shared_ptr<gsSymExpr> & node = m_nodes[key.str()];
+        if (!node)
+            node.reset(new gsSymExpr(op, val, var, a, b, c));
+        return node.get();
+    }
+
+private:
+    std::map<std::string, memory::shared_ptr<gsSymExpr> > m_nodes;
+};
+
+/**
+   @brief Recursive-descent parser translating an expression string
+   (in the syntax accepted by gsFunctionExpr) to a gsSymExpr tree.
+
+   Only the part of the ExprTk grammar which has a closed-form
+   derivative is supported; for anything else parse() returns NULL.
+*/
+class gsSymExprParser
+{
+public:
+    typedef gsSymExpr::Ptr Ptr;
+    typedef gsSymExpr      E;
+
+    explicit gsSymExprParser(gsSymExprPool & pool) : m_pool(pool), m_pos(0) { }
+
+    /// Returns the expression tree of \a str, or NULL on failure
+    Ptr parse(const std::string & str)
+    {
+        m_str = str;
+        m_pos = 0;
+        Ptr res = ternary();
+        return (res && m_pos==m_str.size()) ? res : NULL;
+    }
+
+private:
+
+    bool accept(const char * tok)
+    {
+        const size_t n = std::strlen(tok);
+        if ( 0!=m_str.compare(m_pos, n, tok) ) return false;
+        m_pos += n;
+        return true;
+    }
+
+    char peek() const { return m_pos<m_str.size() ? m_str[m_pos] : '\0'; }
+
+    // cond ? a : b
+    Ptr ternary()
+    {
+        Ptr c = comparison();
+        if (!c || !accept("?")) return c;
+        Ptr a = ternary();
+        if (!a || !accept(":")) return NULL;
+        Ptr b = ternary();
+        return b ? m_pool.fun(E::If, c, a, b) : NULL;
+    }
+
+    Ptr comparison()
+    {
+        Ptr a = additive();
+        if (!a) return NULL;
+        E::op_t op;
+        if      (accept("<=")) op = E::Le;
+        else if (accept(">=")) op = E::Ge;
+        else if (accept("==")) op = E::Eq;
+        else if (accept("!=") || accept("<>")) op = E::Ne;
+        else if (accept("<" )) op = E::Lt;
+        else if (accept(">" )) op = E::Gt;
+        else if (accept("=" )) op = E::Eq;
+        else return a;
+        Ptr b = additive();
+        return b ? m_pool.fun(op, a, b) : NULL;
+    }
+
+    Ptr additive()
+    {
+        Ptr a = multiplicative();
+        while (a)
+        {
+            if      (accept("+")) { Ptr b = multiplicative(); a = b ? m_pool.add(a,b) : NULL; }
+            else if (accept("-")) { Ptr b = multiplicative(); a = b ? m_pool.sub(a,b) : NULL; }
+            else break;
+        }
+        return a;
+    }
+
+    Ptr multiplicative()
+    {
+        Ptr a = unary();
+        while (a)
+        {
+            if      (accept("*")) { Ptr b = unary(); a = b ? m_pool.mul(a,b) : NULL; }
+            else if (accept("/")) { Ptr b = unary(); a = b ? m_pool.div(a,b) : NULL; }
+            else break;
+        }
+        return a;
+    }
+
+    // Unary minus binds weaker than the power, ie. -x^2 = -(x^2)
+    Ptr unary()
+    {
+        if (accept("-")) { Ptr a = unary(); return a ? m_pool.neg(a) : NULL; }
+        if (accept("+")) return unary();
+        return power();
+    }
+
+    // The power is right-associative, ie. 2^3^2 = 2^9
+    Ptr power()
+    {
+        Ptr a = primary();
+        if (!a || !accept("^")) return a;
+        Ptr b = unary();
+        return b ? m_pool.pow(a,b) : NULL;
+    }
+
+    Ptr primary()
+    {
+        const char ch = peek();
+        if ( std::isdigit(ch) || '.'==ch )
+        {
+            const char * begin = m_str.c_str() + m_pos;
+            char * end;
+            const double v = std::strtod(begin, &end);
+            if (end==begin) return NULL;
+            m_pos += end - begin;
+            Ptr a = m_pool.num(v);
+            // implicit multiplication, eg. 2x or 2(x+1)
+            const char nx = peek();
+            if ( std::isalpha(nx) || '_'==nx || '('==nx )
+            {
+                Ptr b = power();
+                return b ? m_pool.mul(a,b) : NULL;
+            }
+            return a;
+        }
+
+        const char * close = NULL;
+        if      (accept("(")) close = ")";
+        else if (accept("[")) close = "]";
+        else if (accept("{")) close = "}";
+        if (close)
+        {
+            Ptr a = ternary();
+            return (a && accept(close)) ? a : NULL;
+        }
+
+        if ( !std::isalpha(ch) && '_'!=ch ) return NULL;
+
+        std::string id;
+        while ( std::isalnum(peek()) || '_'==peek() )
+            id.push_back( static_cast<char>(std::tolower(m_str[m_pos++])) );
+
+        static const char * vars = "xyzwuvt";
+        if ( 1==id.size() && std::strchr(vars, id[0]) )
+            return m_pool.var( static_cast<int>(std::strchr(vars, id[0]) - vars) );
+        if ( "pi"==id )
+            return m_pool.num(EIGEN_PI);
+
+        const E::op_t op = gsSymExprPool::function(id);
+        if ( E::Num==op || !accept("(") ) return NULL;
+        std::vector<Ptr> args;
+        do
+        {
+            Ptr a = ternary();
+            if (!a) return NULL;
+            args.push_back(a);
+        } while (accept(","));
+        if ( !accept(")") ) return NULL;
+
+        const int n = gsSymExprPool::arity(op);
+        if (-1==n) // min/max of a list of arguments
+        {
+            Ptr a = args.front();
+            for (size_t i = 1; i < args.size(); ++i)
+                a = m_pool.fun(op, a, args[i]);
+            return a;
+        }
+        if (static_cast<size_t>(n)!=args.size()) return NULL;
+        switch (op)
+        {
+        case E::Pow: return m_pool.pow(args[0], args[1]);
+        case E::If : return m_pool.fun(op, args[0], args[1], args[2]);
+        default    : return m_pool.fun(op, args[0], 2==n ? args[1] : NULL);
+        }
+    }
+
+private:
+    gsSymExprPool & m_pool;
+    std::string     m_str;
+    size_t          m_pos;
+};
+
+/**
+   @brief Generates the source code of a function
+   \code
+   EXPORT void name(const real * u, const int np, const real * par, real * out)
+   \endcode
+   which evaluates the expressions \a expr for all \a np points given
+   column-wise in \a u (of dimension \a dim). Variables with index
+   \a dim and higher are read from \a par. The results are written
+   column-wise (\a expr.size() values per point) in \a out.
+
+   Sub-expressions which are shared by several entries are computed
+   once per point.
+*/
+inline void gsSymExprKernel(std::ostream & os, const gsSymExprPool & pool,
+                            const std::string & name, const short_t dim,
+                            const std::vector<gsSymExpr::Ptr> & expr)
+{
+    typedef gsSymExpr::Ptr Ptr;
+
+    // Count the uses of each node and sort the nodes, children first
+    std::map<Ptr,int> count;
+    std::vector<Ptr> order;
+    struct visitor
+    {
+        static void apply(Ptr e, std::map<Ptr,int> & cnt, std::vector<Ptr> & ord)
+        {
+            if (1 < ++cnt[e] || e->isLeaf()) return;
+            if (e->a) apply(e->a, cnt, ord);
+            if (e->b) apply(e->b, cnt, ord);
+            if (e->c) apply(e->c, cnt, ord);
+            ord.push_back(e);
+        }
+    };
+    for (size_t i = 0; i != expr.size(); ++i)
+        visitor::apply(expr[i], count, order);
+
+    os << "EXPORT void " << name << "(const real * __restrict u, const int np,"
+       << " const real * __restrict par, real * __restrict out)\n{\n";
+    for (int k = dim; k < 7; ++k)
+        os << "    const real _v" << k << " = par[" << k << "];\n";
+    os << "    for (int p = 0; p < np; ++p, u += " << dim << ", out += "
+       << expr.size() << ")\n    {\n";
+    for (int k = 0; k < dim; ++k)
+        os << "        const real _v" << k << " = u[" << k << "];\n";
+
+    // Shared sub-expressions
+    std::map<Ptr,std::string> tmp;
+    for (size_t i = 0; i != order.size(); ++i)
+    {
+        if (count[order[i]] < 2) continue;
+        std::ostringstream var;
+        var << "_t" << tmp.size();
+        os << "        const real " << var.str() << " = ";
+        pool.print(os, order[i], tmp);
+        os << ";\n";
+        tmp[order[i]] = var.str();
+    }
+
+    for (size_t i = 0; i != expr.size(); ++i)
+    {
+        os << "        out[" << i << "] = ";
+        pool.print(os, expr[i], tmp);
+        os << ";\n";
+    }
+    os << "    }\n}\n\n";
+}
+
+} // namespace internal
+
+} // namespace gismo
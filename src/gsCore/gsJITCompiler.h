@@ -18,6 +18,9 @@
 
 #include <gsIO/gsXml.h>
 #include <gsIO/gsFileManager.h>
+#include <gsIO/gsFileData.h>
+
+#include <fstream>
 
 #if defined(_WIN32)
 #include <windows.h>
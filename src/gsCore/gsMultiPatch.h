@@ -21,6 +21,8 @@
 namespace gismo
 {
 
+template<class T> class gsPatchBVH;
+
 /** @brief Container class for a set of geometry patches and their
     topology, that is, the interface connections and outer boundary
     faces.
@@ -171,6 +173,7 @@ public:
     {
         BaseA::swap( other );
         m_patches.swap( other.m_patches );
+        m_bvh.swap( other.m_bvh );
     }
 
     /// \brief Prints the object as a string
@@ -291,6 +294,7 @@ public:
         {
             ( *it )->embed(N);
         }
+        invalidateBVH();
     }
 
     /// \brief Attempt to compute interfaces and boundaries
@@ -315,6 +319,7 @@ public:
         BaseA::clearAll();
         freeAll(m_patches);
         m_patches.clear();
+        invalidateBVH();
     }
 
     /// \brief Returns a bounding box for the multipatch domain. The
@@ -368,7 +373,24 @@ public:
     /// Computes linear approximation of the patches using \a nsamples per direction
     gsMultiPatch<T> approximateLinearly(index_t nsamples) const;
 
+    /// @brief Returns a bounding volume hierarchy of the elements of
+    /// all patches, used to accelerate point location and closest
+    /// point queries. It is built on first use and kept until
+    /// invalidateBVH() is called.
+    const gsPatchBVH<T> & bvh() const;
+
+    /// @brief Discards the hierarchy returned by bvh(), which is
+    /// rebuilt on its next use. The member functions of gsMultiPatch
+    /// which modify the patches call it; it must be called after the
+    /// patches were modified otherwise, eg. through patch(i).coefs().
+    /// \note Not to be called while other threads query the multipatch
+    void invalidateBVH() const { m_bvh.reset(); }
+
     /// @brief For each point in \a points, locates the parametric coordinates of the point
+    ///
+    /// The candidate patches and the initial guesses for the
+    /// inversion are taken from bvh(); the points are processed in
+    /// parallel.
     /// \param points
     /// \param pids vector containing for each point the patch id where it belongs (or -1 if not found)
     /// \param preim in each column,  the parametric coordinates of the corresponding point in the patch
@@ -443,6 +465,20 @@ private:
            gsVector<index_t> &dirMap, gsVector<bool>    &dirO,
            T tol, index_t reference=0);
 
+    // locates the points on all patches except \a skip
+    void locatePoints_impl(const gsMatrix<T> & points, const index_t skip,
+                           gsVector<index_t> & pids, gsMatrix<T> & preim,
+                           const T accuracy) const;
+
+    // directed Hausdorff distance from patch \a p to patch \a p of \a other
+    T directedHausdorffDistance(const index_t p, const gsMultiPatch<T> & other,
+                                const index_t nsamples, const T accuracy) const;
+
+private:
+
+    // Cached bounding volume hierarchy, see bvh()
+    mutable memory::shared_ptr<gsPatchBVH<T> > m_bvh;
+
 }; // class gsMultiPatch
 
 
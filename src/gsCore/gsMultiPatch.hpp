@@ -18,7 +18,10 @@
 #include <gsCore/gsDofMapper.h>
 #include <gsCore/gsAffineFunction.h>
 
+#include <gsCore/gsPatchBVH.h>
+
 #include <gsUtils/gsCombinatorics.h>
+#include <gsUtils/gsPointGrid.h>
 
 namespace gismo
 {
@@ -62,6 +65,7 @@ gsMultiPatch<T>& gsMultiPatch<T>::operator=( const gsMultiPatch& other )
     {
         freeAll(m_patches);
         BaseA::operator=(other);
+        m_bvh.reset();
         m_patches.resize(other.m_patches.size());
         // clone all geometries
         cloneAll( other.m_patches.begin(), other.m_patches.end(),
@@ -76,6 +80,7 @@ gsMultiPatch<T>& gsMultiPatch<T>::operator=( gsMultiPatch&& other )
     freeAll(m_patches);
     BaseA::operator=(give(other));
     m_patches = give(other.m_patches);
+    m_bvh.swap(other.m_bvh);
     return *this;
 }
 
@@ -201,6 +206,7 @@ void gsMultiPatch<T>::permute(const std::vector<short_t> & perm)
 {
     gsAsVector<gsGeometry<T>*> a (m_patches);
     a = gsEigen::PermutationMatrix<-1,-1,short_t>(gsAsConstVector<short_t>(perm)) * a;
+    invalidateBVH();
 }
 
 template<class T>
@@ -218,6 +224,7 @@ index_t gsMultiPatch<T>::addPatch(typename gsGeometry<T>::uPtr g)
     g->setId(index);
     m_patches.push_back( g.release() ) ;
     addBox();
+    invalidateBVH();
     return index;
 }
 
@@ -271,6 +278,7 @@ void gsMultiPatch<T>::uniformRefine(int numKnots, int mul)
     {
         ( *it )->uniformRefine(numKnots, mul);
     }
+    invalidateBVH();
 }
 
 
@@ -282,6 +290,7 @@ void gsMultiPatch<T>::degreeElevate(short_t const elevationSteps, short_t const
     {
         ( *it )->degreeElevate(elevationSteps, dir);
     }
+    invalidateBVH();
 }
 
 template<class T>
@@ -292,6 +301,7 @@ void gsMultiPatch<T>::degreeIncrease(short_t const elevationSteps, short_t const
     {
         ( *it )->degreeIncrease(elevationSteps, dir);
     }
+    invalidateBVH();
 }
 
 template<class T>
@@ -302,6 +312,7 @@ void gsMultiPatch<T>::degreeReduce(int elevationSteps)
     {
         ( *it )->degreeReduce(elevationSteps, -1);
     }
+    invalidateBVH();
 }
 
 template<class T>
@@ -312,6 +323,7 @@ void gsMultiPatch<T>::uniformCoarsen(int numKnots)
     {
         ( *it )->uniformCoarsen(numKnots);
     }
+    invalidateBVH();
 }
 
 template<class T>
@@ -357,71 +369,126 @@ gsMultiPatch<T> gsMultiPatch<T>::uniformSplit(index_t dir) const
 
 /*
   This is based on comparing a set of reference points of the patch
-  side and thus it implicitly assumes that the patch faces match
+  side and thus it implicitly assumes that the patch faces match.
+
+  Candidate pairs of sides are found by a spatial hash: space is
+  divided in cells of size tol and each side is assigned to the cell
+  containing the centroid of its corners. The centroids of two
+  matching sides are closer than tol, therefore only sides in
+  neighboring cells need to be compared.
 */
 template<class T>
 bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly, bool)
 {
+    GISMO_ASSERT( tol > 0, "The tolerance must be positive.");
     BaseA::clearTopology();
 
     const size_t   np    = m_patches.size();
     const index_t  nCorP = 1 << m_dim;     // corners per patch
     const index_t  nCorS = 1 << (m_dim-1); // corners per side
 
-    gsMatrix<T> supp,
-    // Parametric coordinates of the reference points. These points
-    // are used to decide if two sides match.
-    // Currently these are the corner points and the side-centers
-    coor;
-    if (cornersOnly)
-        coor.resize(m_dim,nCorP);
-    else
-        coor.resize(m_dim,nCorP + 2*m_dim);
-
-    gsVector<bool> boxPar(m_dim);
-
     // each matrix contains the physical coordinates of the reference points
     std::vector<gsMatrix<T> > pCorners(np);
 
-    std::vector<patchSide> pSide; // list of all candidate patchSides to compare
-    pSide.reserve(np * 2 * m_dim);
-
-//#   pragma omp parallel for private(supp, boxPar, !coor)
-    for (size_t p=0; p<np; ++p)
+#   pragma omp parallel
     {
-        supp = m_patches[p]->parameterRange(); // the parameter domain of patch i
-
-        // Corners' parametric coordinates
-        for (boxCorner c=boxCorner::getFirst(m_dim); c<boxCorner::getEnd(m_dim); ++c)
+        gsMatrix<T> supp,
+        // Parametric coordinates of the reference points. These points
+        // are used to decide if two sides match.
+        // Currently these are the corner points and the side-centers
+        coor;
+        if (cornersOnly)
+            coor.resize(m_dim,nCorP);
+        else
+            coor.resize(m_dim,nCorP + 2*m_dim);
+
+        gsVector<bool> boxPar(m_dim);
+
+#       pragma omp for schedule(dynamic, 64)
+        for (index_t p=0; p < static_cast<index_t>(np); ++p)
         {
-            boxPar   = c.parameters(m_dim);
-            for (index_t i=0; i<m_dim;++i)
-                coor(i,c-1) = boxPar(i) ? supp(i,1) : supp(i,0);
-        }
+            supp = m_patches[p]->parameterRange(); // the parameter domain of patch i
 
-        if (!cornersOnly)
-        {
-            // Sides' centers parametric coordinates
-            index_t l = nCorP;
-            for (boxSide c=boxSide::getFirst(m_dim); c<boxSide::getEnd(m_dim); ++c)
+            // Corners' parametric coordinates
+            for (boxCorner c=boxCorner::getFirst(m_dim); c<boxCorner::getEnd(m_dim); ++c)
             {
-                const index_t dir = c.direction();
-                const index_t s   = static_cast<index_t>(c.parameter());// 0 or 1
-
+                boxPar   = c.parameters(m_dim);
                 for (index_t i=0; i<m_dim;++i)
-                    coor(i,l) = ( dir==i ?  supp(i,s) :
-                                  (supp(i,1)+supp(i,0))/2.0 );
-                l++;
+                    coor(i,c-1) = boxPar(i) ? supp(i,1) : supp(i,0);
             }
-        }
 
-        // Evaluate the patch on the reference points
-        m_patches[p]->eval_into(coor,pCorners[p]);
+            if (!cornersOnly)
+            {
+                // Sides' centers parametric coordinates
+                index_t l = nCorP;
+                for (boxSide c=boxSide::getFirst(m_dim); c<boxSide::getEnd(m_dim); ++c)
+                {
+                    const index_t dir = c.direction();
+                    const index_t s   = static_cast<index_t>(c.parameter());// 0 or 1
 
-        // Add all the patchSides of this patch to the candidate list
+                    for (index_t i=0; i<m_dim;++i)
+                        coor(i,l) = ( dir==i ?  supp(i,s) :
+                                      (supp(i,1)+supp(i,0))/2.0 );
+                    l++;
+                }
+            }
+
+            // Evaluate the patch on the reference points
+            m_patches[p]->eval_into(coor,pCorners[p]);
+        }
+    }
+
+    std::vector<patchSide> pSide; // list of all candidate patchSides to compare
+    pSide.reserve(np * 2 * m_dim);
+    for (size_t p=0; p<np; ++p)
         for (boxSide bs=boxSide::getFirst(m_dim); bs<boxSide::getEnd(m_dim); ++bs)
             pSide.push_back(patchSide(p,bs));
+
+    // Hash cell of every side, sorted by cell
+    const index_t gDim = np ? pCorners.front().rows() : 0;
+    typedef std::pair<std::vector<long long>, size_t> cell_t;
+    std::vector<cell_t> cell(pSide.size());
+#   pragma omp parallel
+    {
+        std::vector<boxCorner> cId;
+        gsVector<T> mid;
+#       pragma omp for
+        for (index_t s=0; s < static_cast<index_t>(pSide.size()); ++s)
+        {
+            pSide[s].getContainedCorners(m_dim,cId);
+            mid.setZero(gDim);
+            for (size_t c=0; c!=cId.size(); ++c)
+                mid += pCorners[pSide[s].patch].col(cId[c]-1);
+            mid /= static_cast<T>(cId.size());
+            cell[s].first.resize(gDim);
+            for (index_t i=0; i!=gDim; ++i)
+                cell[s].first[i] = cast<T,long long>(math::floor(mid[i]/tol));
+            cell[s].second = s;
+        }
     }
+    std::sort(cell.begin(), cell.end());
+
+    // Candidate pairs (i,j), i<j, in the 3^gDim neighboring cells
+    index_t nNeighbors = 1;
+    for (index_t i=0; i!=gDim; ++i) nNeighbors *= 3;
+    std::vector<std::pair<size_t,size_t> > candidates;
+    cell_t key;
+    for (size_t s=0; s!=cell.size(); ++s)
+    {
+        for (index_t o=0; o!=nNeighbors; ++o)
+        {
+            key.first = cell[s].first;
+            for (index_t i=0, r=o; i!=gDim; ++i, r/=3)
+                key.first[i] += r%3 - 1;
+            key.second = 0;
+            for (typename std::vector<cell_t>::const_iterator it =
+                     std::lower_bound(cell.begin(), cell.end(), key);
+                 it!=cell.end() && it->first==key.first; ++it)
+                if (cell[s].second < it->second)
+                    candidates.push_back(std::make_pair(cell[s].second, it->second));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
 
     gsVector<index_t>      dirMap(m_dim);
     gsVector<bool>         matched(nCorS), dirOr(m_dim);
@@ -430,39 +497,37 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly, bool)
     cId2.reserve(nCorS);
 
     std::set<index_t> found;
-    for (size_t sideind=0; sideind<pSide.size(); ++sideind)
+    for (size_t c=0; c!=candidates.size(); ++c)
     {
+        const size_t sideind = candidates[c].first, other = candidates[c].second;
         const patchSide & side = pSide[sideind];
-        for (size_t other=sideind+1; other<pSide.size(); ++other)
-        {
-            side        .getContainedCorners(m_dim,cId1);
-            pSide[other].getContainedCorners(m_dim,cId2);
-            matched.setConstant(false);
-
-            // Check whether the side center matches
-            if (!cornersOnly)
-                if ( ( pCorners[side.patch        ].col(nCorP+side-1        ) -
-                       pCorners[pSide[other].patch].col(nCorP+pSide[other]-1)
-                         ).norm() >= tol )
-                    continue;
+        side        .getContainedCorners(m_dim,cId1);
+        pSide[other].getContainedCorners(m_dim,cId2);
+        matched.setConstant(false);
 
-            //t-junction
-            // check for matching vertices else
-            // invert the vertices of first side on the second and vise-versa
-            // if at least one vertex is found (at most 2^(d-1)), mark as interface
-
-            // Check whether the vertices match and compute direction
-            // map and orientation
-            if ( matchVerticesOnSide( pCorners[side.patch]        , cId1, 0,
-                                      pCorners[pSide[other].patch], cId2,
-                                      matched, dirMap, dirOr, tol ) )
-            {
-                dirMap(side.direction()) = pSide[other].direction();
-                dirOr (side.direction()) = !( side.parameter() == pSide[other].parameter() );
-                BaseA::addInterface( boundaryInterface(side, pSide[other], dirMap, dirOr));
-                found.insert(sideind);
-                found.insert(other);
-            }
+        // Check whether the side center matches
+        if (!cornersOnly)
+            if ( ( pCorners[side.patch        ].col(nCorP+side-1        ) -
+                   pCorners[pSide[other].patch].col(nCorP+pSide[other]-1)
+                     ).norm() >= tol )
+                continue;
+
+        //t-junction
+        // check for matching vertices else
+        // invert the vertices of first side on the second and vise-versa
+        // if at least one vertex is found (at most 2^(d-1)), mark as interface
+
+        // Check whether the vertices match and compute direction
+        // map and orientation
+        if ( matchVerticesOnSide( pCorners[side.patch]        , cId1, 0,
+                                  pCorners[pSide[other].patch], cId2,
+                                  matched, dirMap, dirOr, tol ) )
+        {
+            dirMap(side.direction()) = pSide[other].direction();
+            dirOr (side.direction()) = !( side.parameter() == pSide[other].parameter() );
+            BaseA::addInterface( boundaryInterface(side, pSide[other], dirMap, dirOr));
+            found.insert(sideind);
+            found.insert(other);
         }
     }
 
@@ -485,7 +550,8 @@ void gsMultiPatch<T>::fixOrientation()
           it != m_patches.end(); ++it )
         if ( -1 == (*it)->orientation() )
             (*it)->toggleOrientation();
-    
+    invalidateBVH();
+
     if (this->nInterfaces() || this->nBoundary() )
         this->computeTopology();
 }
@@ -625,6 +691,7 @@ void gsMultiPatch<T>::closeGaps(T tol)
         for (size_t k = 0; k!=dof.size(); ++k)
             m_patches[dof[k].first]->coef(dof[k].second) = meanVal;
     }
+    invalidateBVH();
 }
 
 
@@ -702,6 +769,7 @@ bool gsMultiPatch<T>::repairInterface( const boundaryInterface & bi )
             int pi( bi.second().patch );
             patch(pi).basis().refineElements_withCoefs( patch(pi).coefs(), refEltsSecond );
         }
+        invalidateBVH();
     }
 
     return changed;
@@ -710,32 +778,52 @@ bool gsMultiPatch<T>::repairInterface( const boundaryInterface & bi )
 
 
 template<class T>
-void gsMultiPatch<T>::locatePoints(const gsMatrix<T> & points,
-                                   gsVector<index_t> & pids,
-                                   gsMatrix<T> & preim, const T accuracy) const
+const gsPatchBVH<T> & gsMultiPatch<T>::bvh() const
 {
-    pids.resize(points.cols());
-    pids.setConstant(-1); // -1 implies not in the domain
-    preim.resize(parDim(), points.cols());//uninitialized by default
-    gsMatrix<T> pt, pr, tmp;
-
-    for (index_t i = 0; i!=pids.size(); ++i)
+#   pragma omp critical (gsMultiPatch_bvh)
     {
-        pt = points.col(i);
+        if ( !m_bvh )
+            m_bvh.reset( new gsPatchBVH<T>(*this) );
+    }
+    return *m_bvh;
+}
 
-        for (size_t k = 0; k!= m_patches.size(); ++k)
-        {
-            pr = m_patches[k]->parameterRange();
-            m_patches[k]->invertPoints(pt, tmp, accuracy);
-            if ( (tmp.array() >= pr.col(0).array()).all()
-                 && (tmp.array() <= pr.col(1).array()).all() )
-            {
-                pids[i] = k;
-                preim.col(i) = tmp;
-                break;
-            }
-        }
+namespace
+{
+// Newton iteration for the parameters u of the point pt on the
+// geometry g, projected onto the parameter domain supp. Returns true
+// if the residual drops below the accuracy, false if the iteration
+// stagnates (eg. the point is not on the patch).
+template<class T>
+bool __invertPoint(const gsGeometry<T> & g, const gsMatrix<T> & supp,
+                   const gsVector<T> & pt, gsVector<T> & u, const T accuracy)
+{
+    gsMatrix<T> val, jac;
+    T rnorm = std::numeric_limits<T>::max();
+    for (index_t it = 0, stalled = 0; it != 50 && stalled != 3; ++it)
+    {
+        g.eval_into(u, val);
+        val = pt - val;
+        const T r = val.norm();
+        if ( r <= accuracy ) return true;
+        stalled = ( r < 0.99 * rnorm ) ? 0 : stalled + 1;
+        rnorm = math::min(r, rnorm);
+
+        // least squares step if the geometry is a curve or a surface
+        g.jacobian_into(u, jac);
+        u += jac.colPivHouseholderQr().solve(val);
+        u = u.cwiseMax( supp.col(0) ).cwiseMin( supp.col(1) );
     }
+    return false;
+}
+}
+
+template<class T>
+void gsMultiPatch<T>::locatePoints(const gsMatrix<T> & points,
+                                   gsVector<index_t> & pids,
+                                   gsMatrix<T> & preim, const T accuracy) const
+{
+    locatePoints_impl(points, -1, pids, preim, accuracy);
 }
 
 template<class T>
@@ -743,43 +831,65 @@ void gsMultiPatch<T>::locatePoints(const gsMatrix<T> & points, index_t pid1,
                                    gsVector<index_t> & pid2, gsMatrix<T> & preim) const
 {
     // Assumes points are found on pid1 and possibly on one more patch
-    pid2.resize(points.cols());
-    pid2.setConstant(-1); // -1 implies not in the domain
+    locatePoints_impl(points, pid1, pid2, preim, 1e-6);
+}
+
+template<class T>
+void gsMultiPatch<T>::locatePoints_impl(const gsMatrix<T> & points, const index_t skip,
+                                        gsVector<index_t> & pids,
+                                        gsMatrix<T> & preim, const T accuracy) const
+{
+    pids.resize(points.cols());
+    pids.setConstant(-1); // -1 implies not in the domain
     preim.resize(parDim(), points.cols());//uninitialized by default
-    gsMatrix<T> pt, pr, tmp;
+    const gsPatchBVH<T> & tree = bvh();
 
-    for (index_t i = 0; i!=pid2.size(); ++i)
+#   pragma omp parallel
     {
-        pt = points.col(i);
+        std::vector<index_t> cand, tried;
+        std::vector<std::pair<T,index_t> > order;
+        gsVector<T> pt, u;
 
-        for (size_t k = 0; k!= m_patches.size(); ++k)
+#       pragma omp for schedule(dynamic, 64)
+        for (index_t i = 0; i < points.cols(); ++i)
         {
-            if (pid1==(index_t)k) continue; // skip pid1
-
-            pr = m_patches[k]->parameterRange();
-            m_patches[k]->invertPoints(pt, tmp);
-            if ( (tmp.array() >= pr.col(0).array()).all()
-                 && (tmp.array() <= pr.col(1).array()).all() )
+            pt = points.col(i);
+
+            // Elements whose box contains the point, by patch index
+            // (as before, a point on an interface goes to the patch with
+            // the lowest index) and then closest box center first
+            tree.containing(pt, accuracy, cand);
+            order.clear();
+            for (size_t c = 0; c != cand.size(); ++c)
+                order.push_back( std::make_pair(
+                    (tree.boxCenter(cand[c])-pt).squaredNorm(), cand[c]) );
+            std::sort(order.begin(), order.end());
+            std::stable_sort(order.begin(), order.end(),
+                             [&tree](const std::pair<T,index_t> & a,
+                                     const std::pair<T,index_t> & b)
+                             { return tree.patch(a.second) < tree.patch(b.second); });
+
+            // One inversion per patch, starting from the center of the
+            // closest element
+            tried.clear();
+            for (size_t c = 0; c != order.size(); ++c)
             {
-                pid2[i] = k;
-                preim.col(i) = tmp;
-                break;
+                const index_t e = order[c].second, k = tree.patch(e);
+                if ( k == skip || std::count(tried.begin(), tried.end(), k) ) continue;
+                tried.push_back(k);
+
+                u = tree.centerPoint(e);
+                if ( __invertPoint(*m_patches[k], m_patches[k]->support(), pt, u, accuracy) )
+                {
+                    pids[i] = k;
+                    preim.col(i) = u;
+                    break;
+                }
             }
         }
     }
 }
 
-namespace
-{
-struct __closestPointHelper
-{
-    __closestPointHelper() : dist(math::limits::max()), pid(-1) { }
-    real_t dist;
-    index_t pid;
-    gsVector<> preim;
-};
-}
-
 template<class T> std::pair<index_t,gsVector<T> >
 gsMultiPatch<T>::closestPointTo(const gsVector<T> & pt,
                                 const T accuracy) const
@@ -798,31 +908,83 @@ T gsMultiPatch<T>::closestDistance(const gsVector<T> & pt,
     GISMO_ASSERT( pt.rows() == targetDim(), "Invalid input point." <<
                   pt.rows() <<"!="<< targetDim() );
 
-    gsVector<T> tmp;
+    // Branch and bound over the elements, nearest bounding box first.
+    // Note: gsGeometry::closestPointTo returns sqrt(|x-pt|^2/2)
+    const gsPatchBVH<T> & tree = bvh();
+    const T sqrt2 = math::sqrt((T)(2));
+    T dist = std::numeric_limits<T>::max();
+    index_t pid = -1;
+    gsVector<T> tmp, preim;
+    std::vector<std::pair<index_t,gsVector<T> > > found;
 
-#ifndef _MSC_VER
-#   pragma omp declare reduction(minimum : struct __closestPointHelper : omp_out = (omp_in.dist < omp_out.dist ? omp_in : omp_out) )
-    struct __closestPointHelper cph;
-#   pragma omp parallel for default(shared) private(tmp) reduction(minimum:cph) //OpenMP 4.0, will not work on VS2019
-#else
-    struct __closestPointHelper cph;
-#endif
-    for (size_t k = 0; k < m_patches.size(); ++k)
+    auto visit = [&](index_t e, T) -> T
     {
-        // possible improvement: approximate dist: eval patch on a
-        // grid. find min distance between grid and pt
+        const index_t k = tree.patch(e);
+        // skip elements containing a minimizer found already
+        for (size_t i = 0; i != found.size(); ++i)
+            if ( found[i].first == k &&
+                 (found[i].second.array() >= tree.lowerCorner(e).array()).all() &&
+                 (found[i].second.array() <= tree.upperCorner(e).array()).all() )
+                return sqrt2 * dist;
+
+        tmp = tree.centerPoint(e);
+        const T val = m_patches[k]->closestPointTo(pt, tmp, accuracy, true);
+        found.push_back( std::make_pair(k, tmp) );
+        if (val < dist)
+        {
+            dist  = val;
+            pid   = k;
+            preim = tmp;
+        }
+        return sqrt2 * dist;
+    };
+    tree.nearest(pt, visit);
 
-        const T val = this->patch(k).closestPointTo(pt, tmp, accuracy);
-        if (cph.dist>val)
+    //gsInfo <<"--Pid="<<pid<<", Dist("<<pt.transpose()<<"): "<< dist <<"\n";
+    result = std::make_pair(pid, give(preim));
+    return dist;
+}
+
+template<class T>
+T gsMultiPatch<T>::directedHausdorffDistance(const index_t p,
+                                             const gsMultiPatch<T> & other,
+                                             const index_t nsamples,
+                                             const T accuracy) const
+{
+    // Sample points on patch p
+    gsMatrix<T> uv = gsPointGrid<T>(m_patches[p]->support(),nsamples);
+    gsMatrix<T> pts;
+    m_patches[p]->eval_into(uv,pts);
+
+    const gsGeometry<T> & target = other.patch(p);
+    const gsPatchBVH<T> & tree = other.bvh();
+    T maxDist = 0;
+
+#   pragma omp parallel
+    {
+        gsVector<T> pt, tmp;
+        T thMax = 0;
+        index_t guess = -1;
+        auto visit = [&](index_t e, T) -> T
+        {
+            if ( p != tree.patch(e) ) return std::numeric_limits<T>::max();
+            guess = e; // the element of the target patch with the closest box
+            return 0;
+        };
+
+#       pragma omp for
+        for (index_t k = 0; k < pts.cols(); ++k)
         {
-            cph.dist = val; //need to be all in one struct for OMP
-            cph.pid = k;
-            cph.preim = tmp;
+            pt = pts.col(k);
+            tree.nearest(pt, visit);
+            tmp = tree.centerPoint(guess);
+            thMax = math::max(thMax, target.closestPointTo(pt,tmp,accuracy,true));
         }
+
+#       pragma omp critical (gsMultiPatch_Hausdorff)
+        maxDist = math::max(maxDist, thMax);
     }
-    //gsInfo <<"--Pid="<<cph.pid<<", Dist("<<pt.transpose()<<"): "<< cph.dist <<"\n";
-    result = std::make_pair(cph.pid, give(cph.preim));
-    return cph.dist;
+    return math::sqrt(2*maxDist); // as in gsGeometry::directedHausdorffDistance
 }
 
 template<class T>
@@ -833,22 +995,13 @@ std::vector<T> gsMultiPatch<T>::HausdorffDistance(  const gsMultiPatch<T> & othe
 {
     GISMO_ASSERT(this->nPatches()==other.nPatches(),"Number of patches should be the same, but this->nPatches()!=other.nPatches() -> "<<this->nPatches()<<"!="<<other.nPatches());
     std::vector<T> result(this->nPatches());
-#pragma omp parallel
-{
-#   ifdef _OPENMP
-    const int tid = omp_get_thread_num();
-    const int nt  = omp_get_num_threads();
-#   endif
-
-#   ifdef _OPENMP
-    for ( size_t p=tid; p<this->nPatches(); p+=nt )
-#   else
     for ( size_t p=0; p<this->nPatches(); p++ )
-#   endif
     {
-        result.at(p) = this->patch(p).HausdorffDistance(other.patch(p),nsamples,accuracy,directed);
+        result.at(p) = this->directedHausdorffDistance(p,other,nsamples,accuracy);
+        if (!directed)
+            result.at(p) = math::max(result.at(p),
+                                     other.directedHausdorffDistance(p,*this,nsamples,accuracy));
     }
-}//omp parallel
     return result;
 }
 
@@ -0,0 +1,249 @@
+/** @file gsPatchBVH.h
+
+    @brief Bounding volume hierarchy over the elements of a
+    multipatch geometry.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+*/
+
+#pragma once
+
+#include <gsCore/gsMultiPatch.h>
+#include <gsCore/gsDomainIterator.h>
+
+#include <queue>
+
+namespace gismo
+{
+
+/**
+    @brief Bounding volume hierarchy (BVH) of axis-aligned boxes
+    enclosing the elements of the patches of a gsMultiPatch.
+
+    The box of an element is the bounding box of the control points
+    which are active on the element. By the convex hull property of
+    B-splines, NURBS (with positive weights) and THB-splines the
+    image of the element lies inside this box.
+
+    The leaves of the hierarchy are the elements; each element stores
+    its patch index and its parameter box, which provides a good
+    initial guess for point inversion or closest point computations.
+
+    \ingroup Core
+*/
+template<class T>
+class gsPatchBVH
+{
+public:
+    /// Shared pointer for gsPatchBVH
+    typedef memory::shared_ptr< gsPatchBVH > Ptr;
+
+public:
+
+    /// Empty hierarchy
+    gsPatchBVH() { }
+
+    /// Builds the hierarchy for the patches of \a mp
+    explicit gsPatchBVH(const gsMultiPatch<T> & mp) { compute(mp); }
+
+    /// Builds the hierarchy for the patches of \a mp
+    void compute(const gsMultiPatch<T> & mp)
+    {
+        m_patch.clear();
+        m_nodes.clear();
+        if ( mp.empty() ) return;
+
+        // Element boxes, physical and parametric
+        const index_t gd = mp.geoDim(), pd = mp.parDim();
+        std::vector<index_t> offset(1,0);
+        for (size_t p = 0; p != mp.nPatches(); ++p)
+            offset.push_back(offset.back() + mp.patch(p).basis().numElements());
+        const index_t ne = offset.back();
+        m_patch.resize(ne);
+        m_lo.resize(gd, ne); m_hi.resize(gd, ne);
+        m_plo.resize(pd, ne); m_phi.resize(pd, ne);
+
+#       pragma omp parallel
+        {
+            gsMatrix<index_t> act;
+#           pragma omp for schedule(dynamic,1)
+            for (index_t p = 0; p < static_cast<index_t>(mp.nPatches()); ++p)
+            {
+                const gsGeometry<T> & g = mp.patch(p);
+                typename gsBasis<T>::domainIter domIt = g.basis().makeDomainIterator();
+                for (index_t e = offset[p]; domIt->good(); domIt->next(), ++e)
+                {
+                    m_patch[e] = p;
+                    m_plo.col(e) = domIt->lowerCorner();
+                    m_phi.col(e) = domIt->upperCorner();
+                    g.basis().active_into(domIt->centerPoint(), act);
+                    m_lo.col(e) = g.coef(act(0,0)).transpose();
+                    m_hi.col(e) = m_lo.col(e);
+                    for (index_t i = 1; i < act.rows(); ++i)
+                    {
+                        m_lo.col(e) = m_lo.col(e).cwiseMin( g.coef(act(i,0)).transpose() );
+                        m_hi.col(e) = m_hi.col(e).cwiseMax( g.coef(act(i,0)).transpose() );
+                    }
+                }
+            }
+        }
+
+        // Hierarchy
+        m_order.resize(ne);
+        for (index_t e = 0; e != ne; ++e) m_order[e] = e;
+        m_nlo.resize(gd, 2*ne); m_nhi.resize(gd, 2*ne);
+        build(0, ne);
+        m_nlo.conservativeResize(gd, m_nodes.size());
+        m_nhi.conservativeResize(gd, m_nodes.size());
+    }
+
+    /// Number of elements (leaves)
+    index_t numElements() const { return static_cast<index_t>(m_patch.size()); }
+
+    /// Patch of element \a e
+    index_t patch(index_t e) const { return m_patch[e]; }
+
+    /// Lower corner of the parameter box of element \a e
+    gsVector<T> lowerCorner(index_t e) const { return m_plo.col(e); }
+
+    /// Upper corner of the parameter box of element \a e
+    gsVector<T> upperCorner(index_t e) const { return m_phi.col(e); }
+
+    /// Center of the parameter box of element \a e
+    gsVector<T> centerPoint(index_t e) const { return (m_plo.col(e)+m_phi.col(e))/2; }
+
+    /// Center of the bounding box of element \a e
+    gsVector<T> boxCenter(index_t e) const { return (m_lo.col(e)+m_hi.col(e))/2; }
+
+    /// Euclidean distance from \a pt to the bounding box of element \a e
+    T distance(const gsVector<T> & pt, index_t e) const
+    { return boxDistance(pt, m_lo.col(e), m_hi.col(e)); }
+
+    /// Collects the elements whose bounding box, enlarged by \a tol,
+    /// contains the point \a pt
+    void containing(const gsVector<T> & pt, const T tol,
+                    std::vector<index_t> & result) const
+    {
+        result.clear();
+        if ( m_nodes.empty() ) return;
+        std::vector<index_t> stack(1,0);
+        while (!stack.empty())
+        {
+            const Node & nd = m_nodes[stack.back()];
+            const index_t n = stack.back();
+            stack.pop_back();
+            if ( boxDistance(pt, m_nlo.col(n), m_nhi.col(n)) > tol ) continue;
+            if ( -1 == nd.left )
+            {
+                for (index_t i = nd.begin; i != nd.end; ++i)
+                    if ( distance(pt, m_order[i]) <= tol )
+                        result.push_back(m_order[i]);
+            }
+            else
+            {
+                stack.push_back(nd.left);
+                stack.push_back(nd.right);
+            }
+        }
+    }
+
+    /// Visits the elements by increasing distance of their bounding
+    /// box to the point \a pt. The visitor is called as
+    /// <tt>bound = visit(e, dist)</tt> and returns an upper bound for
+    /// the distance sought; elements farther than the bound are not
+    /// visited.
+    template<class Visitor>
+    void nearest(const gsVector<T> & pt, Visitor & visit) const
+    {
+        if ( m_nodes.empty() ) return;
+        typedef std::pair<T,index_t> entry; // (distance, node or -1-element)
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry> > queue;
+        queue.push( entry(boxDistance(pt, m_nlo.col(0), m_nhi.col(0)), 0) );
+        T bound = std::numeric_limits<T>::max();
+        while ( !queue.empty() && queue.top().first < bound )
+        {
+            const entry top = queue.top();
+            queue.pop();
+            if ( top.second < 0 ) // element
+            {
+                bound = math::min(bound, visit(-1-top.second, top.first));
+                continue;
+            }
+            const Node & nd = m_nodes[top.second];
+            if ( -1 == nd.left )
+            {
+                for (index_t i = nd.begin; i != nd.end; ++i)
+                    queue.push( entry(distance(pt, m_order[i]), -1-m_order[i]) );
+            }
+            else
+            {
+                queue.push( entry(boxDistance(pt, m_nlo.col(nd.left ), m_nhi.col(nd.left )), nd.left ) );
+                queue.push( entry(boxDistance(pt, m_nlo.col(nd.right), m_nhi.col(nd.right)), nd.right) );
+            }
+        }
+    }
+
+private:
+
+    struct Node
+    {
+        index_t left, right; // children, -1 for a leaf
+        index_t begin, end;  // range of elements in m_order
+    };
+
+    enum { leafSize = 4 };
+
+    // Builds the node for the elements m_order[begin..end), returns its index
+    index_t build(const index_t begin, const index_t end)
+    {
+        const index_t n = static_cast<index_t>(m_nodes.size());
+        Node nd = { -1, -1, begin, end };
+        m_nodes.push_back(nd);
+
+        m_nlo.col(n) = m_lo.col(m_order[begin]);
+        m_nhi.col(n) = m_hi.col(m_order[begin]);
+        for (index_t i = begin+1; i != end; ++i)
+        {
+            m_nlo.col(n) = m_nlo.col(n).cwiseMin( m_lo.col(m_order[i]) );
+            m_nhi.col(n) = m_nhi.col(n).cwiseMax( m_hi.col(m_order[i]) );
+        }
+        if ( end - begin <= leafSize ) return n;
+
+        // Split at the median along the longest side
+        index_t dir;
+        (m_nhi.col(n)-m_nlo.col(n)).maxCoeff(&dir);
+        const index_t mid = (begin+end)/2;
+        std::nth_element(m_order.begin()+begin, m_order.begin()+mid, m_order.begin()+end,
+                         [this,dir](index_t a, index_t b)
+                         { return m_lo(dir,a)+m_hi(dir,a) < m_lo(dir,b)+m_hi(dir,b); });
+        const index_t left  = build(begin, mid);
+        const index_t right = build(mid, end);
+        m_nodes[n].left  = left;
+        m_nodes[n].right = right;
+        return n;
+    }
+
+    template<class Vec>
+    static T boxDistance(const gsVector<T> & pt, const Vec & lo, const Vec & hi)
+    {
+        return ( (lo-pt).cwiseMax(pt-hi).cwiseMax(0) ).norm();
+    }
+
+private:
+    // Elements: patch, bounding box, parameter box
+    std::vector<index_t> m_patch;
+    gsMatrix<T> m_lo, m_hi, m_plo, m_phi;
+
+    // Nodes of the hierarchy and their bounding boxes
+    std::vector<Node>    m_nodes;
+    std::vector<index_t> m_order;
+    gsMatrix<T> m_nlo, m_nhi;
+};
+
+} // namespace gismo
@@ -1007,7 +1007,7 @@ public:
         gsMatrix<index_t> box(1,2*d);
         box.leftCols(d)  = obj.lowerIndex().transpose();
         box.rightCols(d) = obj.upperIndex().transpose();
-        gsXmlNode * mat = putMatrixToXml( box, data, "box" );
+        gsXmlNode * mat = makeNode("box", box, data); // always as text
         mat->append_attribute(makeAttribute("level", obj.level(), data));
         if (obj.patch()!=-1)
             mat->append_attribute(makeAttribute("patch", obj.patch(), data));
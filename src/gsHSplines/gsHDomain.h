@@ -89,14 +89,9 @@ public:
 
 private:
 
-    struct numLeaves_visitor;
-    struct numNodes_visitor;
-    struct levelUp_visitor;
-
-private:
-
-    /// Pointer to the root node of the tree
-    node * m_root;
+    /// The nodes of the tree, the root is the first entry. After
+    /// makeCompressed() they are stored in breadth-first order.
+    typename node::Container m_nodes;
 
     /// Keeps the highest upper indices (at level gsHDomain::m_indexLevel)
     point m_upperIndex;
@@ -116,14 +111,12 @@ public:
 
     gsHDomain() : m_indexLevel(0)
     {
-        m_root = nullptr;
         m_maxInsLevel = 0;
         m_maxPath = 0;
     }
     
     gsHDomain(point const & upp)
     {
-        m_root = nullptr;
         m_maxInsLevel = 0;
         m_maxPath = 0;
         init(upp);
@@ -131,13 +124,12 @@ public:
 
     /// Copy constructor (makes a deep copy)
     gsHDomain( const gsHDomain & o) :
+        m_nodes(o.m_nodes),
         m_upperIndex(o.m_upperIndex),
         m_indexLevel(o.m_indexLevel),
         m_maxInsLevel(o.m_maxInsLevel),
         m_maxPath(o.m_maxPath)
-    {
-        m_root = new node(*o.m_root);
-    }
+    { }
 
     /// Assignment operator (makes a deep copy)
     gsHDomain& operator=( const gsHDomain & o)
@@ -145,8 +137,7 @@ public:
         if ( this == &o )
             return *this;
         
-        m_root = new node(*o.m_root);
-
+        m_nodes       = o.m_nodes;
         m_upperIndex  = o.m_upperIndex;
         m_indexLevel  = o.m_indexLevel;
         m_maxInsLevel = o.m_maxInsLevel;
@@ -157,18 +148,16 @@ public:
 
 #if EIGEN_HAS_RVALUE_REFERENCES
     gsHDomain(gsHDomain&& o) :
-    m_root(o.m_root),
+    m_nodes(std::move(o.m_nodes)),
     m_upperIndex(std::move(o.m_upperIndex)),
     m_indexLevel(o.m_indexLevel),
     m_maxInsLevel(o.m_maxInsLevel),
     m_maxPath(o.m_maxPath)
-    {
-        o.m_root = nullptr;
-    }
+    { }
 
     gsHDomain & operator=(gsHDomain&& o)
     {
-        delete m_root; m_root = o.m_root; o.m_root = nullptr;
+        m_nodes       = std::move(o.m_nodes);
         m_upperIndex  = std::move(o.m_upperIndex);
         m_indexLevel  = o.m_indexLevel;
         m_maxInsLevel = o.m_maxInsLevel;
@@ -183,13 +172,11 @@ public:
         m_indexLevel = index_level;
         m_maxInsLevel = 0;
 
-        if ( m_root )
-            delete m_root;
-
         for (short_t i=0; i<d; ++i)
             m_upperIndex[i] = (upp[i]<< m_indexLevel);
 
-        m_root = new node(m_upperIndex);
+        m_nodes.clear();
+        m_nodes.push_back( node(m_upperIndex) );
         m_maxPath = 1;
     }
 
@@ -221,9 +208,6 @@ public:
         init(upp, std::min( *std::min_element(logUpps.begin(), logUpps.end()), oldMax) );
     }
 
-    /// Destructor deletes the whole tree
-    ~gsHDomain() { delete m_root; }
-
     /// Clones the object
     gsHDomain * clone() const;
 
@@ -267,7 +251,7 @@ public:
 
     \param lower the lower left corner of the box
     \param upper the upper right corner of the box
-    \param *_node the current node
+    \param _node index of the current node
     \param lvl the desired level
 
     \remarks This function should only be called by the other query1().
@@ -276,7 +260,7 @@ public:
     that cannot be reached from \em _node.
     */
     void insertBox (point const & lower, point const & upper,
-                    node * _node, int lvl);
+                    index_t _node, int lvl);
 
     /** \brief The insert function which insert box
     defined by points \em lower and \em upper to level \em lvl.
@@ -288,7 +272,7 @@ public:
     \param lvl the desired level
     */
     void insertBox (point const & lower, point const & upper, int lvl)
-    { insertBox(lower, upper, m_root, lvl); }
+    { insertBox(lower, upper, 0, lvl); }
 
     /**
      * @brief      The clear function which clears box
@@ -334,7 +318,7 @@ public:
      \param lower the lower left corner of the box
      \param upper the upper right corner of the box
      \param level the level to be checked against
-     \param _node node of the k-d-tree where the search starts.
+     \param _node index of the node of the k-d-tree where the search starts.
 
      \remarks This function should only be called by the other query1().
     It will return an incorrect result, if the box corresponds to
@@ -342,7 +326,7 @@ public:
     that cannot be reached from \em _node.
     */
     bool query1 (point const & lower, point const & upper,
-                 int level, node * _node ) const;
+                 int level, index_t _node ) const;
 
     /** \brief Returns true if the box defined by \em lower and \em upper
     * is completely contained in \em level and
@@ -393,7 +377,7 @@ public:
     \param lower lower left corner of the cube [k1,k2]
     \param upper upper right corner of the cube [k1,k2]
     \param level current level
-    \param _node node of the k-d-tree where the search starts.
+    \param _node index of the node of the k-d-tree where the search starts.
 
      \remarks This function should only be called by the other query2().
     It will return an incorrect result, if the box corresponds to
@@ -401,7 +385,7 @@ public:
     that cannot be reached from \em _node.
     */
     bool query2 (point const & lower, point const & upper,
-                 int level, node *_node ) const;
+                 int level, index_t _node ) const;
 
     /** \brief Returns true if the box defined by \em lower and \em upper
      * is completely contained in a Om-domain with a level different to \em level.
@@ -425,7 +409,7 @@ public:
      * at the end.
      */
     int query3(point const & k1, point const & k2, 
-               int level, node *_node ) const;
+               int level, index_t _node ) const;
 
     /** \brief Returns the lowest level \f$\ell\f$ s.t.
      * \f$\omega \subseteq \Omega^\ell \land \omega
@@ -445,7 +429,7 @@ public:
     /// query4 returns the highest level with which box [k1, k2]
     /// overlaps
     int query4(point const & lower, point const & upper,
-               int level, node  *_node) const;
+               int level, index_t _node) const;
 
     /** \brief Returns the highest level with which
      * the box defined by \em lower and \em upper
@@ -465,7 +449,7 @@ public:
 
     /// Returns the level of the point \a p
     int levelOf(point const & p, int level) const
-    { return pointSearch(p,level,m_root)->level;}
+    { return m_nodes[pointSearch(p,level,0)].level;}
 
     /// Increment the level index globally
     void incrementLevel();
@@ -481,18 +465,18 @@ public:
 
     literator beginLeafIterator()
     {
-        return literator(m_root, m_indexLevel);
+        return literator(m_nodes.empty() ? NULL : m_nodes.data(), m_indexLevel);
     }
 
     const_literator beginLeafIterator() const
     {
-        return const_literator(m_root, m_indexLevel);
+        return const_literator(m_nodes.empty() ? NULL : m_nodes.data(), m_indexLevel);
     }
 
     void makeCompressed();
     
     /// Returns the number of nodes in the tree
-    int size() const;
+    int size() const { return m_nodes.size(); }
 
     /// Returns the number of distinct knots in direction \a k of level \a lvl
     int numBreaks(int lvl, int k) const
@@ -611,12 +595,20 @@ private:
                           box & leftBox,
                           box & rightBox );
 
-    /// Sets the level of all descendents of the node <em>_node</em> to level
-    /// lvl if the level of the node is smaller then \em lvl.
-    /// Otherwise the level of node is not changed
-    /// \param *_node the node whose descendents are to be set their levels
-    /// \param lvl the new level for the descendents
-    static void setLevel(node *_node, int lvl);
+    /// Splits the leaf \a i at \a splitPos along \a splitAxis,
+    /// i.e. two children are added at the end of the node array
+    void split(index_t i, int splitAxis, Z splitPos);
+
+    /// Splits the leaf \a i adaptively according to \a insBox.
+    /// Splitting is done on a coordinate of the level of the leaf
+    /// (aligned). Returns the child that intersects \a insBox or -1
+    /// if non-degenerate split is impossible (then this is a no-op).
+    index_t adaptiveAlignedSplit(index_t i, box const & insBox);
+
+    /// Merges the terminal node \a i (i.e., its two children are
+    /// joined). The children stay in the node array until the next
+    /// compaction, see makeCompressed().
+    void merge(index_t i);
 
     /// Returns true if the box is degenerate (has zero volume)
     static bool isDegenerate(box const & someBox);
@@ -674,7 +666,7 @@ private:
     template<typename visitor>
     typename visitor::return_type
     boxSearch(point const & k1, point const & k2, 
-              int level, node  *_node) const;
+              int level, index_t _node) const;
 
     /// Iterates on the leafs of the tree and applies \ visitor.  The
     /// visitor controls the operation to be performed
@@ -682,111 +674,45 @@ private:
     typename visitor::return_type
     leafSearch() const;
 
-    /// Iterates on all the nodes of the tree and applies \ visitor.
-    /// The visitor controls the operation to be performed
-    template<typename visitor>
-    typename visitor::return_type
-    nodeSearch() const;
-
-    /// Returns the leaf node of the subtree starting at \a _node that
-    /// contains the input point \a p. The cells in the tree are
-    /// considered half-open, i.e. in 2D they are of the form
+    /// Returns the index of the leaf node of the subtree starting at
+    /// \a _node that contains the input point \a p. The cells in the
+    /// tree are considered half-open, i.e. in 2D they are of the form
     /// [a_1,b_1) x [a_2,b_2)
-    node * pointSearch(const point & p, int level, node  *_node) const;
+    index_t pointSearch(const point & p, int level, index_t _node) const;
 
-    /// Decreases the level by 1 for all leaves
+    /// Computes the maximum level of the leaves
     struct maxLevel_visitor
     {
         typedef int return_type;
         static return_type init() {return 0;}
         
-        static void visitLeaf(gsKdNode<d, Z> * leafNode, return_type &i)
-        {
-            if (leafNode->level>i) i=leafNode->level;
-        }
-    };
-    
-    /// Increases the level by 1 for all leaves
-    struct levelUp_visitor
-    {
-        typedef int return_type;
-        static return_type init() {return 0;}
-        
-        static void visitLeaf(gsKdNode<d, Z> * leafNode, return_type &)
-        {
-            leafNode->level++;
-        }
-    };
-
-    /// Decreases the level by 1 for all leaves
-    struct levelDown_visitor
-    {
-        typedef int return_type;
-        static return_type init() {return 0;}
-        
-        static void visitLeaf(gsKdNode<d, Z> * leafNode, return_type &)
+        static void visitLeaf(const gsKdNode<d, Z> & leafNode, return_type &i)
         {
-            leafNode->level--;
+            if (leafNode.level>i) i=leafNode.level;
         }
     };
 
-    /// Counts number of nodes in the tree
+    /// Counts number of leaves in the tree
     struct numLeaves_visitor
     {
         typedef int return_type;
         static return_type init() {return 0;}
         
-        static void visitLeaf(gsKdNode<d, Z> * , return_type & i)
-        {
-            i++;
-        }
-    };
-
-    /// Counts number of nodes in the tree
-    struct numNodes_visitor
-    {
-        typedef int return_type;
-        static return_type init() {return 0;}
-        
-        static void visitNode(gsKdNode<d, Z> * , return_type & i)
+        static void visitLeaf(const gsKdNode<d, Z> & , return_type & i)
         {
             i++;
         }
     };
 
-    /// Multiplies everything by 2
-    struct liftCoordsOneLevel_visitor
-    {
-        typedef int return_type;
-        static return_type init() {return 0;}
-        
-        static void visitNode(gsKdNode<d, Z> * leafNode, return_type &)
-        {
-            leafNode->multiplyByTwo();
-        }
-    };
-
-    /// Multiplies everything by 2
-    struct reduceCoordsOneLevel_visitor
-    {
-        typedef int return_type;
-        static return_type init() {return 0;}
-
-        static void visitNode(gsKdNode<d, Z> * leafNode, return_type &)
-        {
-            leafNode->divideByTwo();
-        }
-    };
-
-    /// Counts number of nodes in the tree
+    /// Prints the leaves of the tree
     struct printLeaves_visitor
     {
         typedef int return_type;
         static return_type init() {return 0;}
         
-        static void visitLeaf(gsKdNode<d, Z> * leafNode, return_type &)
+        static void visitLeaf(const gsKdNode<d, Z> & leafNode, return_type &)
         {
-            gsInfo << *leafNode;
+            gsInfo << leafNode;
         }
     };
 
@@ -803,12 +729,12 @@ private:
             //return return_type();//!does not properly initialize the points
         }
 
-        static void visitLeaf(gismo::gsKdNode<d, Z> * leafNode , int level, return_type & res)
+        static void visitLeaf(const gsKdNode<d, Z> & leafNode , int level, return_type & res)
         {
-            if ( leafNode->level == level )
+            if ( leafNode.level == level )
             {
-                res.first  = leafNode->lowCorner();
-                res.second = leafNode->uppCorner();
+                res.first  = leafNode.lowCorner();
+                res.second = leafNode.uppCorner();
             }
         }
     };
@@ -30,9 +30,9 @@ namespace
         static return_type init() {return true;}
 
         template<short_t d, class Z>
-        static void visitLeaf(gismo::gsKdNode<d, Z> * leafNode , int level, return_type & res)
+        static void visitLeaf(const gismo::gsKdNode<d, Z> & leafNode , int level, return_type & res)
         {
-            if ( leafNode->level != level )
+            if ( leafNode.level != level )
                 res = false;
         }
     };
@@ -46,9 +46,9 @@ namespace
         static return_type init() {return true;}
 
         template<short_t d, class Z>
-        static void visitLeaf(gismo::gsKdNode<d, Z> * leafNode , int level, return_type & res)
+        static void visitLeaf(const gismo::gsKdNode<d, Z> & leafNode , int level, return_type & res)
         {
-            if ( leafNode->level <= level )
+            if ( leafNode.level <= level )
                 res = false;
         }
     };
@@ -63,10 +63,10 @@ namespace
         static return_type init() {return 1000000;}
 
         template<short_t d, class Z>
-        static void visitLeaf(gismo::gsKdNode<d, Z> * leafNode , int , return_type & res)
+        static void visitLeaf(const gismo::gsKdNode<d, Z> & leafNode , int , return_type & res)
         {
-            if ( leafNode->level < res )
-                res = leafNode->level;
+            if ( leafNode.level < res )
+                res = leafNode.level;
         }
     };
 
@@ -80,10 +80,10 @@ namespace
         static return_type init() {return -1;}
 
         template<short_t d, class Z>
-        static void visitLeaf(gismo::gsKdNode<d, Z> * leafNode , int , return_type & res)
+        static void visitLeaf(const gismo::gsKdNode<d, Z> & leafNode , int , return_type & res)
         {
-            if ( leafNode->level > res )
-                res = leafNode->level;
+            if ( leafNode.level > res )
+                res = leafNode.level;
         }
     };
 
@@ -114,22 +114,64 @@ inline bool gsHDomain<d, Z>::isContained(box const & box1, box const & box2)
 }
 
 template<short_t d, class Z> void
-gsHDomain<d, Z>::setLevel(node *_node, int lvl)
+gsHDomain<d, Z>::split(index_t i, int splitAxis, Z splitPos)
 {
-    // to do: non-recc.
-    if ( _node->isLeaf() )
-    {
-        // if the level in the *_node is smaller the value of lvl we
-        // modify it
-        _node->level = lvl;
-    }
-    else
+    GISMO_ASSERT( m_nodes[i].isLeaf(), "Can only split leaf nodes.");
+    GISMO_ASSERT( m_nodes[i].box.second[splitAxis] != splitPos, "Degenerate split " << m_nodes[i].box.second[splitAxis] <<" != "<<splitPos);
+    GISMO_ASSERT( m_nodes[i].box.first [splitAxis] != splitPos, "Degenerate split " << m_nodes[i].box.first[splitAxis]  <<" != "<<splitPos);
+
+    // Make new left and right children (leaves), the box of the
+    // parent is kept
+    node child = m_nodes[i];
+    child.parent = i;
+    child.left   = -1;
+    child.box.second[splitAxis] = splitPos;
+    m_nodes[i].axis = splitAxis;
+    m_nodes[i].pos  = splitPos;
+    m_nodes[i].left = m_nodes.size();
+    m_nodes.push_back(child);
+    child.box.second[splitAxis] = m_nodes[i].box.second[splitAxis];
+    child.box.first [splitAxis] = splitPos;
+    m_nodes.push_back(child);
+}
+
+template<short_t d, class Z> index_t
+gsHDomain<d, Z>::adaptiveAlignedSplit(index_t i, box const & insBox)
+{
+    const node & cur = m_nodes[i];
+    const unsigned h = 1 << (m_indexLevel - cur.level) ;
+
+    for (short_t k = 0; k < d; ++k)
     {
-        // we call the function set level for all existing children of
-        // the node *_node
-        setLevel(_node->left , lvl);
-        setLevel(_node->right, lvl);
+        const Z c1 = insBox. first[k] - insBox. first[k] % h; //floor
+        const Z cc = insBox.second[k] % h;
+        const Z c2 = insBox.second[k] + (cc ? h-cc : 0 ); // ceil
+
+        if ( c1 > cur.box.first[k] )
+        {
+            // right child intersects insBox
+            split(i, k, c1 );
+            return m_nodes[i].right();
+        }
+        else if ( c2 < cur.box.second[k]  )
+        {
+            // left child intersects insBox
+            split(i, k, c2 );
+            return m_nodes[i].left;
+        }
     }
+    return -1;
+}
+
+template<short_t d, class Z> void
+gsHDomain<d, Z>::merge(index_t i)
+{
+    GISMO_ASSERT( node::isTerminal(m_nodes.data(), i),
+                  "Can only merge terminal nodes.");
+    node & cur = m_nodes[i];
+    cur.level = m_nodes[cur.left].level;
+    cur.axis  = -1;
+    cur.left  = -1;
 }
 
 template<short_t d, class Z> inline bool
@@ -141,7 +183,7 @@ gsHDomain<d, Z>::isDegenerate(box const & someBox)
 //use "surface area heuristic" (SAH) ?
 template<short_t d, class Z> void
 gsHDomain<d, Z>::insertBox ( point const & k1, point const & k2,
-                            node *_node, int lvl) // CONSTRAINT: lvl is "minimum level"
+                            index_t _node, int lvl) // CONSTRAINT: lvl is "minimum level"
 {
     GISMO_ENSURE( lvl <= static_cast<int>(m_indexLevel), "Max index level reached..");
 
@@ -164,34 +206,33 @@ gsHDomain<d, Z>::insertBox ( point const & k1, point const & k2,
     }
 
     // Initialize stack
-    std::vector<node*> stack;
+    std::vector<index_t> stack;
     stack.reserve( 2 * (m_maxPath + d) );
     stack.push_back(_node);  //push(_node);
 
-    node * curNode;
+    index_t curNode;
     while ( ! stack.empty() )
     {
         curNode = stack.back(); //top();
         stack.pop_back();       //pop();
 
-        if ( curNode->isLeaf() ) // reached a leaf
+        if ( m_nodes[curNode].isLeaf() ) // reached a leaf
         {
             // Since we reached a leaf, it should overlap with iBox
 
             // If this leaf is already in level lvl, then we have nothing to do
-            if ( lvl <= curNode->level )
+            if ( lvl <= m_nodes[curNode].level )
                 continue;
 
             // Split the leaf (if possible)
-            //node * newLeaf = curNode->adaptiveSplit(iBox);
-            node * newLeaf = curNode->adaptiveAlignedSplit(iBox, m_indexLevel);
+            const index_t newLeaf = adaptiveAlignedSplit(curNode, iBox);
 
             // If curNode is still a leaf, its domain is almost
             // contained in iBox
-            if ( !newLeaf ) //  curNode->isLeaf()
+            if ( -1 == newLeaf ) //  m_nodes[curNode].isLeaf()
             {
                 // Increase level and reccurse
-                if ( ++curNode->level != lvl)
+                if ( ++m_nodes[curNode].level != lvl)
                     stack.push_back(curNode);
             }
             else // treat new child
@@ -201,17 +242,18 @@ gsHDomain<d, Z>::insertBox ( point const & k1, point const & k2,
         }
         else // roll down the tree
         {
-            if ( iBox.second[curNode->axis] <= curNode->pos)
+            const node & cur = m_nodes[curNode];
+            if ( iBox.second[cur.axis] <= cur.pos)
                 // iBox overlaps only left child of this split-node
-                stack.push_back(curNode->left);
-            else if  ( iBox.first[curNode->axis] >= curNode->pos)
+                stack.push_back(cur.left);
+            else if  ( iBox.first[cur.axis] >= cur.pos)
                 // iBox overlaps only right child of this split-node
-                stack.push_back(curNode->right);
+                stack.push_back(cur.right());
             else
             {
                 // iBox overlaps both children of this split-node
-                stack.push_back(curNode->left );
-                stack.push_back(curNode->right);
+                stack.push_back(cur.left );
+                stack.push_back(cur.right());
             }
         }
     }
@@ -246,33 +288,33 @@ gsHDomain<d, Z>::clearBox ( point const & k1, point const & k2,
     }
 
     // Initialize stack
-    std::vector<node*> stack;
+    std::vector<index_t> stack;
     stack.reserve( 2 * (m_maxPath + d) );
-    stack.push_back(m_root);  //push(m_root);
+    stack.push_back(0);  //push(root);
 
-    node * curNode;
+    index_t curNode;
     while ( ! stack.empty() )
     {
         curNode = stack.back(); //top();
         stack.pop_back();       //pop();
 
-        if ( curNode->isLeaf() ) // reached a leaf
+        if ( m_nodes[curNode].isLeaf() ) // reached a leaf
         {
             // Since we reached a leaf, it should overlap with iBox
 
             // If this leaf is already in level lvl, then we have nothing to do
-            if ( curNode->level <= lvl )
+            if ( m_nodes[curNode].level <= lvl )
                 continue;
 
             // Split the leaf (if possible)
-            node * newLeaf = curNode->adaptiveAlignedSplit(iBox, m_indexLevel);
+            const index_t newLeaf = adaptiveAlignedSplit(curNode, iBox);
 
             // If curNode is still a leaf, its domain is almost
             // contained in iBox
-            if ( !newLeaf ) //  curNode->isLeaf()
+            if ( -1 == newLeaf ) //  m_nodes[curNode].isLeaf()
             {
                 // Decrease level and reccurse
-                if ( --curNode->level != lvl)
+                if ( --m_nodes[curNode].level != lvl)
                     stack.push_back(curNode);
             }
             else // treat new child
@@ -282,17 +324,18 @@ gsHDomain<d, Z>::clearBox ( point const & k1, point const & k2,
         }
         else // roll down the tree
         {
-            if ( iBox.second[curNode->axis] <= curNode->pos)
+            const node & cur = m_nodes[curNode];
+            if ( iBox.second[cur.axis] <= cur.pos)
                 // iBox overlaps only left child of this split-node
-                stack.push_back(curNode->left);
-            else if  ( iBox.first[curNode->axis] >= curNode->pos)
+                stack.push_back(cur.left);
+            else if  ( iBox.first[cur.axis] >= cur.pos)
                 // iBox overlaps only right child of this split-node
-                stack.push_back(curNode->right);
+                stack.push_back(cur.right());
             else
             {
                 // iBox overlaps both children of this split-node
-                stack.push_back(curNode->left );
-                stack.push_back(curNode->right);
+                stack.push_back(cur.left );
+                stack.push_back(cur.right());
             }
         }
     }
@@ -324,28 +367,28 @@ gsHDomain<d, Z>::sinkBox (point const & k1,
     }
 
     // Initialize stack
-    std::stack<node*, std::vector<node*> > stack;
-    stack.push(m_root);
+    std::stack<index_t, std::vector<index_t> > stack;
+    stack.push(0);
 
-    node * curNode;
+    index_t curNode;
     while ( ! stack.empty() )
     {
         curNode = stack.top();
         stack.pop();
 
-        if ( curNode->isLeaf() ) // reached a leaf
+        if ( m_nodes[curNode].isLeaf() ) // reached a leaf
         {
             // Since we reached a leaf, it should overlap with iBox.
             // Split the leaf (if possible)
-            node * newLeaf = curNode->adaptiveAlignedSplit(iBox, m_indexLevel);
+            const index_t newLeaf = adaptiveAlignedSplit(curNode, iBox);
 
             // If curNode is still a leaf, its domain is almost
             // contained in iBox
-            if ( !newLeaf ) //  implies curNode was a leaf
+            if ( -1 == newLeaf ) //  implies curNode was a leaf
             {
                 // Increase level
-                if ( ++curNode->level > static_cast<int>(m_maxInsLevel) )
-                    m_maxInsLevel = curNode->level;
+                if ( ++m_nodes[curNode].level > static_cast<int>(m_maxInsLevel) )
+                    m_maxInsLevel = m_nodes[curNode].level;
             }
             else // treat new child
             {
@@ -354,17 +397,18 @@ gsHDomain<d, Z>::sinkBox (point const & k1,
         }
         else // walk down the tree
         {
-            if ( iBox.second[curNode->axis] <= curNode->pos)
+            const node & cur = m_nodes[curNode];
+            if ( iBox.second[cur.axis] <= cur.pos)
                 // iBox overlaps only left child of this split-node
-                stack.push(curNode->left);
-            else if  ( iBox.first[curNode->axis] >= curNode->pos)
+                stack.push(cur.left);
+            else if  ( iBox.first[cur.axis] >= cur.pos)
                 // iBox overlaps only right child of this split-node
-                stack.push(curNode->right);
+                stack.push(cur.right());
             else
             {
                 // iBox overlaps both children of this split-node
-                stack.push(curNode->left );
-                stack.push(curNode->right);
+                stack.push(cur.left );
+                stack.push(cur.right());
             }
         }
     }
@@ -373,26 +417,27 @@ gsHDomain<d, Z>::sinkBox (point const & k1,
 template<short_t d, class Z>
 void gsHDomain<d, Z>::makeCompressed()
 {
-    std::stack<node*, std::vector<node*> > tstack;
-    node * curNode;
+    std::stack<index_t, std::vector<index_t> > tstack;
+    index_t curNode;
+    const node * nodes = m_nodes.data();
 
     // First step: gather all terminal nodes
-    std::stack<node*, std::vector<node*> > stack;
-    stack.push(m_root);
+    std::stack<index_t, std::vector<index_t> > stack;
+    stack.push(0);
     while ( ! stack.empty() )
     {
         curNode = stack.top();
         stack.pop();
 
-        if ( curNode->isTerminal() )
+        if ( node::isTerminal(nodes, curNode) )
         {
             // Remember this terminal node
             tstack.push(curNode);
         }
-        else if ( ! curNode->isLeaf() ) // this is a non-terminal split-node
+        else if ( ! nodes[curNode].isLeaf() ) // this is a non-terminal split-node
         {
-                stack.push(curNode->left );
-                stack.push(curNode->right);
+                stack.push(nodes[curNode].left   );
+                stack.push(nodes[curNode].right());
         }
     }
 
@@ -402,23 +447,41 @@ void gsHDomain<d, Z>::makeCompressed()
         curNode = tstack.top();
         tstack.pop();
 
-        if (curNode->left->level == curNode->right->level)
+        if (nodes[nodes[curNode].left].level == nodes[nodes[curNode].right()].level)
         {
             // Merge left and right
-            curNode->merge();
-            if ( !curNode->isRoot() &&
-                  curNode->parent->isTerminal() )
-                tstack.push(curNode->parent );
+            merge(curNode);
+            if ( !nodes[curNode].isRoot() &&
+                  node::isTerminal(nodes, nodes[curNode].parent) )
+                tstack.push(nodes[curNode].parent );
         }
     }
 
+    // Third step: store the remaining nodes in breadth-first order,
+    // the merged ones are dropped
+    typename node::Container tree;
+    tree.reserve(m_nodes.size());
+    tree.push_back(m_nodes.front());
+    for (size_t i = 0; i != tree.size(); ++i)
+    {
+        if ( tree[i].isLeaf() )
+            continue;
+        const index_t l = tree[i].left;
+        tree[i].left = tree.size();
+        tree.push_back(m_nodes[l  ]);
+        tree.back().parent = i;
+        tree.push_back(m_nodes[l+1]);
+        tree.back().parent = i;
+    }
+    m_nodes.swap(tree);
+
     // Store the max path length
     m_maxPath = minMaxPath().second;
 }
 
 template<short_t d, class Z>
 bool gsHDomain<d, Z>::query1(point const & lower, point const & upper,
-                             int level, node  *_node) const
+                             int level, index_t _node) const
 {
     return boxSearch< query1_visitor >(upper,lower,level,_node);
 }
@@ -427,12 +490,12 @@ template<short_t d, class Z>
 bool gsHDomain<d, Z>::query1(point const & lower, point const & upper,
                              int level) const
 {
-    return boxSearch< query1_visitor >(upper,lower,level,m_root);
+    return boxSearch< query1_visitor >(upper,lower,level,0);
 }
 
 template<short_t d, class Z>
 bool gsHDomain<d, Z>::query2(point const & lower, point const & upper,
-                             int level, node  *_node) const
+                             int level, index_t _node) const
 {
     return boxSearch< query2_visitor >(lower,upper,level,_node);
 }
@@ -441,12 +504,12 @@ template<short_t d, class Z>
 bool gsHDomain<d, Z>::query2 (point const & lower, point const & upper,
                               int level) const
 {
-    return boxSearch< query2_visitor >(lower,upper,level,m_root);
+    return boxSearch< query2_visitor >(lower,upper,level,0);
 }
 
 template<short_t d, class Z>
 int gsHDomain<d, Z>::query3(point const & lower, point const & upper,
-                            int level, node  *_node) const
+                            int level, index_t _node) const
 {
     return boxSearch< query3_visitor >(lower,upper,level,_node);
 }
@@ -455,12 +518,12 @@ template<short_t d, class Z>
 int gsHDomain<d, Z>::query3(point const & lower, point const & upper,
                             int level) const
 {
-    return boxSearch< query3_visitor >(lower,upper,level,m_root);
+    return boxSearch< query3_visitor >(lower,upper,level,0);
 }
 
 template<short_t d, class Z>
 int gsHDomain<d, Z>::query4(point const & lower, point const & upper,
-                            int level, node  *_node) const
+                            int level, index_t _node) const
 {
     return boxSearch< query4_visitor >(lower,upper,level,_node);
 }
@@ -469,7 +532,7 @@ template<short_t d, class Z>
 int gsHDomain<d, Z>::query4(point const & lower, point const & upper,
                             int level) const
 {
-    return boxSearch< query4_visitor >(lower,upper,level,m_root);
+    return boxSearch< query4_visitor >(lower,upper,level,0);
 }
 
 template<short_t d, class Z>
@@ -477,7 +540,7 @@ std::pair<typename gsHDomain<d, Z>::point, typename gsHDomain<d, Z>::point>
 gsHDomain<d, Z>::queryLevelCell(point const & lower, point const & upper,
                                 int level) const
 {
-    std::pair<point,point> tmp = boxSearch< get_cell_visitor >(lower,upper,level,m_root);
+    std::pair<point,point> tmp = boxSearch< get_cell_visitor >(lower,upper,level,0);
     global2localIndex(tmp.first,level,tmp.first);
     global2localIndex(tmp.second,level,tmp.second);
     return tmp;
@@ -516,7 +579,7 @@ template<short_t d, class Z>
 template<typename visitor>
 typename visitor::return_type
 gsHDomain<d, Z>::boxSearch(point const & k1, point const & k2,
-                           int level, node  *_node ) const
+                           int level, index_t _node ) const
 {
     // Make a box
     box qBox(k1,k2);
@@ -529,47 +592,57 @@ gsHDomain<d, Z>::boxSearch(point const & k1, point const & k2,
 
     typename visitor::return_type res = visitor::init();
 
-    std::vector<node*> stack;
-    stack.reserve( 2 * m_maxPath );
-    stack.push_back(_node);  //push(_node);
-
-    node * curNode;
-    while ( ! stack.empty() )
+    // Depth-first traversal (right child first) of the children
+    // overlapping qBox. Instead of a stack, the number of split-nodes
+    // on the current path whose left child is still to be visited is
+    // counted, these are found again by the parent indices.
+    const node * nodes = m_nodes.data();
+    index_t curNode = _node;
+    int pending = 0;
+    while ( true )
     {
-        curNode = stack.back(); //top();
-        stack.pop_back();       //pop();
-
-        if ( curNode->isLeaf() )
+        const node & cur = nodes[curNode];
+        if ( cur.isLeaf() )
         {
             // Visit the leaf
-            GISMO_ASSERT( !isDegenerate(*curNode->box), "Encountered an empty leaf");
-            visitor::visitLeaf(curNode, level, res );
+            GISMO_ASSERT( !cur.isDegenerate(), "Encountered an empty leaf");
+            visitor::visitLeaf(cur, level, res );
+
+            if ( 0 == pending )
+                return res;
+
+            // Go up to the first right child whose left sibling
+            // overlaps qBox
+            while ( true )
+            {
+                const node & par = nodes[nodes[curNode].parent];
+                if ( curNode != par.left && qBox.first[par.axis] < par.pos )
+                {
+                    curNode = par.left;
+                    --pending;
+                    break;
+                }
+                curNode = nodes[curNode].parent;
+            }
         }
         else // this is a split-node
         {
-            if ( qBox.second[curNode->axis] <= curNode->pos)
-                // qBox overlaps only left child of this split-node
-                stack.push_back(curNode->left); //push(curNode->left);
-            else if  ( qBox.first[curNode->axis] >= curNode->pos)
-                // qBox overlaps only right child of this split-node
-                stack.push_back(curNode->right); //push(curNode->right);
-            else
+            if ( qBox.second[cur.axis] > cur.pos )
             {
-                // qBox overlaps both children of this split-node
-                stack.push_back(curNode->left ); //push(curNode->left );
-                stack.push_back(curNode->right); //push(curNode->right);
+                // qBox overlaps the right child of this split-node
+                curNode = cur.right();
+                if ( qBox.first[cur.axis] < cur.pos )
+                    ++pending; // and the left one
             }
+            else
+                // qBox overlaps only left child of this split-node
+                curNode = cur.left;
         }
     }
-
-    return res;
 }
 
-
-
 template<short_t d, class Z>
-typename gsHDomain<d, Z>::node *
-gsHDomain<d, Z>::pointSearch(const point & p, int level, node  *_node ) const
+index_t gsHDomain<d, Z>::pointSearch(const point & p, int level, index_t _node ) const
 {
     point pp;
     local2globalIndex(p, static_cast<unsigned>(level), pp);
@@ -577,63 +650,13 @@ gsHDomain<d, Z>::pointSearch(const point & p, int level, node  *_node ) const
     GISMO_ASSERT( ( pp.array() <= m_upperIndex.array() ).all(),
         "pointSearch: Wrong input: "<< p.transpose()<<", level "<<level<<".\n" );
 
-    std::vector<node*> stack;
-    stack.reserve( 2 * m_maxPath );
-    stack.push_back(_node);
-
-    node * curNode;
-    while ( ! stack.empty() )
-    {
-        curNode = stack.back(); //top();
-        stack.pop_back();       //pop();
-
-        if ( curNode->isLeaf() )
-        {
-            // Point found at current node
-            return curNode;
-        }
-        else // this is a split-node
-        {
-            if ( pp[curNode->axis] < curNode->pos)
-                stack.push_back(curNode->left);
-            else
-                stack.push_back(curNode->right);
-        }
-    }
-    GISMO_ERROR("pointSearch: Error ("<< p.transpose()<<").\n" );
-}
-
+    const node * nodes = m_nodes.data();
+    while ( !nodes[_node].isLeaf() )
+        _node = pp[nodes[_node].axis] < nodes[_node].pos ?
+            nodes[_node].left : nodes[_node].right();
 
-template<short_t d, class Z>
-template<typename visitor>
-typename visitor::return_type
-gsHDomain<d, Z>::nodeSearch() const
-{
-    typename visitor::return_type i = visitor::init();
-
-    node * curNode = m_root;
-
-    while(true)
-    {
-        visitor::visitNode(curNode, i);
-
-        if ( !curNode->isLeaf() )
-        {   //property: tree has no singles
-            curNode = curNode->left;
-        }
-        else
-        {
-            while (curNode->parent != NULL &&
-                   curNode != curNode->parent->left)
-                curNode = curNode->parent;
-
-            if ( curNode->isRoot() )
-                break;
-            else
-                curNode = curNode->parent->right;
-        }
-    }
-    return i;
+    // Point found at current node
+    return _node;
 }
 
 template<short_t d, class Z>
@@ -643,28 +666,12 @@ gsHDomain<d, Z>::leafSearch() const
 {
     typename visitor::return_type i = visitor::init();
 
-    node * curNode = m_root;
-
-    while(true)
+    const node * nodes = m_nodes.data();
+    for (index_t curNode = node::firstLeaf(nodes, 0); -1 != curNode;
+         curNode = node::nextLeaf(nodes, curNode) )
     {
-        if ( !curNode->isLeaf() )
-        {   //property: tree has no singles (only childs)
-            curNode = curNode->left;
-        }
-        else
-        {
-            // Visit the leaf
-            visitor::visitLeaf(curNode, i);
-
-            while (curNode->parent != NULL &&
-                   curNode != curNode->parent->left)
-                curNode = curNode->parent;
-
-            if ( curNode->isRoot() )
-                break;
-            else
-                curNode = curNode->parent->right;
-        }
+        // Visit the leaf
+        visitor::visitLeaf(nodes[curNode], i);
     }
     return i;
 }
@@ -674,33 +681,21 @@ template<short_t d, class Z>
 std::pair<int,int>
 gsHDomain<d, Z>::minMaxPath() const
 {
-    node * curNode = m_root;
-    int min = 1000000000, max = -1, cur = 0;
+    int min = 1000000000, max = -1;
 
-    while(true)
+    // The children are always stored after their parent
+    std::vector<int> path(m_nodes.size());
+    path[0] = 0;
+    for (size_t i = 0; i != m_nodes.size(); ++i)
     {
-        if ( !curNode->isLeaf() )
-        {   //property: tree has no singles
-            curNode = curNode->left;
-            cur++;
-        }
-        else
+        if ( !m_nodes[i].isRoot() )
+            path[i] = path[m_nodes[i].parent] + 1;
+
+        if ( m_nodes[i].isLeaf() )
         {
             // Update min-max
-            min = math::min(min,cur);
-            max = math::max(max,cur);
-
-            while (curNode->parent != NULL &&
-                   curNode != curNode->parent->left)
-            {
-                curNode = curNode->parent;
-                cur--;
-            }
-
-            if ( curNode->isRoot() )
-                break;
-            else
-                curNode = curNode->parent->right;
+            min = math::min(min,path[i]);
+            max = math::max(max,path[i]);
         }
     }
     return std::make_pair(min,max);
@@ -1045,44 +1040,32 @@ gsHDomain<d, Z>::getBoxes_vec(std::vector<std::vector<Z> >& boxes) const
 {
     boxes.clear();
 
-    std::stack<node*, std::vector<node*> > stack;
-    //stack.reserve( 2 * m_maxPath );
-    stack.push(m_root);
-    node * curNode;
-    while ( ! stack.empty() )
+    const node * nodes = m_nodes.data();
+    for (index_t curNode = node::firstLeaf(nodes, 0); -1 != curNode;
+         curNode = node::nextLeaf(nodes, curNode) )
     {
-        curNode = stack.top();
-        stack.pop();
-
-        if ( curNode->isLeaf() )
+        // We need to convert the indices to those of m_maxInsLevel
+        // to be able to reconstruct the earlier results.
+        const point & lowerGlob = nodes[curNode].lowCorner();
+        const point & upperGlob = nodes[curNode].uppCorner();
+        unsigned int level = this->m_maxInsLevel;
+        point lower;
+        point upper;
+
+        global2localIndex(lowerGlob,level,lower);
+        global2localIndex(upperGlob,level,upper);
+
+        boxes.push_back(std::vector<Z>());
+        boxes.back().reserve(2*d+1);
+        for(short_t i = 0; i < d; i++)
         {
-            // We need to convert the indices to those of m_maxInsLevel
-            // to be able to reconstruct the earlier results.
-            const point & lowerGlob = curNode->lowCorner();
-            const point & upperGlob = curNode->uppCorner();
-            unsigned int level = this->m_maxInsLevel;
-            point lower;
-            point upper;
-
-            global2localIndex(lowerGlob,level,lower);
-            global2localIndex(upperGlob,level,upper);
-
-            boxes.push_back(std::vector<Z>());
-            for(short_t i = 0; i < d; i++)
-            {
-                boxes.back().push_back(lower[i]);
-            }
-            for(short_t i = 0; i < d; i++)
-            {
-                boxes.back().push_back(upper[i]);
-            }
-            boxes.back().push_back(curNode->level);
+            boxes.back().push_back(lower[i]);
         }
-        else
+        for(short_t i = 0; i < d; i++)
         {
-            stack.push(curNode->left) ;
-            stack.push(curNode->right);
+            boxes.back().push_back(upper[i]);
         }
+        boxes.back().push_back(nodes[curNode].level);
     }
 }
 
@@ -1359,34 +1342,35 @@ inline void gsHDomain<d, Z>::incrementLevel()
     GISMO_ASSERT( m_maxInsLevel <= m_indexLevel,
                   "Problem with indices, increase number of levels (to do).");
 
-    leafSearch< levelUp_visitor >();
+    // All the nodes in the array belong to the tree
+    for (typename node::Container::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        if ( it->isLeaf() )
+            ++it->level;
 }
 
 template<short_t d, class Z>
 inline void gsHDomain<d, Z>::multiplyByTwo()
 {
     m_upperIndex *= 2;
-    nodeSearch< liftCoordsOneLevel_visitor >();
+    for (typename node::Container::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        it->multiplyByTwo();
 }
 
 template<short_t d, class Z>
 inline void gsHDomain<d, Z>::divideByTwo()
 {
     m_upperIndex /= 2;
-    nodeSearch< reduceCoordsOneLevel_visitor >();
+    for (typename node::Container::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        it->divideByTwo();
 }
 
 template<short_t d, class Z>
 inline void gsHDomain<d, Z>::decrementLevel()
 {
     m_maxInsLevel--;
-    leafSearch< levelDown_visitor >();
-}
-
-template<short_t d, class Z>
-inline int gsHDomain<d, Z>::size() const
-{
-    return nodeSearch< numNodes_visitor >();
+    for (typename node::Container::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+        if ( it->isLeaf() )
+            --it->level;
 }
 
 template<short_t d, class Z>
@@ -36,92 +36,77 @@ public:
     typedef typename node::point point;
 
 public:
-    reference operator*() const { return *curNode; }
-    pointer  operator->() const { return  curNode; }
+    reference operator*() const { return m_nodes[m_curr]; }
+    pointer  operator->() const { return m_nodes + m_curr; }
 
 public:
 
-    gsHDomainLeafIter() : curNode(0)
+    gsHDomainLeafIter() : m_nodes(NULL), m_curr(-1), m_index_level(0), m_root(0)
     { }
 
-    explicit gsHDomainLeafIter( node * const root_node, index_t index_level)
-        : m_index_level(index_level)
-    { 
-        m_stack.push(root_node);
-
+    /// Iterates over the leaves of the tree stored in \a nodes (with
+    /// the root at the first entry)
+    explicit gsHDomainLeafIter( pointer const nodes, index_t index_level)
+    : m_nodes(nodes), m_index_level(index_level), m_root(0)
+    {
         // Go to the first leaf
-        next();
+        m_curr = m_nodes ? node::firstLeaf(m_nodes, m_root) : -1;
     }
 
     // Next leaf
     bool next()
     {
-        while ( ! m_stack.empty() )
-        {
-            curNode = m_stack.top();
-            m_stack.pop();
-            
-            if ( curNode->isLeaf() )
-            {
-                return true;
-            }
-            else // this is a split-node
-            {
-                m_stack.push(curNode->left );
-                m_stack.push(curNode->right);
-            }
-        }
-
-        // Leaves exhausted
-        curNode = NULL;
-        return false;
+        if (-1 == m_curr) return false; // no more leaves
+        m_curr = node::nextLeaf(m_nodes, m_curr, m_root);
+        return -1 != m_curr;
     }
 
     /// Returns true iff we are still pointing at a valid leaf
-    bool good() const   { return curNode != 0; }
+    bool good() const   { return -1 != m_curr; }
 
     /// The iteration is done in the sub-tree hanging from node \em root_node
-    void startFrom( node * const root_node)
+    void startFrom( index_t const root_node)
     {
-        m_stack.clear();
-        m_stack.push(root_node);
+        m_root = root_node;
+        m_curr = node::firstLeaf(m_nodes, m_root);
     }
 
-    int level() const { return curNode->level; }
+    int level() const { return m_nodes[m_curr].level; }
 
     point lowerCorner() const
-    { 
-        point result = curNode->box->first;
-        const int lvl = curNode->level;
+    {
+        point result = m_nodes[m_curr].box.first;
+        const int lvl = m_nodes[m_curr].level;
 
         //result = result.array() / (1>> (m_index_level-lvl)) ;
         for ( index_t i = 0; i!= result.size(); ++i )
             result[i] = result[i] >> (m_index_level-lvl) ;
 
-        return result; 
+        return result;
     }
 
     point upperCorner() const
     {
-        point result = curNode->box->second;
-        const int lvl = curNode->level;
+        point result = m_nodes[m_curr].box.second;
+        const int lvl = m_nodes[m_curr].level;
 
         for ( index_t i = 0; i!=result.size(); ++i )
             result[i] = result[i] >> (m_index_level-lvl) ;
 
-        return result; 
+        return result;
     }
 
     index_t indexLevel() const {return m_index_level;}
 
     bool isAligned() const
     {
-        const unsigned h = 1 << (m_index_level - curNode->level);
+        const node & curNode = m_nodes[m_curr];
+        const unsigned h = 1 << (m_index_level - curNode.level);
 
-        for ( index_t i = 0; i!=curNode->box->first.size(); ++i )
+        for ( index_t i = 0; i!=curNode.box.first.size(); ++i )
         {
-            if (curNode->box->second[i] % h != 0 ||
-                curNode->box->first[i]  % h != 0 )
+            if (curNode.box.second[i] % h != 0 ||
+                curNode.box.first[i]  % h != 0 )
                 return false;
         }
         return true;
@@ -129,14 +114,17 @@ public:
 
 private:
 
-    // current node
-    node * curNode;
+    // the nodes of the tree
+    pointer m_nodes;
+
+    // index of the current node
+    index_t m_curr;
 
     /// The level of the box representation
     index_t m_index_level;
 
-    // stack of pointers to tree nodes, used in next()
-    std::stack<node*> m_stack; // to do: change type to std::vector
+    // index of the root of the sub-tree
+    index_t m_root;
 };
 
 
@@ -36,31 +36,37 @@ class gsHDomainSliceIter
 {
 public:
     //typedef kdnode<d, index_t> node;
-    typedef typename choose<isconst, const node&, node&>::type reference;
-    typedef typename choose<isconst, const node*, node*>::type pointer;
+    typedef typename util::conditional<isconst, const node&, node&>::type reference;
+    typedef typename util::conditional<isconst, const node*, node*>::type pointer;
 
-    typedef typename node::point::Projection_t point;
+    // point of the slice, ie. without the coordinate in the sliced direction
+    typedef gsVector<typename node::point::Scalar,
+                     ChangeDim<node::point::RowsAtCompileTime, -1>::D> point;
 
-    static const index_t d = point::_Rows;// d is the slice dimension
+    static const index_t d = point::RowsAtCompileTime;// d is the slice dimension
 
 public:
-    reference operator*() const { return *curNode; }
-    pointer  operator->() const { return  curNode; }
+    reference operator*() const { return m_nodes[m_curr]; }
+    pointer  operator->() const { return m_nodes + m_curr; }
 
 public:
 
     gsHDomainSliceIter() 
-    : m_dir(0), m_pos(0), m_last(0), curNode(0), m_index_level(0)
+    : m_dir(0), m_pos(0), m_last(0), m_nodes(NULL), m_curr(-1), m_index_level(0)
     { }
 
-    gsHDomainSliceIter( node * const root_node, 
+    /// Iterates over the leaves of the tree stored in \a nodes (see
+    /// gsHDomain) which hang from the node \a root_node
+    gsHDomainSliceIter( pointer const nodes,
+                        const index_t root_node,
                         const unsigned _dir, 
                         const unsigned _pos,
                         const unsigned _last,
                         const unsigned index_level)
-    : m_dir(m_dir), m_pos(_pos), m_last(_last), m_index_level(index_level)
+    : m_dir(_dir), m_pos(_pos), m_last(_last), m_nodes(nodes), m_curr(-1),
+      m_index_level(index_level)
     { 
-        m_stack.push(root_node);
+        m_stack.push_back(root_node);
 
         // Go to the first leaf
         next();
@@ -71,64 +77,67 @@ public:
     {
         while ( ! m_stack.empty() )
         {
-            curNode = m_stack.top();
-            m_stack.pop();
+            m_curr = m_stack.back();
+            m_stack.pop_back();
+            const node & curNode = m_nodes[m_curr];
             
-            if ( curNode->isLeaf() )
+            if ( curNode.isLeaf() )
             {
                 // does this box intersect the slice ?  
                 // note: boxes are considered half-open, eg. products
                 // of intervals [a,b), except from the rightmost
                 // interval which is closed
-                // if ( (curNode->box->lowCorner()[m_dir] <= m_pos) && 
-                //      (curNode->box->uppCorner()[m_dir] >  m_pos  ||
-                //      (m_pos == m_last && curNode->box->uppCorner()[m_dir] == m_pos) )
+                // if ( (curNode.lowCorner()[m_dir] <= m_pos) && 
+                //      (curNode.uppCorner()[m_dir] >  m_pos  ||
+                //      (m_pos == m_last && curNode.uppCorner()[m_dir] == m_pos) )
                 //    )
                      return true;
             }
             else // this is a split-node
             {
-                if ( curNode->axis == m_dir )
+                if ( curNode.axis == static_cast<int>(m_dir) )
                 {
-                    if (m_pos < curNode->pos)
-                        m_stack.push(curNode->left);
+                    if (static_cast<index_t>(m_pos) < curNode.pos)
+                        m_stack.push_back(curNode.left);
                     else 
-                        m_stack.push(curNode->right);
+                        m_stack.push_back(curNode.right());
                 }
                 else
                 {
-                    m_stack.push(curNode->left);
-                    m_stack.push(curNode->right);
+                    m_stack.push_back(curNode.left);
+                    m_stack.push_back(curNode.right());
                 }
             }
         }
 
         // Leaves exhausted
-        curNode = NULL;
+        m_curr = -1;
         return false;
     }
 
     /// Returns true iff we are still pointing at a valid leaf
-    bool good() const   { return curNode != 0; }
+    bool good() const   { return -1 != m_curr; }
 
     /// The iteration is done in the sub-tree hanging from node \em root_node
-    void startFrom( node * const root_node)
+    void startFrom( const index_t root_node)
     {
         m_stack.clear();
-        m_stack.push(root_node);
+        m_stack.push_back(root_node);
+        next();
     }
 
-    int level() const { return curNode->level; }
+    int level() const { return m_nodes[m_curr].level; }
 
     /// \brief The lower corner of the sliced box.
     /// Note that \a m_dir is skipped
     point lowerCorner() const
     { 
+        const node & curNode = m_nodes[m_curr];
         point result;
-        result.topRows   (m_dir  ) = curNode->box->first.topRows(m_dir     );
-        result.bottomRows(d-m_dir) = curNode->box->first.bottomRows(d-m_dir);
+        result.topRows   (m_dir  ) = curNode.box.first.topRows(m_dir     );
+        result.bottomRows(d-m_dir) = curNode.box.first.bottomRows(d-m_dir);
 
-        const int lvl = curNode->level;
+        const int lvl = curNode.level;
 
         for ( index_t i = 0; i!= result.size(); ++i )
             result[i] = result[i] >> (m_index_level-lvl) ;
@@ -140,11 +149,12 @@ public:
     /// Note that \a m_dir is skipped
     point upperCorner() const
     { 
-        point result = curNode->box->second;
-        result.topRows   (m_dir  ) = curNode->box->second.topRows(m_dir     );
-        result.bottomRows(d-m_dir) = curNode->box->second.bottomRows(d-m_dir);
+        const node & curNode = m_nodes[m_curr];
+        point result;
+        result.topRows   (m_dir  ) = curNode.box.second.topRows(m_dir     );
+        result.bottomRows(d-m_dir) = curNode.box.second.bottomRows(d-m_dir);
 
-        const int lvl = curNode->level;
+        const int lvl = curNode.level;
 
         for ( index_t i = 0; i!=result.size(); ++i )
             result[i] = result[i] >> (m_index_level-lvl) ;
@@ -161,14 +171,17 @@ private:
     unsigned m_pos; // slice position index (span-index)
     unsigned m_last; // last (span-index) in direction \a m_dir --> most likely not needed
 
-    // current node
-    node * curNode;
+    // the nodes of the tree
+    pointer m_nodes;
+
+    // index of the current node
+    index_t m_curr;
 
     /// The level of the box representation
     unsigned m_index_level;
 
-    // stack of pointers to tree nodes, used in next()
-    std::stack<node*> m_stack;// to do: change type to std::vector
+    // stack of node indices, used in next()
+    std::vector<index_t> m_stack;
 };
 
 
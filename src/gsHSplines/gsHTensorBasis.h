@@ -701,6 +701,19 @@ public:
 
     void refineElements_withCoefs2(gsMatrix<T> & coefs,std::vector<index_t> const & boxes);
 
+    /** @brief Refines the elements given by \a boxes (see refineElements())
+     * and returns the renumbering of the basis functions.
+     *
+     * On return, <em>renumbering[i]</em> is the new index of the function
+     * which had index \a i before the refinement, or -1 if the function
+     * was deactivated. The map preserves the order of the indices, so
+     * coefficient vectors and DoF mappers of the kept functions can be
+     * updated without recomputation (the deactivated ones need the
+     * transfer matrix, see refineElements_withTransfer()).
+     */
+    void refineElements_withRenumbering(std::vector<index_t> const & boxes,
+                                        std::vector<index_t> & renumbering);
+
     void unrefineElements_withCoefs   (gsMatrix<T> & coefs,std::vector<index_t> const & boxes);
     void unrefineElements_withTransfer(std::vector<index_t> const & boxes, gsSparseMatrix<T> &transfer);
 
@@ -1043,6 +1056,35 @@ protected:
     /// be called after any modifications.
     virtual void update_structure(); // to do: rename as updateCharMatrices
 
+    /// @brief Updates the basis structure after the tree has been
+    /// modified in the \a regions (see changedRegion()). Only the
+    /// functions whose support overlaps a region are reconsidered; \a
+    /// renumbering maps the old indices to the new ones (see
+    /// refineElements_withRenumbering()).
+    void update_structure(std::vector<index_t> const & regions,
+                          std::vector<index_t> & renumbering);
+
+    /// @brief Updates the characteristic matrices by testing the
+    /// functions in \a changed (tensor indices per level) for activity;
+    /// all other functions keep their status.
+    virtual void update_structure_local(std::vector<CMatrix> const & changed,
+                                        std::vector<index_t> & renumbering);
+
+    /// @brief Appends to \a regions the part of the domain which
+    /// changes when the box [\a k1, \a k2] of level \a lvl is inserted
+    /// into (or, if \a sink is true, sunk in) the tree. The region is
+    /// a box in the format of refineElements() followed by the finest
+    /// level whose functions may change (-1 for all levels). To be
+    /// called before the insertion.
+    void changedRegion(point const & k1, point const & k2, int lvl,
+                       std::vector<index_t> & regions, bool sink = false) const;
+
+    /// @brief Returns in \a result the tensor indices (per level) of the
+    /// functions whose support overlaps one of the \a boxes (regions
+    /// as given by changedRegion()) on the levels they affect
+    void functionsOverlappingBoxes(std::vector<index_t> const & boxes,
+                                   std::vector<CMatrix> & result) const;
+
     /// @brief Makes sure that there are \a numLevels grids computed
     /// in the hierarachy
     void needLevel(int maxLevel) const;
@@ -1086,7 +1128,7 @@ private:
     /// \brief Returns the basis functions of \a level which have support on \a
     /// box, represented as an index box
     void functionOverlap(const point & boxLow, const point & boxUpp,
-                         const int level, point & actLow, point & actUpp);
+                         const int level, point & actLow, point & actUpp) const;
 
     // \brief Sets all functions of \a level to active or passive- one by one
     void set_activ1(int level);
@@ -708,6 +708,7 @@ void gsHTensorBasis<d,T>::refine(gsMatrix<T> const & boxes)
 #endif
 
     gsVector<index_t,d> k1, k2;
+    std::vector<index_t> regions;
     for(index_t i = 0; i < boxes.cols()/2; i++)
     {
         // 1. Get a small cell containing the box
@@ -742,13 +743,15 @@ void gsHTensorBasis<d,T>::refine(gsMatrix<T> const & boxes)
         //GISMO_UNUSED(tb);
 
         // Sink box
+        changedRegion(k1, k2, fLevel, regions, true);
         m_tree.sinkBox(k1, k2, fLevel);
         // Make sure we have enough levels
         needLevel( m_tree.getMaxInsLevel() );
     }
 
     // Update the basis
-    update_structure();
+    std::vector<index_t> renumbering;
+    update_structure(regions, renumbering);
 }
 
 // template<short_t d, class T>
@@ -825,9 +828,11 @@ void gsHTensorBasis<d,T>::refineBasisFunction(const index_t i)
         upp[k] = upp[k] << 1;
     }
     // Insert the domain to the lvl+1 nested domain
-    m_tree.insertBox(low,upp,lvl+1);
+    std::vector<index_t> regions, renumbering;
+    changedRegion(low,upp,lvl+1,regions);
+    insert_box(low,upp,lvl+1);
     // Update the basis
-    update_structure();
+    update_structure(regions, renumbering);
 }
 
 
@@ -841,9 +846,18 @@ void gsHTensorBasis<d,T>::refineBasisFunction(const index_t i)
 
 template<short_t d, class T>
 void gsHTensorBasis<d,T>::refineElements(std::vector<index_t> const & boxes)
+{
+    std::vector<index_t> renumbering;
+    refineElements_withRenumbering(boxes, renumbering);
+}
+
+template<short_t d, class T>
+void gsHTensorBasis<d,T>::refineElements_withRenumbering(std::vector<index_t> const & boxes,
+                                                         std::vector<index_t> & renumbering)
 {
     point i1;
     point i2;
+    std::vector<index_t> regions;
 
     GISMO_ASSERT( (boxes.size()%(2*d + 1))==0,
                   "The points did not define boxes properly. The boxes were not added to the basis.");
@@ -854,10 +868,11 @@ void gsHTensorBasis<d,T>::refineElements(std::vector<index_t> const & boxes)
             i1[j] = boxes[(i*(2*d+1))+j+1];
             i2[j] = boxes[(i*(2*d+1))+d+j+1];
         }
+        changedRegion(i1,i2,boxes[i*(2*d+1)],regions);
         insert_box(i1,i2,boxes[i*(2*d+1)]);
     }
 
-    update_structure();
+    update_structure(regions, renumbering);
 }
 
 template<short_t d, class T>
@@ -1077,7 +1092,7 @@ void gsHTensorBasis<d,T>::set_activ1(int level)
 
 template<short_t d, class T>
 void gsHTensorBasis<d,T>::functionOverlap(const point & boxLow, const point & boxUpp,
-                                          const int level, point & actLow, point & actUpp)
+                                          const int level, point & actLow, point & actUpp) const
 {
     const tensorBasis & tb = *m_bases[level];
     for(short_t i = 0; i != d; ++i)
@@ -1333,6 +1348,181 @@ void gsHTensorBasis<d,T>::update_structure() // to do: rename as updateHook
     }
 }
 
+template<short_t d, class T>
+void gsHTensorBasis<d,T>::update_structure(std::vector<index_t> const & regions,
+                                           std::vector<index_t> & renumbering)
+{
+    if (m_manualLevels) // non-dyadic levels: full update
+    {
+        const std::vector<CMatrix> oldX = m_xmatrix;
+        const std::vector<index_t> oldOffset = m_xmatrix_offset;
+        update_structure();
+
+        renumbering.resize(oldOffset.back());
+        for (size_t lvl = 0; lvl != oldX.size(); ++lvl)
+            for (size_t i = 0; i != oldX[lvl].size(); ++i)
+                renumbering[oldOffset[lvl]+i] =
+                    flatTensorIndexToHierachicalIndex(oldX[lvl][i], lvl);
+        return;
+    }
+
+    needLevel( m_tree.getMaxInsLevel() );
+    std::vector<CMatrix> changed;
+    functionsOverlappingBoxes(regions, changed);
+    update_structure_local(changed, renumbering);
+}
+
+template<short_t d, class T>
+void gsHTensorBasis<d,T>::update_structure_local(std::vector<CMatrix> const & changed,
+                                                 std::vector<index_t> & renumbering)
+{
+    GISMO_ASSERT(changed.size() == m_tree.getMaxInsLevel()+1, "Invalid size of changed functions.");
+    const size_t nLevels = changed.size();
+    const size_t oldLevels = m_xmatrix.size();
+    GISMO_ASSERT(oldLevels <= nLevels, "Levels were removed from the tree.");
+
+    // Compress the tree
+    m_tree.makeCompressed();
+
+    renumbering.resize(m_xmatrix_offset.back());
+    m_xmatrix.resize(nLevels);
+
+    gsMatrix<index_t,d,2> elSupp;
+    CMatrix merged;
+    for (size_t lvl = 0; lvl != nLevels; ++lvl)
+    {
+        CMatrix & cmat = m_xmatrix[lvl];
+        const CMatrix & cand = changed[lvl];
+        // renumbering within the level, shifted by the new offset below
+        index_t * renum = lvl < oldLevels ? renumbering.data() + m_xmatrix_offset[lvl] : NULL;
+
+        if ( cand.empty() )
+        {
+            for (size_t i = 0; i != cmat.size(); ++i)
+                renum[i] = i;
+            continue;
+        }
+
+        // Merge the unchanged functions with the active candidates
+        merged.clear();
+        merged.reserve(cmat.size() + cand.size());
+        cmatIterator it = cmat.begin(), c = cand.begin();
+        while ( it != cmat.end() || c != cand.end() )
+        {
+            if ( c == cand.end() || (it != cmat.end() && *it < *c) )
+            {
+                renum[it - cmat.begin()] = merged.size();
+                merged.push_back(*it++);
+                continue;
+            }
+
+            const bool wasActive = ( it != cmat.end() && *it == *c );
+            m_bases[lvl]->elementSupport_into(*c, elSupp);
+            const bool isActive = ( m_tree.query3(elSupp.col(0), elSupp.col(1), lvl) == (int)lvl );
+            if (wasActive)
+                renum[it++ - cmat.begin()] = isActive ? index_t(merged.size()) : -1;
+            if (isActive)
+                merged.push_back(*c);
+            ++c;
+        }
+        cmat.swap(merged);
+    }
+
+    // Compute offsets and shift the renumbering
+    for (size_t lvl = 0; lvl != oldLevels; ++lvl)
+    {
+        const size_t nOld = m_xmatrix_offset[lvl+1] - m_xmatrix_offset[lvl];
+        index_t * renum = renumbering.data() + m_xmatrix_offset[lvl];
+        index_t newOffset = 0;
+        for (size_t k = 0; k != lvl; ++k)
+            newOffset += m_xmatrix[k].size();
+        for (size_t i = 0; i != nOld; ++i)
+            if ( -1 != renum[i] )
+                renum[i] += newOffset;
+    }
+
+    m_xmatrix_offset.resize(nLevels+1);
+    m_xmatrix_offset[0] = 0;
+    for (size_t lvl = 0; lvl != nLevels; ++lvl)
+        m_xmatrix_offset[lvl+1] = m_xmatrix_offset[lvl] + m_xmatrix[lvl].size();
+}
+
+template<short_t d, class T>
+void gsHTensorBasis<d,T>::changedRegion(point const & k1, point const & k2, int lvl,
+                                        std::vector<index_t> & regions, bool sink) const
+{
+    if (m_manualLevels) return; // not used, see update_structure
+
+    // The tree splits the leaves aligned to their own cells, therefore
+    // the box is widened to the cells of the coarsest level it overlaps
+    const int cLevel = math::min(m_tree.query3(k1, k2, lvl), lvl);
+    const int s = lvl - cLevel;
+    // The box may extend beyond the domain (eg. refinement extension)
+    point dUpp;
+    m_tree.global2localIndex(m_tree.upperCorner(), cLevel, dUpp);
+    regions.push_back(cLevel);
+    for( short_t j = 0; j < d; j++ )
+        regions.push_back( math::min(k1[j] >> s, dUpp[j]) );
+    for( short_t j = 0; j < d; j++ )
+        regions.push_back( math::min(( k2[j] + (1 << s) - 1 ) >> s, dUpp[j]) );
+    // Inserting a box of level lvl leaves the finer levels unchanged,
+    // whereas sinking raises all levels inside the box
+    regions.push_back( sink ? -1 : lvl );
+}
+
+template<short_t d, class T>
+void gsHTensorBasis<d,T>::functionsOverlappingBoxes(std::vector<index_t> const & boxes,
+                                                    std::vector<CMatrix> & result) const
+{
+    GISMO_ASSERT( (boxes.size()%(2*d + 2))==0,
+                  "The points did not define regions properly.");
+    const int nLevels = m_tree.getMaxInsLevel()+1;
+    result.clear();
+    result.resize(nLevels);
+
+    point low, upp, curr, actUpp;
+    for(size_t i = 0; i < (boxes.size())/(2*d+2); i++)
+    {
+        const index_t * box = boxes.data() + i*(2*d+2);
+        const int bLevel = box[0];
+        const int maxLevel = -1 == box[2*d+1] ? nLevels
+                           : math::min<int>(box[2*d+1] + 1, nLevels);
+        for (int lvl = 0; lvl != maxLevel; ++lvl)
+        {
+            // The box in the index space of level lvl (covering it if coarser)
+            for( short_t j = 0; j < d; j++ )
+            {
+                if (lvl < bLevel)
+                {
+                    const int s = bLevel - lvl;
+                    low[j] = box[j+1] >> s;
+                    upp[j] = ( box[d+j+1] + (1 << s) - 1 ) >> s;
+                }
+                else
+                {
+                    low[j] = box[j+1]   << (lvl - bLevel);
+                    upp[j] = box[d+j+1] << (lvl - bLevel);
+                }
+            }
+
+            functionOverlap(low, upp, lvl, curr, actUpp);
+            CMatrix & res = result[lvl];
+            do
+            {
+                res.push_unsorted( m_bases[lvl]->index(curr) );
+            }
+            while( nextCubePoint(curr, actUpp) );
+        }
+    }
+
+    for (int lvl = 0; lvl != nLevels; ++lvl)
+    {
+        result[lvl].sort();
+        result[lvl].erase( std::unique( result[lvl].begin(), result[lvl].end() ),
+                           result[lvl].end() );
+    }
+}
+
 template<short_t d, class T>
 void gsHTensorBasis<d,T>::needLevel(int maxLevel) const
 {
@@ -124,9 +124,22 @@ public:
     /// @brief Gives back the basis at a slice in \a dir_fixed at \a par
     BoundaryBasisType * basisSlice(index_t dir_fixed,T par ) const;
 
+    /// Number of points above which active_into() uses several
+    /// threads; the points of single elements are processed serially
+    static const index_t parallelActivePoints = 1024;
+
     // Look at gsBasis class for documentation
     void active_into(const gsMatrix<T>& u, gsMatrix<index_t>& result) const;
 
+    /// @brief Evaluates the basis functions and their derivatives up
+    /// to order \a n (at most 2) at the points \a u, see gsBasis.
+    ///
+    /// The tensor basis of every level involved is evaluated once at
+    /// all points, and the truncated functions are obtained from these
+    /// values through their sparse representation.
+    void evalAllDers_into(const gsMatrix<T> & u, int n,
+                          std::vector<gsMatrix<T> >& result) const;
+
     // Look at gsBasis class for documentation
     void deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const;
 
@@ -412,6 +425,28 @@ private:
     /// @brief Computes and saves representation of all basis functions.
     void representBasis(); // rename: precompute coeffs
 
+    /// @brief Updates the representations after a local refinement:
+    /// the representations of the functions in \a changed (tensor
+    /// indices per level) are recomputed, the others are moved to their
+    /// new index according to \a renumbering.
+    void representBasis(std::vector<CMatrix> const & changed,
+                        std::vector<index_t> const & renumbering);
+
+    /// @brief Computes and saves the representation of the j-th basis function.
+    void _representBasisFunction(const index_t j);
+
+    /// @brief Computes the level of the point \a u.col(p) and its
+    /// cell on that level (or on the finest level, if the levels are
+    /// set manually), used by active_into().
+    void _cellOfPoint(const gsMatrix<T>& u, const index_t p,
+                      int & level, point & cell) const;
+
+    /// @brief Appends the active functions at the point \a currPoint of
+    /// level \a level to \a actives, \a ind is a workspace.
+    void _activeAtPoint(const gsMatrix<T>& currPoint, const int level,
+                        std::vector<index_t> & actives,
+                        gsMatrix<index_t> & ind) const;
+
 
     /// @brief Computes representation of j-th basis function on pres_level and
     /// saves it.
@@ -619,6 +654,17 @@ private:
         representBasis();
     }
 
+    /**
+     * @brief Updates the characteristic matrices and the
+     * representations of the functions in \a changed only.
+    **/
+    void update_structure_local(std::vector<CMatrix> const & changed,
+                                std::vector<index_t> & renumbering)
+    {
+        gsHTensorBasis<d,T>::update_structure_local(changed, renumbering);
+        representBasis(changed, renumbering);
+    }
+
     /**
       @brief Returns a representation of \a thbCoefs as tensor-product
       B-spline coefficientes \a lvlCoefs at level \a level.
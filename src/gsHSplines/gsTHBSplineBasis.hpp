@@ -98,43 +98,83 @@ void gsTHBSplineBasis<d,T>::representBasis()
     this->m_is_truncated.resize(this->size());
     m_presentation.clear();
 
-    gsMatrix<index_t, d, 2> element_ind(d, 2);
-    gsVector<index_t, d   > low, high;
     for (index_t j = 0; j < this->size(); ++j)
-    {
-        index_t level = this->levelOf(j);
-        index_t tensor_index = this->flatTensorIndexOf(j, level);
+        _representBasisFunction(j);
+}
 
-        // element indices
-        this->m_bases[level]->elementSupport_into(tensor_index, element_ind);
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::representBasis(std::vector<CMatrix> const & changed,
+                                           std::vector<index_t> const & renumbering)
+{
+    // Move the data of the kept functions to their new indices; the
+    // renumbering preserves the order, so the map is filled at its end
+    gsVector<int> oldTruncated;
+    oldTruncated.swap(this->m_is_truncated);
+    std::map<index_t, gsSparseVector<T> > oldPresentation;
+    oldPresentation.swap(m_presentation);
 
-        // I tried with block, I can not trick the compiler to use references
-        low = element_ind.col(0); //block<d, 1>(0, 0);
-        high = element_ind.col(1); //block<d, 1>(0, 1);
-        if (m_manualLevels)
+    this->m_is_truncated.resize(this->size());
+    for (size_t i = 0; i != renumbering.size(); ++i)
+        if ( -1 != renumbering[i] )
+            this->m_is_truncated[renumbering[i]] = oldTruncated[i];
+
+    for (typename std::map<index_t, gsSparseVector<T> >::iterator
+             it = oldPresentation.begin(); it != oldPresentation.end(); ++it)
+        if ( -1 != renumbering[it->first] )
+            m_presentation.insert(m_presentation.end(),
+                                  std::make_pair(renumbering[it->first], give(it->second)));
+
+    // Recompute the functions with changed support (incl. new ones)
+    for (size_t lvl = 0; lvl != changed.size(); ++lvl)
+        for (cmatIterator it = changed[lvl].begin(); it != changed[lvl].end(); ++it)
         {
-            this->_knotIndexToDiadicIndex(level,low);
-            this->_knotIndexToDiadicIndex(level,high);
+            const index_t j = this->flatTensorIndexToHierachicalIndex(*it, lvl);
+            if ( -1 != j )
+            {
+                m_presentation.erase(j);
+                _representBasisFunction(j);
+            }
         }
+}
 
-        // Finds coarsest level that function, with supports given with
-        // support indices of the coarsest level (low & high), has presentation
-        // based only on B-Splines (and not THB-Splines).
-        // this is not the same as query 3
-        index_t clevel = this->m_tree.query4(low, high, level);
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::_representBasisFunction(const index_t j)
+{
+    gsMatrix<index_t, d, 2> element_ind(d, 2);
+    gsVector<index_t, d   > low, high;
 
-        if (level != clevel) // we must compute its presentation
-        {
-            this->m_tree.computeFinestIndex(low, level, low);
-            this->m_tree.computeFinestIndex(high, level, high);
+    index_t level = this->levelOf(j);
+    index_t tensor_index = this->flatTensorIndexOf(j, level);
 
-            this->m_is_truncated[j] = clevel;
-            _representBasisFunction(j, clevel, low, high);
-        }
-        else
-        {
-            this->m_is_truncated[j] = -1;
-        }
+    // element indices
+    this->m_bases[level]->elementSupport_into(tensor_index, element_ind);
+
+    // I tried with block, I can not trick the compiler to use references
+    low = element_ind.col(0); //block<d, 1>(0, 0);
+    high = element_ind.col(1); //block<d, 1>(0, 1);
+    if (m_manualLevels)
+    {
+        this->_knotIndexToDiadicIndex(level,low);
+        this->_knotIndexToDiadicIndex(level,high);
+    }
+
+    // Finds coarsest level that function, with supports given with
+    // support indices of the coarsest level (low & high), has presentation
+    // based only on B-Splines (and not THB-Splines).
+    // this is not the same as query 3
+    index_t clevel = this->m_tree.query4(low, high, level);
+
+    if (level != clevel) // we must compute its presentation
+    {
+        this->m_tree.computeFinestIndex(low, level, low);
+        this->m_tree.computeFinestIndex(high, level, high);
+
+        this->m_is_truncated[j] = clevel;
+        _representBasisFunction(j, clevel, low, high);
+    }
+    else
+    {
+        this->m_is_truncated[j] = -1;
     }
 }
 
@@ -1079,79 +1119,142 @@ void gsTHBSplineBasis<d,T>::globalRefinement(const gsMatrix<T> & thbCoefs,
 
 
 template<short_t d, class T>
-void gsTHBSplineBasis<d,T>::active_into(const gsMatrix<T>& u, gsMatrix<index_t>& result) const
+void gsTHBSplineBasis<d,T>::_cellOfPoint(const gsMatrix<T>& u, const index_t p,
+                                         int & level, point & cell) const
 {
-    gsMatrix<T> currPoint;
-    gsMatrix<index_t> ind;
-    point low, upp, cur;
     const int maxLevel = this->m_tree.getMaxInsLevel();
+    for(short_t i = 0; i != d; ++i)
+        cell[i] = m_bases[maxLevel]->knots(i).uFind( u(i,p) ).uIndex();
 
-    std::vector<std::vector<index_t> > temp_output;//collects the outputs
-    temp_output.resize( u.cols() );
-    size_t sz = 0;
+    if (m_manualLevels)
+        this->_knotIndexToDiadicIndex(maxLevel,cell);
 
-    for(index_t p = 0; p < u.cols(); p++) //for all input points
-    {
-        currPoint = u.col(p); 
-        for(short_t i = 0; i != d; ++i)
-            low[i] = m_bases[maxLevel]->knots(i).uFind( currPoint(i,0) ).uIndex();
+    // Identify the level of the point
+    level = std::min(this->m_tree.levelOf(cell, maxLevel),(int) m_xmatrix.size()-1);
 
-        if (m_manualLevels)
-            this->_knotIndexToDiadicIndex(maxLevel,low);
-
-        // Identify the level of the point
-        const int lvl = std::min(this->m_tree.levelOf(low, maxLevel),(int) m_xmatrix.size()-1);
+    // With manual levels the cells of a level are not dyadic,
+    // then the cell of the finest level is used
+    if (!m_manualLevels)
+        for(short_t i = 0; i != d; ++i)
+            cell[i] >>= (maxLevel - level);
+}
 
-        for(int i = 0; i <= lvl; i++)
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::_activeAtPoint(const gsMatrix<T>& currPoint, const int level,
+                                           std::vector<index_t> & actives,
+                                           gsMatrix<index_t> & ind) const
+{
+    point low, upp, cur;
+    for(int i = 0; i <= level; i++)
+    {
+        m_bases[i]->active_cwise(currPoint, low, upp);
+        cur = low;
+        do
         {
-            m_bases[i]->active_cwise(currPoint, low, upp);
-            cur = low;
-            do
+            typename CMatrix::const_iterator it =
+                m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+
+            if( it != m_xmatrix[i].end() )// if index is found
             {
-                typename CMatrix::const_iterator it =
-                    m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+                const index_t act = this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin());
 
-                if( it != m_xmatrix[i].end() )// if index is found
+                if (this->m_is_truncated[act] == -1)
                 {
-                    const index_t act = this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin());
-
-                    if (this->m_is_truncated[act] == -1) 
-                    {
-                        temp_output[p].push_back(act);
-                    }
-                    else 
-                    {
-                        const gsSparseVector<T>& coefs = getCoefs(act);
-                        const gsTensorBSplineBasis<d, T>& base =
-                            *this->m_bases[this->m_is_truncated[act]];
+                    actives.push_back(act);
+                }
+                else
+                {
+                    const gsSparseVector<T>& coefs = getCoefs(act);
+                    const gsTensorBSplineBasis<d, T>& base =
+                        *this->m_bases[this->m_is_truncated[act]];
 
-                        base.active_into(currPoint, ind);
+                    base.active_into(currPoint, ind);
 
-                        for (index_t k = 0; k < ind.rows(); ++k) 
+                    for (index_t k = 0; k < ind.rows(); ++k)
+                    {
+                        if (coefs(ind.at(k)) != 0)
                         {
-                            if (coefs(ind.at(k)) != 0)
-                            {
-                                temp_output[p].push_back(act);
-                                break;
-                            }
+                            actives.push_back(act);
+                            break;
                         }
                     }
                 }
             }
-            while( nextCubePoint(cur,low,upp) );
         }
+        while( nextCubePoint(cur,low,upp) );
+    }
+}
 
-        // update result size
-        if ( temp_output[p].size() > sz )
-            sz = temp_output[p].size();
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::active_into(const gsMatrix<T>& u, gsMatrix<index_t>& result) const
+{
+    const index_t nPts = u.cols();
+    const bool parallel = nPts > parallelActivePoints;
+
+    // The level of every point and its cell on that level. The
+    // active functions are the same for all points in a cell, eg. for
+    // the quadrature nodes of an element.
+    std::vector<int> level(nPts);
+    gsMatrix<index_t> cell(d, nPts);
+    point pCell;
+    if (parallel)
+    {
+#       pragma omp parallel for firstprivate(pCell)
+        for(index_t p = 0; p < nPts; p++)
+        {
+            _cellOfPoint(u, p, level[p], pCell);
+            for(short_t i = 0; i != d; ++i) // component-wise, avoids a false -Warray-bounds of GCC 12
+                cell(i,p) = pCell[i];
+        }
     }
+    else
+    {
+        for(index_t p = 0; p < nPts; p++)
+        {
+            _cellOfPoint(u, p, level[p], pCell);
+            for(short_t i = 0; i != d; ++i) // component-wise, avoids a false -Warray-bounds of GCC 12
+                cell(i,p) = pCell[i];
+        }
+    }
+
+    // Consecutive points in the same cell form a group
+    std::vector<index_t> first;
+    for(index_t p = 0; p < nPts; p++)
+        if ( 0 == p || level[p] != level[p-1] || cell.col(p) != cell.col(p-1) )
+            first.push_back(p);
+    const index_t nGroups = first.size();
+    first.push_back(nPts);
 
-    result.resize(sz, u.cols() );
-    for(index_t i = 0; i < result.cols(); i++)
+    // The active functions of the first point of every group
+    std::vector<std::vector<index_t> > temp_output(nGroups);//collects the outputs
+    gsMatrix<index_t> ind;
+    if (parallel)
     {
-        result.col(i).topRows(temp_output[i].size())
-            = gsAsConstVector<index_t>(temp_output[i]);
-        result.col(i).bottomRows(sz-temp_output[i].size()).setZero();
+#       pragma omp parallel for firstprivate(ind) schedule(dynamic, 64)
+        for(index_t g = 0; g < nGroups; g++)
+            _activeAtPoint(u.col(first[g]), level[first[g]], temp_output[g], ind);
+    }
+    else
+    {
+        for(index_t g = 0; g < nGroups; g++)
+            _activeAtPoint(u.col(first[g]), level[first[g]], temp_output[g], ind);
+    }
+
+    // result size
+    size_t sz = 0;
+    for(index_t g = 0; g < nGroups; g++)
+        sz = std::max(sz, temp_output[g].size());
+
+    result.resize(sz, nPts );
+    for(index_t g = 0; g < nGroups; g++)
+    {
+        const std::vector<index_t> & actives = temp_output[g];
+        for(index_t i = first[g]; i < first[g+1]; i++)
+        {
+            result.col(i).topRows(actives.size())
+                = gsAsConstVector<index_t>(actives);
+            result.col(i).bottomRows(sz-actives.size()).setZero();
+        }
     }
 }
 
@@ -1206,79 +1309,145 @@ void gsTHBSplineBasis<d,T>::deriv2Single_into(index_t i,
 }
 
 template<short_t d, class T>
-void gsTHBSplineBasis<d,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+void gsTHBSplineBasis<d,T>::evalAllDers_into(const gsMatrix<T> & u, int n,
+                                             std::vector<gsMatrix<T> >& result) const
 {
+    if (n < 0) { result.clear(); return; }
+    if (n > 2)
+        GISMO_ERROR("evalAllDers implemented for order up to 2<"<<n<< " for "<<*this);
+
     gsMatrix<index_t> indices;
-    gsMatrix<T> res(1, 1);
     this->active_into(u, indices);
 
-    result.setZero(indices.rows(), u.cols());
-
-    for (index_t i = 0; i < indices.cols(); i++)
-    {
-        for (index_t j = 0; j < indices.rows(); j++)
+    // number of derivatives of order k per basis function
+    const index_t nd[3] = {1, d, (d * (d + 1)) / 2};
+    result.resize(n + 1);
+    for (int k = 0; k <= n; ++k)
+        result[k].setZero(indices.rows() * nd[k], u.cols());
+
+    // Levels of the tensor bases needed for the active functions
+    const size_t nLvl = this->m_bases.size();
+    std::vector<bool> needed(nLvl, false);
+    for (index_t pt = 0; pt != indices.cols(); ++pt)
+        for (index_t j = 0; j != indices.rows(); ++j)
         {
-            const index_t index = indices(j, i);
+            const index_t index = indices(j, pt);
             if (j != 0 && index == 0)
                 break;
-
-            evalSingle_into(index, u.col(i), res);
-            result(j, i) = res.value();
+            needed[getPresLevelOfBasisFun(index)] = true;
         }
-    }
-}
-
 
-template<short_t d, class T>
-void gsTHBSplineBasis<d,T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const
-{
-    gsMatrix<index_t> indices;
-    this->active_into(u, indices);
-
-    static const short_t numDers = (d * (d + 1)) / 2;
-    gsMatrix<T> res(numDers, 1); // result of deriv2Single_into
-
-    result.setZero(indices.rows() * numDers, u.cols());
+    // Evaluate each needed level once for all points
+    std::vector< std::vector<gsMatrix<T> > > ders(nLvl);
+    std::vector< gsMatrix<index_t> > act(nLvl);
+    std::vector< gsVector<index_t, d> > stride(nLvl);
+    for (size_t lvl = 0; lvl != nLvl; ++lvl)
+    {
+        if (!needed[lvl]) continue;
+        this->m_bases[lvl]->evalAllDers_into(u, n, ders[lvl]);
+        this->m_bases[lvl]->active_into(u, act[lvl]);
+        // the active functions of a level form a box with
+        // degree+1 functions per direction, first direction fastest
+        stride[lvl][0] = 1;
+        for (short_t k = 1; k != d; ++k)
+            stride[lvl][k] = stride[lvl][k - 1] * (this->m_bases[lvl]->degree(k - 1) + 1);
+    }
 
-    for (int i = 0; i < indices.cols(); i++)
+    // Points of the same element have the same active functions, and
+    // they are processed together. A function can be presented on a
+    // finer level, where the points lie in a few different cells; its
+    // (sparse) coefficients on the active functions of such a cell are
+    // gathered only once.
+    std::vector<index_t> keys;
+    std::vector< std::vector<std::pair<index_t,T> > > weights;
+    for (index_t pt = 0, np; pt != indices.cols(); pt += np)
     {
-        for (int j = 0; j < indices.rows(); j++)
+        for (np = 1; pt + np != indices.cols() &&
+                 indices.col(pt + np) == indices.col(pt); ++np) ;
+
+        for (index_t j = 0; j != indices.rows(); ++j)
         {
-            const index_t index = indices(j, i);
+            const index_t index = indices(j, pt);
             if (j != 0 && index == 0)
                 break;
 
-            this->deriv2Single_into(index, u.col(i), res);
+            const unsigned lvl = getPresLevelOfBasisFun(index);
+            const gsMatrix<index_t> & lvlAct = act[lvl];
+            const std::vector<gsMatrix<T> > & lvlDers = ders[lvl];
+            const bool truncated = (m_is_truncated[index] != -1);
 
-            result.template block<numDers, 1>(j * numDers, i) = res;
+            keys.clear();
+            for (index_t q = pt; q != pt + np; ++q)
+            {
+                // the first active function identifies the cell on level lvl
+                const index_t key = lvlAct(0, q);
+                size_t c = std::find(keys.begin(), keys.end(), key) - keys.begin();
+                if (c == keys.size())
+                {
+                    keys.push_back(key);
+                    if (weights.size() < keys.size())
+                        weights.resize(keys.size());
+                    std::vector<std::pair<index_t,T> > & wc = weights[c];
+                    wc.clear();
+                    if (truncated)
+                    {
+                        const gsSparseVector<T> & coefs = getCoefs(index);
+                        for (index_t i = 0; i != lvlAct.rows(); ++i)
+                        {
+                            const T w = coefs.coeff(lvlAct(i, q));
+                            if (0 != w)
+                                wc.push_back(std::make_pair(i, w));
+                        }
+                    }
+                    else // position of the function in the active box of its level
+                    {
+                        const gsTensorBSplineBasis<d, T> & base = *this->m_bases[lvl];
+                        wc.push_back(std::make_pair(
+                            ( base.tensorIndex(this->flatTensorIndexOf(index, lvl))
+                              - base.tensorIndex(key) ).dot(stride[lvl]), (T)(1)));
+                    }
+                }
+
+                const std::vector<std::pair<index_t,T> > & wc = weights[c];
+                for (int k = 0; k <= n; ++k)
+                {
+                    T * res = result[k].col(q).data() + j * nd[k];
+                    for (size_t i = 0; i != wc.size(); ++i)
+                    {
+                        const T * val = lvlDers[k].col(q).data() + wc[i].first * nd[k];
+                        for (index_t r = 0; r != nd[k]; ++r)
+                            res[r] += wc[i].second * val[r];
+                    }
+                }
+            }
         }
     }
 }
 
-
 template<short_t d, class T>
-void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+void gsTHBSplineBasis<d,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
 {
+    std::vector<gsMatrix<T> > ders;
+    this->evalAllDers_into(u, 0, ders);
+    result.swap(ders[0]);
+}
 
-    gsMatrix<index_t> indices;
-    this->active_into(u, indices);
-    gsMatrix<T> res(d, 1);
-
-    result.setZero(indices.rows() * d, u.cols());
 
-    for (int i = 0; i < indices.cols(); i++)
-    {
-        for (int j = 0; j < indices.rows(); j++)
-        {
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const
+{
+    std::vector<gsMatrix<T> > ders;
+    this->evalAllDers_into(u, 2, ders);
+    result.swap(ders[2]);
+}
 
-            const unsigned index = indices(j, i);
-            if (j != 0 && index == 0)
-                break;
 
-            this->derivSingle_into(index, u.col(i), res);
-            result.template block<d,1>(j * d, i) = res;
-        }
-    }
+template<short_t d, class T>
+void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+{
+    std::vector<gsMatrix<T> > ders;
+    this->evalAllDers_into(u, 1, ders);
+    result.swap(ders[1]);
 }
 
 
@@ -100,6 +100,17 @@ public:
     /// to a 64-bit double.
     unsigned getFloatPrecision() const { return data->getFloatPrecision(); }
 
+    /// Set the encoding of the numeric data (coefficients, matrices,
+    /// sparse matrices and knot vectors) of objects added afterwards:
+    /// "ascii" (default), "base64" (binary data, encoded in base64)
+    /// or "zlib" (compressed binary data, encoded in base64). Files
+    /// are read in all encodings transparently.
+    void setEncoding(String const & enc) { data->setEncoding(enc); }
+
+    /// Returns the encoding of the numeric data of objects added to
+    /// the file data, see setEncoding()
+    const String & getEncoding() const { return data->getEncoding(); }
+
 private:
     /// File data as an xml tree
     FileData * data;
@@ -14,6 +14,10 @@
 #include<gsIO/gsParaviewDataSet.h>
 #include<gsIO/gsWriteParaview.h>
 
+#ifdef GISMO_ZLIB_STATIC
+#define Z_PREFIX // the bundled zlib has prefixed symbols
+#endif
+#include <zlib/zlib.h>
 
 
 namespace gismo
@@ -29,9 +33,13 @@ namespace gismo
                     m_isSaved(false)
     {
         unsigned nPts = m_options.askInt("numPoints",1000);
+        const std::string format = m_options.askString("format","ascii");
+        GISMO_ENSURE( "ascii"==format || "binary"==format || "compressed"==format,
+                      "Unknown VTK data format "<< format <<", use ascii, binary or compressed.");
 
         // QUESTION: Can I be certain that the ids are consecutive?
         initFilenames();
+        m_appended.resize(m_filenames.size());
         for ( index_t k=0; k!=m_geometry->nPieces(); k++) // For every patch.
         {
             gsMatrix<real_t> activeBases = m_geometry->piece(k).support();
@@ -47,7 +55,7 @@ namespace gismo
             file << std::fixed; // no exponents
             file << std::setprecision(5); // PLOT_PRECISION
             file <<"<?xml version=\"1.0\"?>\n";
-            file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+            file << vtkFileHeader("StructuredGrid", format);
             file <<"<StructuredGrid WholeExtent=\"0 "<< np(0)-1<<" 0 "<< np1 <<" 0 "
                 << np2 <<"\">\n";
             file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np1<<" 0 "
@@ -81,10 +89,18 @@ namespace gismo
             for ( index_t k=0; k!=m_geometry->nPieces(); k++) // For every patch.
             {
                 std::ofstream file;
-                file.open(m_filenames[k].c_str(), std::ios_base::app); // Append to file 
+                file.open(m_filenames[k].c_str(), std::ios_base::app | std::ios_base::binary); // Append to file 
                 file <<"</PointData>\n\n\n<!-- GEOMETRY -->\n<Points>\n";
                 file << points[k];
-                file << "</Points>\n</Piece>\n</StructuredGrid>\n</VTKFile>";
+                file << "</Points>\n</Piece>\n</StructuredGrid>\n";
+                if ( !m_appended[k].empty() )
+                {
+                    file << "<AppendedData encoding=\"raw\">\n_";
+                    file.write(m_appended[k].data(), m_appended[k].size());
+                    file << "\n</AppendedData>\n";
+                    std::string().swap(m_appended[k]); // release the memory
+                }
+                file << "</VTKFile>";
                 file.close();
                 if (plotControlNet)
                 {
@@ -113,6 +129,70 @@ namespace gismo
         }
     }
 
+    size_t gsParaviewDataSet::appendData(index_t patch, const char * data, size_t nBytes)
+    {
+        return appendBlock(m_appended[patch], data, nBytes,
+                           "compressed" == m_options.askString("format","ascii"));
+    }
+
+    std::string gsParaviewDataSet::vtkFileHeader(const std::string & type, const std::string & format)
+    {
+        if ( "ascii" == format )
+            return "<VTKFile type=\"" + type + "\" version=\"0.1\">\n";
+
+        const int one = 1;
+        std::string tag = "<VTKFile type=\"" + type + "\" version=\"1.0\" byte_order=\"";
+        tag += ( 1 == *reinterpret_cast<const char*>(&one) ? "LittleEndian" : "BigEndian" );
+        tag += "\" header_type=\"UInt64\"";
+        if ( "compressed" == format )
+            tag += " compressor=\"vtkZLibDataCompressor\"";
+        return tag + ">\n";
+    }
+
+    size_t gsParaviewDataSet::appendBlock(std::string & out, const char * data, size_t nBytes, bool compress)
+    {
+        const size_t offset = out.size();
+
+        if ( !compress )
+        {
+            // Header: number of bytes
+            const uint64_t header = nBytes;
+            out.append(reinterpret_cast<const char*>(&header), sizeof(uint64_t));
+            out.append(data, nBytes);
+            return offset;
+        }
+
+        // Header: number of blocks, block size, size of the last
+        // block (zero if full) and sizes of the compressed blocks
+        const size_t blockSize = 1<<15;
+        const index_t nBlocks = static_cast<index_t>( (nBytes + blockSize - 1) / blockSize );
+        std::vector<uint64_t> header(3 + nBlocks);
+        header[0] = nBlocks;
+        header[1] = blockSize;
+        header[2] = nBytes % blockSize;
+
+        // The blocks are compressed independently of each other
+        std::vector<std::vector<Bytef> > blocks(nBlocks);
+        bool ok = true;
+#       pragma omp parallel for schedule(dynamic) reduction(&&:ok)
+        for (index_t b = 0; b < nBlocks; ++b)
+        {
+            const uLong len = static_cast<uLong>( std::min(blockSize, nBytes - b*blockSize) );
+            uLongf clen = compressBound(len);
+            blocks[b].resize(clen);
+            ok = ok && Z_OK == compress2(blocks[b].data(), &clen,
+                                         reinterpret_cast<const Bytef*>(data) + b*blockSize,
+                                         len, Z_DEFAULT_COMPRESSION);
+            header[3+b] = clen;
+        }
+        GISMO_ENSURE(ok, "Compression of the VTK data failed.");
+
+        out.append(reinterpret_cast<const char*>(header.data()), header.size()*sizeof(uint64_t));
+        for (index_t b = 0; b < nBlocks; ++b)
+            out.append(reinterpret_cast<const char*>(blocks[b].data()), header[3+b]);
+        return offset;
+    }
+
     bool gsParaviewDataSet::isEmpty()
     {
         return ! static_cast<bool>(m_geometry);
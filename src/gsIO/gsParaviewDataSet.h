@@ -41,6 +41,7 @@ private:
     gsExprEvaluator<real_t> * m_evaltr;
     gsOptionList m_options;
     bool m_isSaved;
+    std::vector<std::string> m_appended; // raw data of every patch file (binary formats)
     
 public:
     /// @brief Basic constructor
@@ -176,11 +177,22 @@ public:
         opt.addString("subfolder","Name of subfolder where the vtk files will be stored.", "");
         opt.addSwitch("plotElements", "Controls plotting of element mesh.", false);
         opt.addSwitch("plotControlNet", "Controls plotting of control point grid.", false);
+        opt.addString("format", "Format of the data arrays: ascii, binary (raw appended data) or compressed (zlib-compressed appended data).", "ascii");
         return opt;
     }
 
     gsOptionList & options() {return m_options;}
 
+    /// @brief Returns the opening <VTKFile> tag of a file of the given \a type
+    /// (eg. "StructuredGrid") with data arrays in the given \a format
+    /// (ascii, binary or compressed).
+    static std::string vtkFileHeader(const std::string & type, const std::string & format);
+
+    /// @brief Appends \a nBytes of raw data to the appended data \a out
+    /// of a VTK file, as a block with header (UInt64), zlib-compressed
+    /// if \a compress is true. Returns the offset of the block.
+    static size_t appendBlock(std::string & out, const char * data, size_t nBytes, bool compress);
+
 private:
     /// @brief  Evaluates gsFunctionSet over all pieces( patches ) and returns all <DataArray> xml tags as a vector of strings
     /// @tparam T 
@@ -189,53 +201,41 @@ private:
     /// @param precision Number of decimal points in xml output
     /// @return Vector of strings of all <DataArrays>
     template< class T>
-    static std::vector<std::string> toVTK(const gsFunctionSet<T> & funSet, unsigned nPts=1000, unsigned precision=5, std::string label="")
+    std::vector<std::string> toVTK(const gsFunctionSet<T> & funSet, unsigned nPts=1000, unsigned precision=5, std::string label="")
     {   
         std::vector<std::string> out;
-        gsMatrix<T> evalPoint, xyzPoints;
+        gsMatrix<T> xyzPoints;
 
         // Loop over all patches
         for ( index_t i=0; i != funSet.nPieces(); ++i )
         {
-            gsGridIterator<T,CUBE> grid(funSet.piece(i).support(), nPts);
-
-            // Evaluate the MultiPatch for every parametric point of the grid iterator
-            xyzPoints.resize( funSet.targetDim(), grid.numPoints() );
-            index_t col = 0;
-            for( grid.reset(); grid; ++grid )
-            {
-                evalPoint = *grid; // ..
-                xyzPoints.col(col) =  funSet.piece(i).eval(evalPoint);
-                col++;
-            }
+            const gsFunctionSet<T> & piece = funSet.piece(i);
+            evalOnGrid(piece.support(), nPts,
+                       [&piece](const gsMatrix<T> & u) { return piece.eval(u); },
+                       xyzPoints);
 
-            out.push_back( toDataArray(xyzPoints, label, precision)  );
+            out.push_back( toDataArray(i, xyzPoints, label, precision)  );
         }
         return out; 
     }
 
     template< class T>
-    static std::vector<std::string> toVTK(const gsField<T> & field, unsigned nPts=1000, unsigned precision=5, std::string label="")
+    std::vector<std::string> toVTK(const gsField<T> & field, unsigned nPts=1000, unsigned precision=5, std::string label="")
     {   
         std::vector<std::string> out;
-        gsMatrix<T> evalPoint, xyzPoints;
+        gsMatrix<T> vals;
 
         // Loop over all patches
         for ( index_t i=0; i != field.nPieces(); ++i )
         {
-            gsGridIterator<T,CUBE> grid(field.fields().piece(i).support(), nPts);
-
-            // Evaluate the MultiPatch for every parametric point of the grid iterator
-            xyzPoints.resize( field.dim(), grid.numPoints());
-            index_t col = 0;
-            for( grid.reset(); grid; ++grid )
-            {
-                evalPoint = *grid; // ..
-                xyzPoints.col(col) =  field.value(evalPoint, i);
-                col++;
-            }
-
-            out.push_back( toDataArray(xyzPoints, label, precision)  );
+            // Sample the parameter domain of the patch, also for fields
+            // which are given in physical coordinates
+            evalOnGrid(field.isParametrized() ? field.fields().piece(i).support()
+                                              : field.patch(i).support(), nPts,
+                       [&field, i](const gsMatrix<T> & u) { return field.value(u, i); },
+                       vals);
+
+            out.push_back( toDataArray(i, vals, label, precision)  );
         }
         return out; 
     }
@@ -252,9 +252,6 @@ private:
                                             std::string label="SolutionField")
     {   
         std::vector<std::string> out;
-        std::stringstream dataArray;
-        dataArray.setf( std::ios::fixed ); // write floating point values in fixed-point notation.
-        dataArray.precision(precision);
         // m_exprdata->parse(expr);
 
         //if false, embed topology ?
@@ -270,58 +267,95 @@ private:
             
             vals = m_evaltr->allValues(m_evaltr->elementwise().size()/pt.numPoints(), pt.numPoints());
 
-            dataArray <<"<DataArray type=\"Float32\" Name=\""<< label <<"\" format=\"ascii\" NumberOfComponents=\""<< ( vals.rows()==1 ? 1 : 3) <<"\">\n";
-            if ( vals.rows()==1 )
-                for ( index_t j=0; j<vals.cols(); ++j)
-                    dataArray<< vals.at(j) <<" ";
-            else
-            {
-                for ( index_t j=0; j<vals.cols(); ++j)
-                {
-                    for ( index_t k=0; k!=vals.rows(); ++k)
-                        dataArray<< vals(k,j) <<" ";
-                    for ( index_t k=vals.rows(); k<3; ++k)
-                        dataArray<<"0 ";
-                }
-            }
-            dataArray <<"\n</DataArray>\n";
-            out.push_back( dataArray.str() );
-            dataArray.str(std::string()); // Clear the dataArray stringstream
+            out.push_back( toDataArray(i, vals, label, precision, vals.rows()==1 ? 1 : 3) );
         }
         return out; 
     }
 
+    /// @brief Evaluates a function on the uniform grid of (approximately) \a nPts points in the box \a ab.
+    ///
+    /// The grid points are split in blocks of whole grid lines, which are evaluated in parallel.
+    /// @param ab The box to be sampled, as returned by gsFunction::support()
+    /// @param nPts Number of evaluation points
+    /// @param eval Functor returning the values at the points given as columns of a matrix
+    /// @param result The values at all grid points, in the order of gsGridIterator
+    template<class T, class Evaluator>
+    static void evalOnGrid(const gsMatrix<T> & ab, unsigned nPts, const Evaluator & eval,
+                           gsMatrix<T> & result)
+    {
+        gsGridIterator<T,CUBE> grid(ab, nPts);
+        const gsMatrix<T> pts = grid.toMatrix();
+        const index_t np = pts.cols();
+        const index_t line = grid.numPointsCwise()[0];
+        const index_t bs = line * math::max(index_t(1), index_t(256) / line);
+        const index_t nb = (np + bs - 1) / bs;
+
+        std::vector<gsMatrix<T> > vals(nb);
+#       pragma omp parallel for schedule(dynamic)
+        for (index_t b = 0; b < nb; ++b)
+            vals[b] = eval( pts.middleCols(b*bs, math::min(bs, np - b*bs)) );
+
+        result.resize(vals.front().rows(), np);
+        for (index_t b = 0; b < nb; ++b)
+            result.middleCols(b*bs, vals[b].cols()) = vals[b];
+    }
 
     /// @brief Formats the coordinates of points as a <DataArray> xml tag for ParaView export.
+    ///
+    /// For the binary formats the values are stored in the appended data of the file of \a patch
+    /// and the returned tag only references them.
     /// @tparam T Arithmetic type
+    /// @param patch The index of the patch (i.e. of the .vts file) the data belongs to
     /// @param points A gsMatrix<T> with the coordinates of the points, stored column-wise. Its size is (numDims, numPoints)
     /// @param label A string with the label of the data
     /// @param precision Number of decimal points in xml output
+    /// @param nComp Minimum number of components of the data array, missing rows are filled with zeros
     /// @return The raw xml string 
     template<class T>
-    static std::string toDataArray(const gsMatrix<T> & points, const std::string label, unsigned precision)
+    std::string toDataArray(index_t patch, const gsMatrix<T> & points, const std::string label,
+                            unsigned precision, index_t nComp = 3)
     {
         std::stringstream stream;
         stream.setf( std::ios::fixed ); // write floating point values in fixed-point notation.
         stream.precision(precision); 
         // Format as vtk xml string
-        stream <<"<DataArray type=\"Float32\" format=\"ascii\" ";
+        const index_t nRows = points.rows();
+        nComp = math::max(nComp, nRows); // no component is dropped
+
+        stream <<"<DataArray type=\"Float32\" ";
         if ( "" != label )
             stream << "Name=\"" << label <<"\" ";
-        stream << "NumberOfComponents=\"3\">\n";
-        // For every point
-        for ( index_t j=0; j<points.cols(); ++j)
+        stream << "NumberOfComponents=\""<< nComp <<"\" ";
+
+        if ( "ascii" == m_options.askString("format","ascii") )
         {
-            for ( index_t i=0; i!=points.rows(); ++i)
-                stream<< points(i,j) <<" ";
-            for ( index_t i=points.rows(); i<3; ++i)
-                stream<<"0 ";
+            stream << "format=\"ascii\">\n";
+            // For every point
+            for ( index_t j=0; j<points.cols(); ++j)
+            {
+                for ( index_t i=0; i!=nRows; ++i)
+                    stream<< points(i,j) <<" ";
+                for ( index_t i=nRows; i<nComp; ++i)
+                    stream<<"0 ";
+            }
+            stream <<"\n</DataArray>\n";
+        }
+        else
+        {
+            gsMatrix<float> data = gsMatrix<float>::Zero(nComp, points.cols());
+            data.topRows(nRows) = points.template cast<float>();
+            stream << "format=\"appended\" offset=\""
+                   << appendData(patch, reinterpret_cast<const char*>(data.data()), data.size()*sizeof(float))
+                   << "\"/>\n";
         }
-        stream <<"\n</DataArray>\n";
 
         return stream.str();
     }
 
+    /// @brief Appends a block of raw data to the appended data of the file of \a patch,
+    /// compressing it if requested by the options. Returns the offset of the block.
+    size_t appendData(index_t patch, const char * data, size_t nBytes);
+
     void initFilenames();
 
 };
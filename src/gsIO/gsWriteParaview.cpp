@@ -21,6 +21,28 @@
 namespace gismo
 {
 
+namespace
+{
+// Format of the .vts files, see gsWriteParaviewSetFormat()
+std::string & vtsFormatSetting()
+{
+    static std::string format("ascii");
+    return format;
+}
+}
+
+void gsWriteParaviewSetFormat(std::string const & format)
+{
+    GISMO_ENSURE( "ascii"==format || "binary"==format || "compressed"==format,
+                  "Unknown VTK data format "<< format <<", use ascii, binary or compressed.");
+    vtsFormatSetting() = format;
+}
+
+std::string const & gsWriteParaviewFormat()
+{
+    return vtsFormatSetting();
+}
+
 template <class T>
 void plot_errors(const gsMatrix<T> & orig, 
                  const gsMatrix<T> & comp, const std::vector<T> & errors, 
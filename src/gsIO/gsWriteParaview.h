@@ -24,6 +24,27 @@
 
 namespace gismo {
 
+/// \brief Sets the format of the data arrays of the structured grid
+/// (.vts) files written by gsWriteParaview: "ascii" (default),
+/// "binary" (raw appended data) or "compressed" (zlib-compressed
+/// appended data), as the option "format" of gsParaviewDataSet.
+/// Meshes, control nets and point sets are always written as ascii.
+///
+/// \note The format is a process-wide setting, which is read once at
+/// the beginning of every file. It is not thread-safe: it must not be
+/// changed while other threads write ParaView files. Concurrent
+/// writers with different formats should use gsParaviewCollection
+/// and its option "format" instead.
+///
+/// \ingroup IO
+GISMO_EXPORT void gsWriteParaviewSetFormat(std::string const & format);
+
+/// \brief Returns the format of the data arrays of the structured
+/// grid files, see gsWriteParaviewSetFormat()
+///
+/// \ingroup IO
+GISMO_EXPORT std::string const & gsWriteParaviewFormat();
+
 
 /// \brief Export a gsGeometry (without scalar information) to paraview file
 ///
@@ -273,6 +273,36 @@ void writeSingleControlNet(const gsGeometry<T> & Geo,
     gsWriteParaview(msh, fn, false);
 }
 
+// Writes the first \a nComp rows of \a data (padded with zeros) as a
+// Float32 data array stored (compressed if \a compress is true) in the
+// appended data \a appended of a .vts file, see gsWriteParaviewSetFormat()
+template<class T>
+void writeVtsAppendedArray(std::ofstream & file, std::string & appended, bool compress,
+                           const gsMatrix<T> & data, index_t nComp,
+                           std::string const & name)
+{
+    const index_t nRows = math::min(nComp, static_cast<index_t>(data.rows()));
+    gsMatrix<float> vals = gsMatrix<float>::Zero(nComp, data.cols());
+    vals.topRows(nRows) = data.topRows(nRows).template cast<float>();
+
+    file <<"<DataArray type=\"Float32\" ";
+    if ( !name.empty() )
+        file <<"Name=\""<< name <<"\" ";
+    file <<"NumberOfComponents=\""<< nComp <<"\" format=\"appended\" offset=\""
+         << gsParaviewDataSet::appendBlock(appended, reinterpret_cast<const char*>(vals.data()),
+                                           vals.size()*sizeof(float), compress)
+         <<"\"/>\n";
+}
+
+// Writes the appended data of a .vts file (if any)
+inline void writeVtsAppendedData(std::ofstream & file, const std::string & appended)
+{
+    if ( appended.empty() ) return;
+    file <<"<AppendedData encoding=\"raw\">\n_";
+    file.write(appended.data(), appended.size());
+    file <<"\n</AppendedData>\n";
+}
+
 template<class T>
 void gsWriteParaviewTPgrid(const gsMatrix<T> & eval_geo  ,
                            const gsMatrix<T> & eval_field,
@@ -284,51 +314,70 @@ void gsWriteParaviewTPgrid(const gsMatrix<T> & eval_geo  ,
                  && static_cast<index_t>(np.prod())==eval_geo.cols(),
                  "Data do not match");
 
+    const std::string format = gsWriteParaviewFormat(); // read once per file
+    const bool ascii = ( "ascii" == format ), compress = ( "compressed" == format );
+    std::string appended; // binary formats
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), ascii ? std::ios_base::out
+                                          : std::ios_base::out | std::ios_base::binary);
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
 
     index_t np1 = (np.size()>1 ? np(1)-1 : 0);
     index_t np2 = (np.size()>2 ? np(2)-1 : 0);
-    
+
+    // Scalar or vector valued, all components are written
+    const index_t nf = ( eval_field.rows()==1 ? 1 : math::max<index_t>(3, eval_field.rows()) );
+
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file << gsParaviewDataSet::vtkFileHeader("StructuredGrid", format);
     file <<"<StructuredGrid WholeExtent=\"0 "<< np(0)-1<<" 0 "<< np1 <<" 0 "
          << np2 <<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np1<<" 0 "
          << np2 <<"\">\n";
     file <<"<PointData "<< ( eval_field.rows()==1 ?"Scalars":"Vectors")<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< ( eval_field.rows()==1 ? 1 : 3) <<"\">\n";
-    if ( eval_field.rows()==1 )
-        for ( index_t j=0; j<eval_field.cols(); ++j)
-            file<< eval_field.at(j) <<" ";
-    else
+    if ( ascii )
     {
-        for ( index_t j=0; j<eval_field.cols(); ++j)
+        file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< nf <<"\">\n";
+        if ( eval_field.rows()==1 )
+            for ( index_t j=0; j<eval_field.cols(); ++j)
+                file<< eval_field.at(j) <<" ";
+        else
         {
-            for ( index_t i=0; i!=eval_field.rows(); ++i)
-                file<< eval_field(i,j) <<" ";
-            for ( index_t i=eval_field.rows(); i<3; ++i)
-                file<<"0 ";
+            for ( index_t j=0; j<eval_field.cols(); ++j)
+            {
+                for ( index_t i=0; i!=eval_field.rows(); ++i)
+                    file<< eval_field(i,j) <<" ";
+                for ( index_t i=eval_field.rows(); i<3; ++i)
+                    file<<"0 ";
+            }
         }
+        file <<"</DataArray>\n";
     }
-    file <<"</DataArray>\n";
+    else
+        writeVtsAppendedArray(file, appended, compress, eval_field, nf, "SolutionField");
     file <<"</PointData>\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
+    if ( ascii )
     {
-        for ( index_t i=0; i!=n; ++i)
-            file<< eval_geo(i,j) <<" ";
-        for ( index_t i=n; i<3; ++i)
-            file<<"0 ";
+        file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
+        for ( index_t j=0; j<eval_geo.cols(); ++j)
+        {
+            for ( index_t i=0; i!=n; ++i)
+                file<< eval_geo(i,j) <<" ";
+            for ( index_t i=n; i<3; ++i)
+                file<<"0 ";
+        }
+        file <<"</DataArray>\n";
     }
-    file <<"</DataArray>\n";
+    else
+        writeVtsAppendedArray(file, appended, compress, eval_geo, 3, "");
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    writeVtsAppendedData(file, appended);
     file <<"</VTKFile>\n";
 
     file.close();
@@ -505,15 +554,20 @@ void writeSingleGeometry(gsFunction<T> const& func,
         }
     }
 
+    const std::string format = gsWriteParaviewFormat(); // read once per file
+    const bool ascii = ( "ascii" == format ), compress = ( "compressed" == format );
+    std::string appended; // binary formats
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), ascii ? std::ios_base::out
+                                          : std::ios_base::out | std::ios_base::binary);
     if ( ! file.is_open() )
         gsWarn<<"writeSingleGeometry: Problem opening file \""<<fn<<"\""<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file << gsParaviewDataSet::vtkFileHeader("StructuredGrid", format);
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Add norm of the point as data
@@ -530,23 +584,34 @@ void writeSingleGeometry(gsFunction<T> const& func,
     {
         //gsWarn<< "4th dimension as scalar data.\n";
         file <<"<PointData "<< "Scalars=\"Coordinate4\">\n";
-        file <<"<DataArray type=\"Float32\" Name=\"Coordinate4\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-        for ( index_t j=0; j!=eval_func.cols(); ++j)
-            file<< eval_func(3,j) <<" ";
-        file <<"</DataArray>\n";
+        if ( ascii )
+        {
+            file <<"<DataArray type=\"Float32\" Name=\"Coordinate4\" format=\"ascii\" NumberOfComponents=\"1\">\n";
+            for ( index_t j=0; j!=eval_func.cols(); ++j)
+                file<< eval_func(3,j) <<" ";
+            file <<"</DataArray>\n";
+        }
+        else
+            writeVtsAppendedArray(file, appended, compress, gsMatrix<T>(eval_func.row(3)), 1, "Coordinate4");
         file <<"</PointData>\n";
     }
     //---------
 
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
-    for ( index_t j=0; j<eval_func.cols(); ++j)
-        for ( index_t i=0; i!=3; ++i)
-            file<< eval_func(i,j) <<" ";
-    file <<"</DataArray>\n";
+    if ( ascii )
+    {
+        file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
+        for ( index_t j=0; j<eval_func.cols(); ++j)
+            for ( index_t i=0; i!=3; ++i)
+                file<< eval_func(i,j) <<" ";
+        file <<"</DataArray>\n";
+    }
+    else
+        writeVtsAppendedArray(file, appended, compress, eval_func, 3, "");
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    writeVtsAppendedData(file, appended);
     file <<"</VTKFile>\n";
     file.close();
 }
@@ -1021,39 +1086,62 @@ void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const
         eval_geo.bottomRows(3-n).setZero();
     }
 
+    const std::string format = gsWriteParaviewFormat(); // read once per file
+    const bool ascii = ( "ascii" == format ), compress = ( "compressed" == format );
+    std::string appended; // binary formats
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), ascii ? std::ios_base::out
+                                          : std::ios_base::out | std::ios_base::binary);
     if ( ! file.is_open() )
         gsWarn<<"gsWriteParaview_basisFnct: Problem opening file \""<<fn<<"\""<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file << gsParaviewDataSet::vtkFileHeader("StructuredGrid", format);
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
+    if ( ascii )
+    {
+        file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
+        for ( index_t j=0; j<eval_geo.cols(); ++j)
             file<< eval_geo(0,j) <<" ";
-    file <<"</DataArray>\n";
+        file <<"</DataArray>\n";
+    }
+    else
+        writeVtsAppendedArray(file, appended, compress, eval_geo, 1, "SolutionField");
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
+    if ( ascii )
+    {
+        file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
+        for ( index_t j=0; j<eval_geo.cols(); ++j)
+        {
+            for ( int l=0; l!=d; ++l)
+                file<< pts(l,j) <<" ";
+            file<< eval_geo(0,j) <<" ";
+            for ( index_t l=d; l!=pts.rows(); ++l)
+                file<< pts(l,j) <<" ";
+        }
+        file <<"</DataArray>\n";
+    }
+    else
     {
-        for ( int l=0; l!=d; ++l)
-            file<< pts(l,j) <<" ";
-        file<< eval_geo(0,j) <<" ";
-         for ( index_t l=d; l!=pts.rows(); ++l)
-             file<< pts(l,j) <<" ";
+        // the value is inserted after the first d coordinates
+        gsMatrix<T> graph(pts.rows()+1, pts.cols());
+        graph.topRows(d) = pts.topRows(d);
+        graph.row(d) = eval_geo.row(0);
+        graph.bottomRows(pts.rows()-d) = pts.bottomRows(pts.rows()-d);
+        writeVtsAppendedArray(file, appended, compress, graph, 3, "");
     }
-    file <<"</DataArray>\n";
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    writeVtsAppendedData(file, appended);
     file <<"</VTKFile>\n";
     file.close();
 }
@@ -1098,50 +1186,73 @@ void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::st
         np.bottomRows(3-d).setOnes();
     }
 
+    const std::string format = gsWriteParaviewFormat(); // read once per file
+    const bool ascii = ( "ascii" == format ), compress = ( "compressed" == format );
+    std::string appended; // binary formats
+
     std::string mfn(fn);
     mfn.append(".vts");
-    std::ofstream file(mfn.c_str());
+    std::ofstream file(mfn.c_str(), ascii ? std::ios_base::out
+                                          : std::ios_base::out | std::ios_base::binary);
     if ( ! file.is_open() )
         gsWarn<<"gsWriteParaview: Problem opening file \""<<fn<<"\""<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    file << gsParaviewDataSet::vtkFileHeader("StructuredGrid", format);
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information (Not really used)
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< 1 <<"\">\n";
-    for ( index_t j=0; j<ev.cols(); ++j)
+    if ( ascii )
+    {
+        file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< 1 <<"\">\n";
+        for ( index_t j=0; j<ev.cols(); ++j)
             file<< ev(0,j) <<" ";
-    file <<"</DataArray>\n";
+        file <<"</DataArray>\n";
+    }
+    else
+        writeVtsAppendedArray(file, appended, compress, ev, 1, "SolutionField");
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    if (graph)
+    if ( ascii )
     {
-        for ( index_t j=0; j<ev.cols(); ++j)
+        file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
+        if (graph)
         {
-            for ( int i=0; i< d; ++i)
-                file<< pts(i,j) <<" ";
-            file<< ev(0,j) <<" ";
+            for ( index_t j=0; j<ev.cols(); ++j)
+            {
+                for ( int i=0; i< d; ++i)
+                    file<< pts(i,j) <<" ";
+                file<< ev(0,j) <<" ";
+            }
         }
-    }
-    else
-    {
-        for ( index_t j=0; j<ev.cols(); ++j)
+        else
         {
-            for ( index_t i=0; i!=ev.rows(); ++i)
-                file<< ev(i,j) <<" ";
-            for ( index_t i=ev.rows(); i<3; ++i)
-                file<<"0 ";
+            for ( index_t j=0; j<ev.cols(); ++j)
+            {
+                for ( index_t i=0; i!=ev.rows(); ++i)
+                    file<< ev(i,j) <<" ";
+                for ( index_t i=ev.rows(); i<3; ++i)
+                    file<<"0 ";
+            }
         }
+        file <<"</DataArray>\n";
     }
-    file <<"</DataArray>\n";
+    else if (graph)
+    {
+        gsMatrix<T> pv(d+1, pts.cols());
+        pv.topRows(d) = pts.topRows(d);
+        pv.row(d) = ev.row(0);
+        writeVtsAppendedArray(file, appended, compress, pv, 3, "");
+    }
+    else
+        writeVtsAppendedArray(file, appended, compress, ev, 3, "");
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
+    writeVtsAppendedData(file, appended);
     file <<"</VTKFile>\n";
     file.close();
 }
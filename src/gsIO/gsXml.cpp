@@ -22,8 +22,121 @@
 #include <rapidxml/rapidxml.hpp> // External file
 #include <rapidxml/rapidxml_print.hpp> // External file
 
+#ifdef GISMO_ZLIB_STATIC
+#define Z_PREFIX // the bundled zlib has prefixed symbols
+#endif
+#include <zlib/zlib.h>
+
 namespace gismo {
 
+namespace {
+
+// Parses an unsigned decimal number, keeping up to 19 significant
+// digits in \a mant; the remaining digits only shift \a exp10
+inline const char * parseDecimal(const char * p, uint64_t & mant, int & exp10,
+                                 bool & exact, bool & digits)
+{
+    int nd = 0;
+    mant = 0; exp10 = 0; exact = true; digits = false;
+    for (; *p >= '0' && *p <= '9'; ++p)
+    {
+        digits = true;
+        if (nd < 19) { mant = 10*mant + (*p - '0'); nd += (0!=mant); }
+        else { ++exp10; exact &= ('0'==*p); }
+    }
+    if ('.' == *p)
+        for (++p; *p >= '0' && *p <= '9'; ++p)
+        {
+            digits = true;
+            if (nd < 19) { mant = 10*mant + (*p - '0'); nd += (0!=mant); --exp10; }
+            else exact &= ('0'==*p);
+        }
+    if ( digits && ('e' == *p || 'E' == *p) )
+    {
+        const char * e = p + 1;
+        const bool neg = ('-' == *e);
+        if (neg || '+' == *e) ++e;
+        if (*e >= '0' && *e <= '9')
+        {
+            int x = 0;
+            for (; *e >= '0' && *e <= '9'; ++e)
+                if (x < 100000) x = 10*x + (*e - '0');
+            exp10 += neg ? -x : x;
+            p = e;
+        }
+    }
+    return p;
+}
+
+// Base64 alphabet and its inverse (-1 marks other characters)
+struct base64Table
+{
+    signed char dec[256];
+
+    static const char * alphabet()
+    { return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"; }
+
+    base64Table()
+    {
+        std::fill(dec, dec + 256, -1);
+        for (int k = 0; k != 64; ++k)
+            dec[static_cast<unsigned char>(alphabet()[k])] = static_cast<signed char>(k);
+    }
+};
+
+// Reads one decimal number, i.e. a numerator or a denominator
+inline bool readDouble(const char *& str, double & var)
+{
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+        1e19, 1e20, 1e21, 1e22};
+
+    const char * p = str;
+    while ( std::isspace(static_cast<unsigned char>(*p)) ) ++p;
+    const char * start = p;
+    const bool neg = ('-' == *p);
+    if (neg || '+' == *p) ++p;
+
+    uint64_t mant;
+    int exp10;
+    bool exact, digits;
+    const char * end = parseDecimal(p, mant, exp10, exact, digits);
+
+    // Mantissa and power of ten are exact doubles, hence a single
+    // multiplication or division is correctly rounded
+    if ( digits && exact && mant <= (uint64_t(1)<<53) && exp10 >= -22 && exp10 <= 22 )
+    {
+        var = static_cast<double>(mant);
+        var = exp10 < 0 ? var / pow10[-exp10] : var * pow10[exp10];
+        if (neg) var = -var;
+        str = end;
+        return true;
+    }
+
+    // Long mantissas, huge exponents, inf and nan
+    char * e;
+    var = std::strtod(start, &e);
+    if (e == start) return false;
+    str = e;
+    return true;
+}
+
+}
+
+bool gsReadDouble(const char *& str, double & var)
+{
+    if ( !readDouble(str, var) ) return false;
+    if ('/' == *str) // fraction
+    {
+        const char * p = str + 1;
+        double den;
+        if ( !readDouble(p, den) ) return false;
+        var /= den;
+        str = p;
+    }
+    return true;
+}
+
 namespace internal {
 
 
@@ -71,6 +184,95 @@ gsXmlNode * makeComment(const std::string & comment, gsXmlTree & data)
                        data.allocate_string(comment.c_str()));
 }
     
+char * makeBinaryValue(const char * raw, size_t nBytes, bool compress, gsXmlTree & data)
+{
+    const char * b64 = base64Table::alphabet();
+
+    std::vector<Bytef> zbuf;
+    if (compress)
+    {
+        uLongf zlen = compressBound(static_cast<uLong>(nBytes));
+        zbuf.resize(zlen);
+        GISMO_ENSURE( Z_OK == compress2(zbuf.data(), &zlen,
+                                        reinterpret_cast<const Bytef*>(raw),
+                                        static_cast<uLong>(nBytes), Z_DEFAULT_COMPRESSION),
+                      "Compression of XML data failed.");
+        raw    = reinterpret_cast<const char*>(zbuf.data());
+        nBytes = zlen;
+    }
+
+    const size_t len = 4 * ((nBytes + 2) / 3);
+    char * out = data.allocate_string(0, len + 1);
+    const unsigned char * in = reinterpret_cast<const unsigned char*>(raw);
+    char * o = out;
+    size_t i = 0;
+    for (; i + 2 < nBytes; i += 3)
+    {
+        const unsigned v = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
+        *o++ = b64[ v >> 18      ];
+        *o++ = b64[(v >> 12) & 63];
+        *o++ = b64[(v >>  6) & 63];
+        *o++ = b64[ v        & 63];
+    }
+    if (i < nBytes)
+    {
+        const unsigned v = (in[i] << 16) | (i + 1 < nBytes ? in[i+1] << 8 : 0);
+        *o++ = b64[ v >> 18      ];
+        *o++ = b64[(v >> 12) & 63];
+        *o++ = i + 1 < nBytes ? b64[(v >> 6) & 63] : '=';
+        *o++ = '=';
+    }
+    *o = '\0';
+    return out;
+}
+
+void getBinaryValue(gsXmlNode * node, char * raw, size_t nBytes)
+{
+    static const base64Table table;
+    const signed char * dec = table.dec;
+
+    gsXmlAttribute * enc = node->first_attribute("encoding");
+    const bool compressed = enc && !strcmp(enc->value(), "zlib");
+    GISMO_ENSURE( compressed || !enc || !strcmp(enc->value(), "base64"),
+                  "Unknown XML encoding "<< enc->value() <<" in tag "<< node->name() );
+
+    // Decode base64, skipping white space and padding
+    std::vector<unsigned char> buf;
+    buf.reserve( 3 * node->value_size() / 4 );
+    unsigned v = 0;
+    int n = 0;
+    for (const char * p = node->value(); *p; ++p)
+    {
+        const signed char d = dec[static_cast<unsigned char>(*p)];
+        if (d < 0) continue;
+        v = (v << 6) | d;
+        if (++n == 4)
+        {
+            buf.push_back(static_cast<unsigned char>(v >> 16));
+            buf.push_back(static_cast<unsigned char>(v >> 8));
+            buf.push_back(static_cast<unsigned char>(v));
+            v = 0; n = 0;
+        }
+    }
+    if (n > 1) buf.push_back(static_cast<unsigned char>(v >> (6*n - 8)));
+    if (n > 2) buf.push_back(static_cast<unsigned char>(v >> (6*n - 16)));
+
+    if (compressed)
+    {
+        uLongf len = static_cast<uLongf>(nBytes);
+        GISMO_ENSURE( Z_OK == uncompress(reinterpret_cast<Bytef*>(raw), &len,
+                                         buf.data(), static_cast<uLong>(buf.size()))
+                      && len == nBytes,
+                      "Decompression of tag "<< node->name() <<" failed.");
+    }
+    else
+    {
+        GISMO_ENSURE( buf.size() == nBytes, "Tag "<< node->name() <<" holds "<< buf.size()
+                      <<" bytes of binary data, expected "<< nBytes <<".");
+        std::copy(buf.begin(), buf.end(), raw);
+    }
+}
+
 std::string to_string(const unsigned & i)
 {
     char tmp[4];
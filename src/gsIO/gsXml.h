@@ -26,6 +26,8 @@
 //#include <rapidxml/rapidxml_iterators.hpp> // External file
 
 #include <cstring>
+#include <cctype>
+#include <sstream>
 
 /*
 // Forward declare rapidxml structures
@@ -184,6 +186,57 @@ typename util::enable_if<!std::numeric_limits<T>::is_integer, bool>::type
 gsGetValue(std::istream & is, T & var)
 { return gsGetReal<T>(is,var); }
 
+/// Reads a decimal number (or a fraction "p/q") from the beginning of
+/// \a str, advancing \a str past it. The result is correctly rounded.
+GISMO_EXPORT bool gsReadDouble(const char *& str, double & var);
+
+/// \brief Reads the next number of the zero-terminated string \a str
+/// into \a var and advances \a str past it.
+///
+/// Hand-written alternative to gsGetValue for parsing the contents
+/// of XML nodes, which avoids the stream and string overhead for
+/// every number. Returns false if no number could be read.
+template <typename Z>
+typename util::enable_if<std::numeric_limits<Z>::is_integer, bool>::type
+gsReadValue(const char *& str, Z & var)
+{
+    const char * p = str;
+    while ( std::isspace(static_cast<unsigned char>(*p)) ) ++p;
+    const bool neg = ('-' == *p);
+    if ( neg || '+' == *p ) ++p;
+    if ( !std::isdigit(static_cast<unsigned char>(*p)) ) return false;
+    Z val = 0;
+    for (; std::isdigit(static_cast<unsigned char>(*p)); ++p)
+        val = 10 * val + static_cast<Z>(*p - '0');
+    var = neg ? static_cast<Z>(-val) : val;
+    str = p;
+    return true;
+}
+
+template <typename T>
+typename util::enable_if<!std::numeric_limits<T>::is_integer, bool>::type
+gsReadValue(const char *& str, T & var)
+{
+    if ( std::numeric_limits<T>::is_iec559 && sizeof(T) <= sizeof(double) )
+    {
+        double val;
+        if ( !gsReadDouble(str, val) ) return false;
+        var = static_cast<T>(val);
+        return true;
+    }
+
+    // Other number types (long double, rationals) are read by gsGetReal
+    const char * p = str;
+    while ( std::isspace(static_cast<unsigned char>(*p)) ) ++p;
+    const char * e = p;
+    while ( *e && !std::isspace(static_cast<unsigned char>(*e)) ) ++e;
+    if ( e == p ) return false;
+    std::istringstream is( std::string(p, e) );
+    if ( !gsGetReal<T>(is, var) ) return false;
+    str = e;
+    return true;
+}
+
 namespace internal {
 
 typedef rapidxml::xml_node<char>        gsXmlNode;
@@ -404,6 +457,28 @@ template<class T>
 gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat,
                                    gsXmlTree & data, std::string name = "SparseMatrix");
 
+/// Helper to allocate the base64 encoding of \a nBytes of raw data
+/// in the XML pool, compressed by zlib beforehand if \a compress is true
+GISMO_EXPORT char * makeBinaryValue(const char * raw, size_t nBytes,
+                                    bool compress, gsXmlTree & data);
+
+/// Helper to decode the base64 value of \a node into \a nBytes of
+/// raw data, decompressing it if its \em encoding attribute is "zlib"
+GISMO_EXPORT void getBinaryValue(gsXmlNode * node, char * raw, size_t nBytes);
+
+/// Helper to store \a n numbers as the binary value of \a node,
+/// provided that the encoding of \a data (see
+/// gsFileData::setEncoding) is not "ascii". Returns false if the
+/// numbers have to be written as text instead.
+template<class T>
+bool putArrayToXml(const T * val, size_t n, gsXmlNode * node, gsXmlTree & data);
+
+/// Helper to fetch \a n numbers from the binary value of \a node.
+/// Returns false if the node has no \em encoding attribute, i.e. the
+/// numbers are stored as text.
+template<class T>
+bool getArrayFromXml(gsXmlNode * node, T * val, size_t n);
+
 }// end namespace internal
 
 }// end namespace gismo
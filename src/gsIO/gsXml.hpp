@@ -95,14 +95,20 @@ void getMatrixFromXml ( gsXmlNode * node, unsigned const & rows,
                         unsigned const & cols, gsMatrix<T> & result )
 {
     //gsWarn<<"Reading "<< node->name() <<" matrix of size "<<rows<<"x"<<cols<<"Geometry..\n";
-    std::istringstream str;
-    str.str( node->value() );
     result.resize(rows,cols);
 
+    if ( node->first_attribute("encoding") )
+    {
+        gsMatrix<T> tmp(cols, rows); // Read is RowMajor
+        getArrayFromXml(node, tmp.data(), tmp.size());
+        result = tmp.transpose();
+        return;
+    }
+
+    const char * str = node->value();
     for (unsigned i=0; i<rows; ++i) // Read is RowMajor
         for (unsigned j=0; j<cols; ++j)
-            //if ( !(str >> result(i,j) ) )
-              if (! gsGetValue(str,result(i,j)) )
+              if (! gsReadValue(str,result(i,j)) )
             {
                 gsWarn<<"XML Warning: Reading matrix of size "<<rows<<"x"<<cols<<" failed.\n";
                 gsWarn<<"Tag: "<< node->name() <<", Matrix entry: ("<<i<<", "<<j<<").\n";
@@ -114,7 +120,14 @@ template<class T>
 gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, gsXmlTree & data, std::string name)
 {
     // Create XML tree node
-    gsXmlNode* new_node = internal::makeNode(name, mat, data);
+    gsXmlNode* new_node = internal::makeNode(name, data);
+    if ( "ascii" != data.getEncoding() )
+    {
+        const gsMatrix<T> tmp = mat.transpose(); // Write is RowMajor
+        if ( putArrayToXml(tmp.data(), tmp.size(), new_node, data) )
+            return new_node;
+    }
+    new_node->value( makeValue(mat, data, false) );
     return new_node;
 }
 
@@ -124,6 +137,34 @@ gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat,
 {
     typedef typename gsSparseMatrix<T>::InnerIterator cIter;
 
+    if ( "ascii" != data.getEncoding() )
+    {
+        // Binary form: all row indices, all column indices, all values
+        const index_t nz = mat.nonZeros();
+        gsMatrix<index_t> ij(nz, 2);
+        gsMatrix<T> val(nz, 1);
+        index_t k = 0;
+        for (index_t j=0; j != mat.cols(); ++j)
+            for ( cIter it(mat,j); it; ++it, ++k )
+            {
+                ij(k,0) = it.index();
+                ij(k,1) = j;
+                val(k,0) = it.value();
+            }
+
+        gsXmlNode* new_node = internal::makeNode(name, data);
+        gsXmlNode* ij_node  = internal::makeNode("indices", data);
+        gsXmlNode* val_node = internal::makeNode("values", data);
+        if ( putArrayToXml(ij.data(), ij.size(), ij_node, data) &&
+             putArrayToXml(val.data(), val.size(), val_node, data) )
+        {
+            new_node->append_attribute( makeAttribute("nonZeros", nz, data) );
+            new_node->append_node(ij_node);
+            new_node->append_node(val_node);
+            return new_node;
+        }
+    }
+
     std::ostringstream str;
     str << std::setprecision(data.getFloatPrecision());
     const index_t nCol = mat.cols();
@@ -146,16 +187,103 @@ void getSparseEntriesFromXml ( gsXmlNode * node,
 {
     result.clear();
 
-    std::istringstream str;
-    str.str( node->value() );
+    gsXmlNode * ij_node = node->first_node("indices");
+    if ( ij_node )
+    {
+        gsXmlAttribute * nz_at = node->first_attribute("nonZeros");
+        GISMO_ENSURE(nz_at, "Number of non-zeros is missing (nonZeros attribute).");
+        const index_t nz = atoi( nz_at->value() );
+        gsMatrix<index_t> ij(nz, 2);
+        gsMatrix<T> val(nz, 1);
+        GISMO_ENSURE( getArrayFromXml(ij_node, ij.data(), ij.size()) &&
+                      getArrayFromXml(node->first_node("values"), val.data(), val.size()),
+                      "Binary data of SparseMatrix is missing.");
+        result.reserve(nz);
+        for (index_t k = 0; k != nz; ++k)
+            result.add(ij(k,0), ij(k,1), val(k,0));
+        return;
+    }
+
+    const char * str = node->value();
     index_t r,c;
     T val;
 
-    //while( (str >> r) && (str >> c) && (str >> val) )
-    while( (str >> r) && (str >> c) && ( gsGetValue(str,val)) )
+    while( gsReadValue(str,r) && gsReadValue(str,c) && gsReadValue(str,val) )
         result.add(r,c,val);
 }
 
+// Numbers other than integers and floats are always written as text
+template<class T>
+typename util::enable_if<std::numeric_limits<T>::is_integer ||
+                         std::numeric_limits<T>::is_iec559, const T &>::type
+binaryValue(const T & val) { return val; }
+
+template<class T>
+typename util::enable_if<!(std::numeric_limits<T>::is_integer ||
+                           std::numeric_limits<T>::is_iec559), int64_t>::type
+binaryValue(const T &) { GISMO_ERROR("Number type has no binary representation."); }
+
+template<class T>
+bool putArrayToXml(const T * val, size_t n, gsXmlNode * node, gsXmlTree & data)
+{
+    const std::string & enc = data.getEncoding();
+    if ( "ascii" == enc ||
+         !(std::numeric_limits<T>::is_integer || std::numeric_limits<T>::is_iec559) )
+        return false;
+    GISMO_ENSURE( "base64" == enc || "zlib" == enc,
+                  "Unknown XML encoding "<< enc <<", use ascii, base64 or zlib.");
+
+    // Integers are stored as Int64 and real numbers as Float64
+    std::vector<char> raw;
+    if ( std::numeric_limits<T>::is_integer )
+    {
+        raw.resize( n * sizeof(int64_t) );
+        int64_t * out = reinterpret_cast<int64_t*>(raw.data());
+        for (size_t i = 0; i != n; ++i)
+            out[i] = static_cast<int64_t>( binaryValue(val[i]) );
+    }
+    else
+    {
+        raw.resize( n * sizeof(double) );
+        double * out = reinterpret_cast<double*>(raw.data());
+        for (size_t i = 0; i != n; ++i)
+            out[i] = static_cast<double>( binaryValue(val[i]) );
+    }
+
+    node->append_attribute( makeAttribute("encoding", enc, data) );
+    node->append_attribute( makeAttribute("type",
+        std::numeric_limits<T>::is_integer ? "Int64" : "Float64", data) );
+    node->value( makeBinaryValue(raw.data(), raw.size(), "zlib" == enc, data) );
+    return true;
+}
+
+template<class T>
+bool getArrayFromXml(gsXmlNode * node, T * val, size_t n)
+{
+    if ( nullptr == node || nullptr == node->first_attribute("encoding") )
+        return false;
+
+    gsXmlAttribute * type = node->first_attribute("type");
+    GISMO_ENSURE( type, "Type of binary data is missing (type attribute).");
+    if ( !strcmp(type->value(), "Int64") )
+    {
+        std::vector<int64_t> raw(n);
+        getBinaryValue(node, reinterpret_cast<char*>(raw.data()), n * sizeof(int64_t));
+        for (size_t i = 0; i != n; ++i)
+            val[i] = static_cast<T>(raw[i]);
+    }
+    else if ( !strcmp(type->value(), "Float64") )
+    {
+        std::vector<double> raw(n);
+        getBinaryValue(node, reinterpret_cast<char*>(raw.data()), n * sizeof(double));
+        for (size_t i = 0; i != n; ++i)
+            val[i] = static_cast<T>(raw[i]);
+    }
+    else
+        GISMO_ERROR("Unknown type of binary data: "<< type->value());
+    return true;
+}
+
 }// end namespace internal
 
 }// end namespace gismo
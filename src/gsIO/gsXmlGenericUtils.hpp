@@ -215,7 +215,7 @@ gsXmlNode * putHTensorBasisToXml ( Object const & obj, gsXmlTree & data)
             box.leftCols(d)  = lIter.lowerCorner().transpose();
             box.rightCols(d) = lIter.upperCorner().transpose();
        
-            tmp = putMatrixToXml( box, data, "box" );
+            tmp = makeNode("box", box, data); // always as text
            
             tmp->append_attribute( makeAttribute("level", to_string(lIter->level), data ) );
             tp_node->append_node(tmp);
@@ -231,7 +231,7 @@ for(unsigned int i = 0; i < boxes.size(); i++)
 box.leftCols(d)  = boxes[i].lower.transpose();
 box.rightCols(d) = boxes[i].upper.transpose();
 
-tmp = putMatrixToXml( box, data, "box" );
+tmp = makeNode("box", box, data);
 tmp->append_attribute( makeAttribute("level", to_string(boxes[i].level), data ) );
 tp_node->append_node(tmp);
 }
@@ -184,7 +184,7 @@ public:
         {
             vert.row(i) = obj.vertex[i]->coords;
         }
-        gsXmlNode * nodeVertex = putMatrixToXml(vert, data, "Vertex");
+        gsXmlNode * nodeVertex = makeNode("Vertex", vert, data); // always as text
         // Make Face node
         size_t nFace = obj.face.size();
         std::ostringstream strf;
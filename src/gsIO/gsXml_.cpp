@@ -47,6 +47,12 @@ TEMPLATE_INST
 gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat,
                                    gsXmlTree & data, std::string name);
 
+TEMPLATE_INST
+bool putArrayToXml(const T * val, size_t n, gsXmlNode * node, gsXmlTree & data);
+
+TEMPLATE_INST
+bool getArrayFromXml(gsXmlNode * node, T * val, size_t n);
+
 /*
  * instances for index_t and int32_t, int64_t as needed
  */
@@ -77,6 +83,12 @@ TEMPLATE_INST
 gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<index_t> const & mat,
                                    gsXmlTree & data, std::string name);
 
+TEMPLATE_INST
+bool putArrayToXml(const index_t * val, size_t n, gsXmlNode * node, gsXmlTree & data);
+
+TEMPLATE_INST
+bool getArrayFromXml(gsXmlNode * node, index_t * val, size_t n);
+
 
 } // namespace internal
 
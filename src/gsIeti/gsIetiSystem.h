@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gsSolver/gsMatrixOp.h>
+#include <gsParallel/gsMpi.h>
 
 namespace gismo
 {
@@ -62,6 +63,14 @@ namespace gismo
  *
  *  The right-hand sides are stored in a vector accessible via \ref localRhs.
  *
+ *  The system can be distributed among the processes of a communicator, see
+ *  \ref setCommunicator. Then, each process only knows its own subdomains,
+ *  while the Lagrange multipliers are stored redundantly on all processes.
+ *
+ *  If OpenMP is enabled, the local solvers are set up and applied in parallel,
+ *  one task per subdomain, starting with the largest subdomains. Thus, the
+ *  local solvers provided by the caller must not share any mutable state.
+ *
  *  @ingroup Solver
 **/
 
@@ -94,6 +103,30 @@ public:
     void addSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp,
         Matrix localRhs, OpPtr localSolverOp = OpPtr());
 
+    /// @brief Adds a new subdomain that is shared by all processes
+    ///
+    /// This is meant for the primal problem of a distributed IETI-DP solver.
+    /// The local matrix and the right-hand side have to agree on all
+    /// processes, while every process only provides the part of the jump
+    /// matrix that stems from its own patches. Shared subdomains have to be
+    /// added in the same order on all processes.
+    ///
+    /// If no communicator has been set, this is equivalent to \ref addSubdomain.
+    void addSharedSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp,
+        Matrix localRhs, OpPtr localSolverOp = OpPtr());
+
+    /// @brief Distributes the system among the processes of the communicator
+    ///
+    /// Each process adds only its own subdomains (and the shared ones). The
+    /// contributions to the Schur complement and its right-hand side are
+    /// summed up over all processes, so every process obtains the same
+    /// Lagrange multipliers, while \ref constructSolutionFromLagrangeMultipliers
+    /// only yields the solutions for the own subdomains.
+    void setCommunicator(const gsMpiComm& comm)      { m_comm = comm;              }
+
+    /// Returns the communicator
+    const gsMpiComm&     communicator() const        { return m_comm;              }
+
     /// Access the jump matrix
     JumpMatrixPtr&       jumpMatrix(index_t k)           { return m_jumpMatrices[k];   }
     const JumpMatrixPtr& jumpMatrix(index_t k) const     { return m_jumpMatrices[k];   }
@@ -145,10 +178,14 @@ public:
 
     /// @brief Returns \a gsLinearOperator that represents the IETI problem as
     ///        saddle point problem
+    ///
+    /// This is not available if the system is distributed.
     OpPtr saddlePointProblem() const;
 
     /// @brief Returns the right-hand-side that is required for the saddle point
     ///        formulation of the IETI problem
+    ///
+    /// This is not available if the system is distributed.
     Matrix rhsForSaddlePoint() const;
 
     /// @brief Returns the local solutions for the individual subdomains
@@ -160,10 +197,21 @@ public:
 private:
     void setupSparseLUSolvers() const;                ///< Setup solvers if not provided by user
 
+    /// Returns the indices of the subdomains, ordered by decreasing size
+    std::vector<index_t> subdomainsBySize() const;
+
+    /// Returns \f$ \tilde B_k^\top x \f$, summed up over all processes for shared subdomains
+    Matrix jumpTransposedTimes(index_t k, const Matrix& x) const;
+
+    /// Sums up the given matrix over all processes if the system is distributed
+    void sumOverProcesses(Matrix& x) const;
+
     std::vector<JumpMatrixPtr>  m_jumpMatrices;       ///< Stores the jump matrices
     std::vector<OpPtr>          m_localMatrixOps;     ///< Stores the local matrix ops \f$ \tilde A_k \f$
     std::vector<Matrix>         m_localRhs;           ///< Stores the local right-hand sides
     mutable std::vector<OpPtr>  m_localSolverOps;     ///< Stores the local solvers
+    std::vector<bool>           m_shared;             ///< Marks the subdomains shared by all processes
+    gsMpiComm                   m_comm;               ///< The communicator for distributed systems
 };
 
 } // namespace gismo
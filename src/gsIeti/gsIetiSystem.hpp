@@ -15,6 +15,7 @@
 
 #include <gsSolver/gsBlockOp.h>
 #include <gsSolver/gsAdditiveOp.h>
+#include <gsUtils/gsThreaded.h>
 
 namespace gismo
 {
@@ -26,6 +27,7 @@ void gsIetiSystem<T>::reserve(index_t n)
     this->m_localRhs.reserve(n);
     this->m_localSolverOps.reserve(n);
     this->m_jumpMatrices.reserve(n);
+    this->m_shared.reserve(n);
 }
 
 template<class T>
@@ -44,29 +46,80 @@ void gsIetiSystem<T>::addSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp
     this->m_localMatrixOps.push_back(give(localMatrixOp));
     this->m_localRhs.push_back(give(localRhs));
     this->m_localSolverOps.push_back(give(localSolverOp));
+    this->m_shared.push_back(false);
+}
+
+template<class T>
+void gsIetiSystem<T>::addSharedSubdomain(JumpMatrixPtr jumpMatrix, OpPtr localMatrixOp, Matrix localRhs, OpPtr localSolverOp)
+{
+    addSubdomain(give(jumpMatrix), give(localMatrixOp), give(localRhs), give(localSolverOp));
+    this->m_shared.back() = true;
+}
+
+template<class T>
+gsMatrix<T> gsIetiSystem<T>::jumpTransposedTimes(index_t k, const Matrix& x) const
+{
+    Matrix result = this->m_jumpMatrices[k]->transpose() * x;
+    if (this->m_shared[k])
+        sumOverProcesses(result);
+    return result;
+}
+
+template<class T>
+void gsIetiSystem<T>::sumOverProcesses(Matrix& x) const
+{
+    if (this->m_comm.size() > 1)
+        this->m_comm.sum(x.data(), static_cast<int>(x.size()));
+}
+
+template<class T>
+std::vector<index_t> gsIetiSystem<T>::subdomainsBySize() const
+{
+    const index_t sz = this->m_localMatrixOps.size();
+    std::vector<index_t> result(sz);
+    for (index_t i=0; i<sz; ++i)
+        result[i] = i;
+    std::stable_sort(result.begin(), result.end(),
+        [this](index_t a, index_t b)
+        { return this->m_localMatrixOps[a]->rows() > this->m_localMatrixOps[b]->rows(); });
+    return result;
 }
 
 template<class T>
 void gsIetiSystem<T>::setupSparseLUSolvers() const
 {
-    const size_t sz = this->m_localSolverOps.size();
-    for (size_t i=0; i<sz; ++i)
+    const std::vector<index_t> order = subdomainsBySize();
+    std::vector<index_t> todo;
+    for (size_t j=0; j<order.size(); ++j)
     {
+        const index_t i = order[j];
         if (!m_localSolverOps[i]) // If not yet provided...
         {
-            SparseMatrixOp* matop = dynamic_cast<SparseMatrixOp*>(this->m_localMatrixOps[i].get());
-            GISMO_ENSURE( matop, "gsIetiSystem::setupSparseLUSolvers The local solvers can only "
+            GISMO_ENSURE( dynamic_cast<SparseMatrixOp*>(this->m_localMatrixOps[i].get()),
+              "gsIetiSystem::setupSparseLUSolvers The local solvers can only "
               "be computed on the fly if the local systems in localMatrixOps are of type "
               "gsMatrixOp<gsSparseMatrix<T>>. Please provide solvers via members .addSubdomain "
               "or .solverOp" );
-            this->m_localSolverOps[i] = makeSparseLUSolver(SparseMatrix(matop->matrix()));
+            todo.push_back(i);
         }
     }
+
+    // The factorizations are independent; the largest ones are done first
+    const index_t sz = todo.size();
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t j=0; j<sz; ++j)
+    {
+        const index_t i = todo[j];
+        const SparseMatrixOp* matop = static_cast<const SparseMatrixOp*>(this->m_localMatrixOps[i].get());
+        this->m_localSolverOps[i] = makeSparseLUSolver(SparseMatrix(matop->matrix()));
+    }
 }
 
 template<class T>
 typename gsIetiSystem<T>::OpPtr gsIetiSystem<T>::saddlePointProblem() const
 {
+    GISMO_ENSURE( this->m_comm.size() <= 1, "gsIetiSystem::saddlePointProblem: "
+        "The saddle point formulation is not available for distributed systems." );
     const size_t sz = this->m_localMatrixOps.size();
     typename gsBlockOp<T>::Ptr result = gsBlockOp<T>::make( sz+1, sz+1 );
     for (size_t i=0; i<sz; ++i)
@@ -83,7 +136,63 @@ template<class T>
 typename gsIetiSystem<T>::OpPtr gsIetiSystem<T>::schurComplement() const
 {
     setupSparseLUSolvers();
-    return gsAdditiveOp<T>::make( this->m_jumpMatrices, this->m_localSolverOps );
+    if (this->m_comm.size() <= 1)
+        return gsAdditiveOp<T>::make( this->m_jumpMatrices, this->m_localSolverOps );
+
+    // For a distributed system, the operator sums up the contributions of all
+    // processes. The input for the shared subdomains is summed up as well,
+    // since every process only knows its part of their jump matrices.
+    const std::vector<JumpMatrixPtr> jumpMatrices = this->m_jumpMatrices;
+    const std::vector<OpPtr> localSolverOps = this->m_localSolverOps;
+    const std::vector<bool> shared = this->m_shared;
+    const std::vector<index_t> order = subdomainsBySize();
+    const gsMpiComm comm = this->m_comm;
+    const index_t sz = nLagrangeMultipliers();
+    return makeLinearOp<T>(
+        [jumpMatrices, localSolverOps, shared, order, comm](const Matrix& x, Matrix& result)
+        {
+            const index_t numPatches = jumpMatrices.size();
+
+            // The communication for the shared subdomains is done before
+            // the subdomains are processed in parallel
+            std::vector<Matrix> sharedInput(numPatches);
+            for (index_t i=0; i<numPatches; ++i)
+                if (shared[i])
+                {
+                    sharedInput[i] = jumpMatrices[i]->transpose() * x;
+                    comm.sum(sharedInput[i].data(), static_cast<int>(sharedInput[i].size()));
+                }
+
+            // The subdomains are dealt out statically, the largest ones
+            // first, and the thread-local results are merged pairwise,
+            // so the summation order does not depend on the timing
+            util::gsThreaded<Matrix> buf;
+#           pragma omp parallel
+            {
+                Matrix tmp, sol;
+                Matrix & local = buf.mine();
+                local.setZero(x.rows(), x.cols());
+#               pragma omp for schedule(static,1)
+                for (index_t j=0; j<numPatches; ++j)
+                {
+                    const index_t i = order[j];
+                    if (shared[i])
+                        localSolverOps[i]->apply(sharedInput[i], sol);
+                    else
+                    {
+                        tmp = jumpMatrices[i]->transpose() * x;
+                        localSolverOps[i]->apply(tmp, sol);
+                    }
+                    local.noalias() += *(jumpMatrices[i]) * sol;
+                }
+                Matrix & all = buf.combine();
+#               pragma omp master
+                result.swap(all);
+            }
+            comm.sum(result.data(), static_cast<int>(result.size()));
+        },
+        sz, sz
+    );
 }
 
 
@@ -91,15 +200,30 @@ template<class T>
 gsMatrix<T> gsIetiSystem<T>::rhsForSchurComplement() const
 {
     setupSparseLUSolvers();
+    const std::vector<index_t> order = subdomainsBySize();
+    const index_t numPatches = order.size();
+    const index_t rows = this->nLagrangeMultipliers();
+    const index_t cols = this->m_localRhs[0].cols();
     Matrix result;
-    result.setZero( this->nLagrangeMultipliers(), this->m_localRhs[0].cols());
-    const index_t numPatches = this->m_jumpMatrices.size();
-    for (index_t i=0; i<numPatches; ++i)
+    // Deterministic summation, as in schurComplement()
+    util::gsThreaded<Matrix> buf;
+#   pragma omp parallel
     {
         Matrix tmp;
-        this->m_localSolverOps[i]->apply( this->m_localRhs[i], tmp );
-        result += *(this->m_jumpMatrices[i]) * tmp;
+        Matrix & local = buf.mine();
+        local.setZero( rows, cols );
+#       pragma omp for schedule(static,1)
+        for (index_t j=0; j<numPatches; ++j)
+        {
+            const index_t i = order[j];
+            this->m_localSolverOps[i]->apply( this->m_localRhs[i], tmp );
+            local.noalias() += *(this->m_jumpMatrices[i]) * tmp;
+        }
+        Matrix & all = buf.combine();
+#       pragma omp master
+        result.swap(all);
     }
+    sumOverProcesses(result);
     return result;
 }
 
@@ -108,12 +232,25 @@ std::vector< gsMatrix<T> > gsIetiSystem<T>::constructSolutionFromLagrangeMultipl
 {
     setupSparseLUSolvers();
 
-    const index_t numPatches = this->m_jumpMatrices.size();
+    const std::vector<index_t> order = subdomainsBySize();
+    const index_t numPatches = order.size();
     std::vector<Matrix> result;
     result.resize(numPatches);
+
+    // The right-hand sides of the shared subdomains require communication,
+    // so they are set up before the subdomains are processed in parallel
+    std::vector<Matrix> rhs(numPatches);
     for (index_t i=0; i<numPatches; ++i)
+        if (this->m_shared[i])
+            rhs[i] = this->m_localRhs[i]-jumpTransposedTimes(i,multipliers);
+
+#   pragma omp parallel for schedule(dynamic,1)
+    for (index_t j=0; j<numPatches; ++j)
     {
-        this->m_localSolverOps[i]->apply( this->m_localRhs[i]-this->m_jumpMatrices[i]->transpose()*multipliers, result[i] );
+        const index_t i = order[j];
+        if (!this->m_shared[i])
+            rhs[i] = this->m_localRhs[i]-this->m_jumpMatrices[i]->transpose()*multipliers;
+        this->m_localSolverOps[i]->apply( rhs[i], result[i] );
     }
     return result;
 }
@@ -121,6 +258,8 @@ std::vector< gsMatrix<T> > gsIetiSystem<T>::constructSolutionFromLagrangeMultipl
 template<class T>
 gsMatrix<T> gsIetiSystem<T>::rhsForSaddlePoint() const
 {
+    GISMO_ENSURE( this->m_comm.size() <= 1, "gsIetiSystem::rhsForSaddlePoint: "
+        "The saddle point formulation is not available for distributed systems." );
     const index_t sz = m_localMatrixOps.size();
     index_t rows = nLagrangeMultipliers();
     for (index_t k=0; k<sz; ++k)
@@ -15,6 +15,7 @@
 
 #include <gsSolver/gsMatrixOp.h>
 #include <gsMatrix/gsVector.h>
+#include <gsParallel/gsMpi.h>
 
 namespace gismo
 {
@@ -255,6 +256,16 @@ public:
         Matrix& localRhs
     );
 
+    /// @brief Sums up the primal problem over all processes
+    ///
+    /// For a distributed IETI-DP solver, every process calls \ref handleConstraints
+    /// only for its own patches. This function sums up \ref localMatrix and
+    /// \ref localRhs over all processes, so that they agree on all processes.
+    /// The \ref jumpMatrix keeps the contributions of the own patches; the
+    /// primal subdomain is then added to \a gsIetiSystem via
+    /// \a gsIetiSystem::addSharedSubdomain.
+    void sumOverProcesses(const gsMpiComm& comm);
+
     /// @brief  Distributes the given solution for K+1 subdomains to the K patches
     ///
     /// @param    sol   The solution, first for the K patches, followed by the
@@ -227,6 +227,18 @@ void gsPrimalSystem<T>::handleConstraints(
     jumpMatrix   = jumpMatrix * localEmbedding.transpose();
 }
 
+template <class T>
+void gsPrimalSystem<T>::sumOverProcesses(const gsMpiComm& comm)
+{
+    if (comm.size() <= 1) return;
+
+    // The primal problem is small, so we communicate it as dense matrix
+    Matrix localMatrix = m_localMatrix.toDense();
+    comm.sum(localMatrix.data(), static_cast<int>(localMatrix.size()));
+    m_localMatrix = localMatrix.sparseView();
+    comm.sum(m_localRhs.data(), static_cast<int>(m_localRhs.size()));
+}
+
 template <class T>
 std::vector<typename gsPrimalSystem<T>::Matrix>
 gsPrimalSystem<T>::distributePrimalSolution( std::vector<Matrix> sol )
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gsSolver/gsMatrixOp.h>
+#include <gsParallel/gsMpi.h>
 #include <gsUtils/gsSortedVector.h>
 
 namespace gismo
@@ -217,13 +218,24 @@ public:
 
     /// @brief This returns the preconditioner as \a gsLinearOperator
     ///
-    /// This requires that the subdomains have been defined first.
+    /// This requires that the subdomains have been defined first. The local
+    /// Schur complements are applied in parallel if OpenMP is enabled.
     OpPtr preconditioner() const;
 
+    /// @brief Distributes the preconditioner among the processes of the communicator
+    ///
+    /// Each process adds only its own subdomains; the contributions of
+    /// all processes are summed up in \ref preconditioner.
+    void setCommunicator(const gsMpiComm& comm)         { m_comm = comm;             }
+
+    /// Returns the communicator
+    const gsMpiComm&     communicator() const           { return m_comm;             }
+
 public:
     std::vector<JumpMatrixPtr>  m_jumpMatrices;     ///< The jump matrices \f$ \hat B_k \f$
     std::vector<OpPtr>          m_localSchurOps;    ///< The local Schur complements \f$ S_k \f$
     std::vector<Matrix>         m_localScaling;     ///< The diagonal entries of \f$ D_k \f$ as vectors
+    gsMpiComm                   m_comm;             ///< The communicator for distributed systems
 };
 
 } // namespace gismo
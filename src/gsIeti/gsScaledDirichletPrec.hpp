@@ -207,7 +207,20 @@ gsScaledDirichletPrec<T>::preconditioner() const
         result->addOperator(m_jumpMatrices[i],local);
     }
 
-    return result;
+    if (m_comm.size() <= 1)
+        return result;
+
+    // For a distributed system, sum up the contributions of all processes
+    const gsMpiComm comm = m_comm;
+    const index_t sz = nLagrangeMultipliers();
+    return makeLinearOp<T>(
+        [result, comm](const Matrix& x, Matrix& y)
+        {
+            result->apply(x, y);
+            comm.sum(y.data(), static_cast<int>(y.size()));
+        },
+        sz, sz
+    );
 }
 
 
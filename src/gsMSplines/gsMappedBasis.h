@@ -405,6 +405,42 @@ protected:
     index_t _getLastLocalIndex(index_t const patch) const
     { return _getFirstLocalIndex(patch)+m_bases[patch]->size()-1; }
 
+    //////////////////////////////////////////////////
+    // functions for the evaluation of the mapped functions
+    //////////////////////////////////////////////////
+
+    /** gets the local indices of the functions of \a patch which are
+     *  active at one point, the zero padding of the patch basis is removed.
+     *
+     * \param[in] patch : the number of the patch
+     * \param[in] bact : the actives of the patch basis at the point
+     * \param[out] act0 : the local indices of the active functions
+     */
+    void _localActives(index_t const patch, const gsMatrix<index_t> & bact,
+                       IndexContainer & act0) const;
+
+    /** computes the sparse local maps for the actives \a bact of the patch
+     *  basis at a set of points. Consecutive points with the same actives
+     *  (e.g., the quadrature points of one element) share one map.
+     *
+     * \param[in] patch : the number of the patch
+     * \param[in] bact : the actives of the patch basis, one column per point
+     * \param[out] groups : the first point of each group, followed by the number of points
+     * \param[out] maps : the local map of each group, sources to rows, targets to columns
+     */
+    void _localMaps(index_t const patch, const gsMatrix<index_t> & bact,
+                    std::vector<index_t> & groups,
+                    std::vector<gsSparseMatrix<T> > & maps) const;
+
+    /** applies the local maps to values of the patch basis, which
+     *  consist of \a k values per function and point (e.g., \a k = d for
+     *  the first derivatives). The result is padded with zeros.
+     */
+    static void _applyLocalMaps(const std::vector<index_t> & groups,
+                                const std::vector<gsSparseMatrix<T> > & maps,
+                                const gsMatrix<T> & values, index_t const k,
+                                gsMatrix<T> & result);
+
     // Data members
 protected:
     /// Topology, specifying the relation (connections) between the patches
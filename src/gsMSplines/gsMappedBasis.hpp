@@ -138,122 +138,67 @@ template<short_t d,class T>
 void gsMappedBasis<d,T>::active_into(const index_t patch, const gsMatrix<T> & u,
                  gsMatrix<index_t>& result) const //global BF active on patch at point
 {
-    const index_t start = _getFirstLocalIndex(patch);
     gsMatrix<index_t> pActive;
     m_bases[patch]->active_into(u, pActive);
-    // Shift actives by the offset of the current patch
-    pActive.array() += start;
-    const index_t numact  = pActive.rows();
-    IndexContainer temp;
-    result.resizeLike( pActive );
-    std::vector<std::vector<index_t> > temp_output;//collects the outputs
+    std::vector<IndexContainer> temp_output;//collects the outputs
     temp_output.resize( pActive.cols() );
+    IndexContainer act0;
     size_t max = 0;
     for(index_t i = 0; i< pActive.cols();i++)
     {
-        std::vector<index_t> act_i( pActive.col(i).data(), pActive.col(i).data() + numact); // to be removed
-        m_mapper->sourceToTarget(act_i, temp);
-        temp_output[i]=temp;
-        if(temp.size()>max)
-            max=temp.size();
-                //result.col(i) = gsAsConstMatrix<index_t>(temp, temp.size(), 1 ).cast<index_t>();
+        // Points with the same actives (e.g. of one element) share the result
+        if (i!=0 && pActive.col(i)==pActive.col(i-1))
+            temp_output[i] = temp_output[i-1];
+        else
+        {
+            _localActives(patch, pActive.col(i), act0);
+            m_mapper->fastSourceToTarget(act0, temp_output[i]);
+        }
+        if(temp_output[i].size()>max)
+            max=temp_output[i].size();
     }
-    result.resize(max,u.cols());
+    result.setZero(max,u.cols());
     for(index_t i = 0; i < result.cols(); i++)
-        for (index_t j = 0; j < result.rows();j++)
-            if (size_t(j) < temp_output[i].size())
-                result(j,i) = temp_output[i][j];
-            else
-                result(j,i) = 0 ;
+        std::copy(temp_output[i].begin(), temp_output[i].end(), result.col(i).data());
 }
 
 template<short_t d,class T>
 void gsMappedBasis<d,T>::eval_into(const index_t patch, const gsMatrix<T> & u, gsMatrix<T>& result ) const
 {
     gsMatrix<index_t> bact;
-    std::vector<index_t>  act, act0;
-    gsMatrix<T> beval, map;//r:B,c:C
-    const index_t shift=_getFirstLocalIndex(patch);
-
-    gsVector<index_t> numAct;
-    std::vector<gsMatrix<T>> result_tmp;
-    result_tmp.resize(u.cols());
-    numAct.resize(u.cols());
-    for (index_t i = 0; i!=u.cols(); ++i)
-    {
-        m_bases[patch]->active_into(u.col(i), bact);
-        act0 = std::vector<index_t>(bact.data(), bact.data()+bact.rows());
-        m_bases[patch]->eval_into(u.col(i), beval);
-        std::transform(act0.begin(), act0.end(), act0.begin(),
-                       GS_BIND2ND(std::plus<index_t>(), shift));
-
-        m_mapper->fastSourceToTarget(act0,act);
-        m_mapper->getLocalMap(act0, act, map);
-        result_tmp[i] = map.transpose() * beval; // todo: remove transpose()
-        numAct[i] = result_tmp[i].rows();
-    }
-
-    result.setZero(numAct.maxCoeff(), u.cols());
-    for (index_t i = 0; i!=u.cols(); ++i)
-        for(index_t j = 0; j != result_tmp[i].rows(); j++) // result_tmp[i] == dim(rows,1)
-            result(j,i) = result_tmp[i](j,0);
-
+    gsMatrix<T> beval;
+    std::vector<index_t> groups;
+    std::vector<gsSparseMatrix<T> > maps;
+    m_bases[patch]->active_into(u, bact);
+    m_bases[patch]->eval_into(u, beval);
+    _localMaps(patch, bact, groups, maps);
+    _applyLocalMaps(groups, maps, beval, 1, result);
 }
 
 template<short_t d,class T>
 void gsMappedBasis<d,T>::deriv_into(const index_t patch, const gsMatrix<T> & u, gsMatrix<T>& result ) const
 {
-    gsMatrix<index_t> actives;
-    gsMatrix<T> curr_res;
-    active_into(patch,u,actives);
-    index_t rows = actives.rows();
-    index_t cols = actives.cols();
-    result.setZero(d*rows,cols);
-    for(index_t j = 0; j<cols; j++) // For all points u.col(j)
-    {
-        const gsMatrix<T> & curr_u =  u.col(j);
-        for(index_t i = 0; i<rows; i++) // For all actives at the point
-        {
-            if(actives(i,j)==0&&i>0)
-                continue;
-            derivSingle_into(patch, actives(i,j), curr_u, curr_res); // Evaluate N_j(u_i)
-            result.block(i*d,j,d,1).noalias() = curr_res;
-        }
-    }
+    gsMatrix<index_t> bact;
+    gsMatrix<T> bderiv;
+    std::vector<index_t> groups;
+    std::vector<gsSparseMatrix<T> > maps;
+    m_bases[patch]->active_into(u, bact);
+    m_bases[patch]->deriv_into(u, bderiv);
+    _localMaps(patch, bact, groups, maps);
+    _applyLocalMaps(groups, maps, bderiv, d, result);
 }
 
 template<short_t d,class T>
 void gsMappedBasis<d,T>::deriv2_into(const index_t patch, const gsMatrix<T> & u, gsMatrix<T>& result ) const
 {
     gsMatrix<index_t> bact;
+    gsMatrix<T> bderiv2;
+    std::vector<index_t> groups;
+    std::vector<gsSparseMatrix<T> > maps;
     m_bases[patch]->active_into(u, bact);
-    std::vector<index_t>  act, act0(bact.data(), bact.data()+bact.rows());
-    const index_t shift=_getFirstLocalIndex(patch);
-    std::transform(act0.begin(), act0.end(), act0.begin(),
-                   GS_BIND2ND(std::plus<index_t>(), shift));
-    m_mapper->fastSourceToTarget(act0,act);
-    gsMatrix<T> map;//r:B,c:C
-    m_mapper->getLocalMap(act0, act, map);
-
-    m_bases[patch]->deriv2_into(u, result);
-    index_t       nr = bact.rows();
-    const index_t nc = bact.cols();
-
-    static const index_t sd = d*(d+1)/2;
-
-    const index_t mr = map.cols();
-    gsMatrix<T> tmp(sd*mr, nc);
-
-    for (unsigned i = 0; i!=sd; ++i)
-    {
-        gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,sd> >
-            s(result.data()+i, nr, nc, gsEigen::Stride<-1,sd>(sd*nr,sd) );
-        gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,sd> >
-            t(tmp.data()+i, mr, nc, gsEigen::Stride<-1,sd>(sd*mr,sd) );
-        t = map.transpose() * s; //.noalias() bug
-    }
-
-    result.swap(tmp);
+    m_bases[patch]->deriv2_into(u, bderiv2);
+    _localMaps(patch, bact, groups, maps);
+    _applyLocalMaps(groups, maps, bderiv2, d*(d+1)/2, result);
 }
 
 template<short_t d,class T>
@@ -365,53 +310,19 @@ template<short_t d,class T>
 void gsMappedBasis<d,T>::evalAllDers_into(const index_t patch, const gsMatrix<T> & u,
                                              const index_t n, std::vector<gsMatrix<T> >& result) const
 {
+    GISMO_ASSERT( n < 3, "gsMappedBasis::evalAllDers() not implemented for 2<n." );
     gsMatrix<index_t> bact;
+    std::vector<index_t> groups;
+    std::vector<gsSparseMatrix<T> > maps;
     m_bases[patch]->active_into(u, bact);
-    std::vector<index_t>  act, act0(bact.data(), bact.data()+bact.rows());
-    const index_t shift=_getFirstLocalIndex(patch);
-    std::transform(act0.begin(), act0.end(), act0.begin(),
-                   GS_BIND2ND(std::plus<index_t>(), shift));
-    m_mapper->fastSourceToTarget(act0,act);
-    gsMatrix<T> map;//r:B,c:C
-    m_mapper->getLocalMap(act0, act, map);
-
-    m_bases[patch]->evalAllDers_into(u, n, result);
-    index_t       nr = result.front().rows();
-    const index_t nc = result.front().cols();
-    result.front() = map.transpose() * result.front();
-
-    if ( n>0 )
-    {
-        const index_t mr = map.cols();
-        gsMatrix<T> tmp(d*mr, nc);
-
-        for (index_t i = 0; i!=d; ++i)
-        {
-            gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,d> >
-                s(result[1].data()+i, nr, nc, gsEigen::Stride<-1,d>(d*nr,d) );
-            gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,d> >
-                t(tmp.data()+i, mr, nc, gsEigen::Stride<-1,d>(d*mr,d) );
-            t = map.transpose() * s; //.noalias() bug
-        }
-        result[1].swap(tmp);
-
-        if ( n>1 )
-        {
-            static const index_t sd = d*(d+1)/2;
-            tmp.resize(sd*mr, nc);
-
-            for (index_t i = 0; i!=sd; ++i)
-            {
-                gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,sd> >
-                    s(result[2].data()+i, nr, nc, gsEigen::Stride<-1,sd>(sd*nr,sd) );
-                gsEigen::Map<typename gsMatrix<T>::Base, 0, gsEigen::Stride<-1,sd> >
-                    t(tmp.data()+i, mr, nc, gsEigen::Stride<-1,sd>(sd*mr,sd) );
-                t = map.transpose() * s; //.noalias() bug
-            }
-            result[2].swap(tmp);
-        }
-    }
-    GISMO_ASSERT( n < 3, "gsMappedBasis::evalAllDers() not implemented for 2<n." );
+    _localMaps(patch, bact, groups, maps);
+
+    std::vector<gsMatrix<T> > bders;
+    m_bases[patch]->evalAllDers_into(u, n, bders);
+    result.resize(n+1);
+    const index_t k[3] = {1, d, d*(d+1)/2};
+    for (index_t i = 0; i<=n; ++i)
+        _applyLocalMaps(groups, maps, bders[i], k[i], result[i]);
 }
 
 template<short_t d,class T>
@@ -497,4 +408,69 @@ index_t gsMappedBasis<d,T>::_getFirstLocalIndex(index_t const patch) const
     return index;
 }
 
+template<short_t d,class T>
+void gsMappedBasis<d,T>::_localActives(index_t const patch, const gsMatrix<index_t> & bact,
+                                       IndexContainer & act0) const
+{
+    // The actives are sorted, so zeros after the first entry are padding
+    index_t numAct = bact.rows();
+    while (numAct > 1 && bact(numAct-1,0) == 0)
+        --numAct;
+    const index_t shift = _getFirstLocalIndex(patch);
+    act0.resize(numAct);
+    for (index_t j = 0; j != numAct; ++j)
+        act0[j] = bact(j,0) + shift;
+}
+
+template<short_t d,class T>
+void gsMappedBasis<d,T>::_localMaps(index_t const patch, const gsMatrix<index_t> & bact,
+                                    std::vector<index_t> & groups,
+                                    std::vector<gsSparseMatrix<T> > & maps) const
+{
+    IndexContainer act0, act;
+    groups.clear();
+    maps.clear();
+    for (index_t i = 0; i != bact.cols(); ++i)
+    {
+        if (i!=0 && bact.col(i)==bact.col(i-1))
+            continue;
+        groups.push_back(i);
+        _localActives(patch, bact.col(i), act0);
+        m_mapper->fastSourceToTarget(act0, act);
+        maps.push_back(gsSparseMatrix<T>());
+        m_mapper->getLocalMap(act0, act, maps.back());
+    }
+    groups.push_back(bact.cols());
+}
+
+template<short_t d,class T>
+void gsMappedBasis<d,T>::_applyLocalMaps(const std::vector<index_t> & groups,
+                                         const std::vector<gsSparseMatrix<T> > & maps,
+                                         const gsMatrix<T> & values, index_t const k,
+                                         gsMatrix<T> & result)
+{
+    typedef gsEigen::Stride<gsEigen::Dynamic,gsEigen::Dynamic> Stride;
+    index_t mr = 0;
+    for (size_t g = 0; g != maps.size(); ++g)
+        mr = math::max(mr, static_cast<index_t>(maps[g].cols()));
+    const index_t nr = values.rows() / k;
+    result.setZero(k*mr, values.cols());
+
+    // For the i-th value of all functions at the points of a group, the
+    // values of the patch basis are mapped by a sparse-dense product
+    for (size_t g = 0; g != maps.size(); ++g)
+    {
+        const index_t c0 = groups[g];
+        const index_t nc = groups[g+1] - c0;
+        for (index_t i = 0; i != k; ++i)
+        {
+            gsEigen::Map<const typename gsMatrix<T>::Base, 0, Stride>
+                s(values.data()+c0*k*nr+i, maps[g].rows(), nc, Stride(k*nr,k));
+            gsEigen::Map<typename gsMatrix<T>::Base, 0, Stride>
+                t(result.data()+c0*k*mr+i, maps[g].cols(), nc, Stride(k*mr,k));
+            t.noalias() = maps[g].transpose() * s;
+        }
+    }
+}
+
 } // namespace gismo
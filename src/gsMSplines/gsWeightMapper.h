@@ -470,6 +470,15 @@ public:
      */
      void getLocalMap (IndexContainer const & source, IndexContainer const & target, gsMatrix<T> &map) const;
 
+    /**
+       @brief getLocalMap, sparse version
+       @param[in]  source : array of indexType, source basis functions
+       @param[in]  target : sorted array of indexType, target basis functions
+       @param[out] map    : a sparse matrix containing the coefficients of the expansion of the targets as
+                            linear combination of the sources. Targets corresponds to columns, sources to rows.
+     */
+     void getLocalMap (IndexContainer const & source, IndexContainer const & target, gsSparseMatrix<T> &map) const;
+
     /**
        @brief getLocalMap
        @param[in]  source : array of indexType, source basis functions
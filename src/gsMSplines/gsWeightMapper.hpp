@@ -179,6 +179,33 @@ void gsWeightMapper<T>::getLocalMap (IndexContainer const & source, IndexContain
     }
 }
 
+template<class T>
+void gsWeightMapper<T>::getLocalMap (IndexContainer const & source, IndexContainer const & target, gsSparseMatrix<T> &map) const
+{
+    GISMO_ASSERT(m_matrix.isCompressed(),"optimize() must be called on the mapper with fastSourceToTarget flag before using this function.");
+
+    const index_t numRow=source.size();
+    const index_t numCol=target.size();
+
+    gsSparseEntries<T> entries;
+    entries.reserve(numRow);
+    for (index_t r=0;r<numRow;++r)
+    {
+        CIndexIter c = target.begin();
+        for (Iterator coef = fastSourceToTarget(source[r]); coef; ++coef)
+        {
+            // both the targets and the entries of a row are sorted
+            c = std::lower_bound(c, target.end(), coef.index());
+            if (c == target.end())
+                break;
+            if (*c == coef.index())
+                entries.add(r, c-target.begin(), coef.weight());
+        }
+    }
+    map.resize(numRow,numCol);
+    map.setFrom(entries);
+}
+
 template<class T>
 void gsWeightMapper<T>::getLocalMap (IndexContainer const & source, gsMatrix<T> &map) const
 {
@@ -37,6 +37,7 @@ public:
     {
         m_basis = NULL;
         m_result= NULL ;
+        m_last_lambda = 0;
     }
 
     /// constructor
@@ -58,6 +59,13 @@ public:
     /// Computes the least squares fit for a gsBasis
     void compute(T lambda = 0);
 
+    /// Recomputes the fit after the parameter values (or the points)
+    /// have changed. The sparsity pattern and the preconditioner of
+    /// the previous fit are reused and its coefficients are the
+    /// initial guess of the iterative solver. Without a previous fit
+    /// this is the same as compute().
+    void refit();
+
     void parameterCorrection(T accuracy = 1e-8,
                              index_t maxIter = 10,
                              T tolOrth = 1e-6);
@@ -95,14 +103,19 @@ public:
         return result; 
     }
 
-    /// Computes the least squares fit for a gsBasis
+    /// Computes the least squares fit for a gsBasis and corrects the
+    /// parameters until the maximum point error is below \a tolerance
+    /// or \a num_iters corrections have been made
     void iterativeCompute( T const & tolerance, unsigned const & num_iters = 10);
 
     /// Adds to the matrix A_mat terms for minimization of second derivative, weighted
     /// with parameter lambda.
     void applySmoothing(T lambda, gsSparseMatrix<T> & A_mat);
     gsSparseMatrix<T> smoothingMatrix(T lambda) const;
-    /// Assembles system for the least square fit.
+    /// Assembles system for the least square fit. If \a A_mat is
+    /// empty, it is initialized with the sparsity pattern of the
+    /// system first. The data points are assembled in parallel, each
+    /// thread scattering into its own array of values of the pattern.
     void assembleSystem(gsSparseMatrix<T>& A_mat, gsMatrix<T>& B);
 
 
@@ -117,7 +130,7 @@ public:
     /// Returns the basis of the approximation
     const gsBasis<T> & getBasis() const {return *static_cast<const gsBasis<T>*>(m_basis);}
 
-    void setBasis(gsBasis<T> & basis) {m_basis=&basis;}
+    void setBasis(gsBasis<T> & basis) {m_basis=&basis; m_A.resize(0,0);}
 
     /// returns the parameter values
     gsMatrix<T> & getreturnParamValues() {return m_param_values;}
@@ -134,6 +147,7 @@ public:
     {
 	m_constraintsLHS = lhs;
 	m_constraintsRHS = rhs;
+	m_A.resize(0,0); // the pattern of the system changes
     }
 
     /// Sets constraints on that the coefficients of the resulting geometry have to conform to.
@@ -159,6 +173,14 @@ private:
     /// Extends the system of equations by taking constraints into account.
     void extendSystem(gsSparseMatrix<T>& A_mat, gsMatrix<T>& m_B);
 
+    /// Initializes \a A_mat with the sparsity pattern of the system:
+    /// all pairs of basis functions with a common element in their
+    /// supports, and the entries of the constraints.
+    void initSystemPattern(gsSparseMatrix<T>& A_mat) const;
+
+    /// Assembles and solves the system, see compute() and refit()
+    void fit(T lambda, bool reuse);
+
 protected:
 
     //gsOptionList
@@ -204,6 +226,16 @@ protected:
     /// Bezier and B-spline techniques, Section 4.7.
     gsMatrix<T>       m_constraintsRHS;
 
+    /// System matrix of the last fit. Its pattern is kept, refits
+    /// only reassemble the values (in place).
+    gsSparseMatrix<T> m_A;
+
+    /// Solver of the last fit, refers to m_A
+    typename gsSparseSolver<T>::BiCGSTABILUT m_solver;
+
+    /// Number of iterations of the last solve with a fresh preconditioner
+    index_t m_solverIterations;
+
 private:
     //void applySmoothing(T lambda, gsMatrix<T> & A_mat);
 
@@ -18,6 +18,7 @@
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsNurbs/gsBSpline.h>
 #include <gsTensor/gsTensorDomainIterator.h>
+#include <gsUtils/gsThreaded.h>
 
 
 
@@ -44,6 +45,8 @@ gsFitting<T>::  gsFitting(gsMatrix<T> const & param_values,
     m_result = nullptr;
     m_basis = &basis;
     m_points.transposeInPlace();
+    m_last_lambda = 0;
+    m_solverIterations = 0;
 
     m_offset.resize(2);
     m_offset[0] = 0;
@@ -62,76 +65,124 @@ gsFitting<T>::gsFitting(gsMatrix<T> const& param_values,
     m_basis = &mbasis;
     m_points.transposeInPlace();
     m_offset = give(offset);
+    m_last_lambda = 0;
+    m_solverIterations = 0;
 }
 
 template<class T>
 void gsFitting<T>::compute(T lambda)
+{
+    fit(lambda, false);
+}
+
+template<class T>
+void gsFitting<T>::refit()
+{
+    fit(m_last_lambda, true);
+}
+
+template<class T>
+void gsFitting<T>::fit(T lambda, bool reuse)
 {
     m_last_lambda = lambda;
 
+    const index_t num_basis = m_basis->size();
+    const index_t num_rows  = num_basis + m_constraintsLHS.rows();
+    const short_t dimension = m_points.cols();
+
+    // Nothing to reuse before the first fit (eg. refit() is called
+    // before compute(), when there are no previous coefficients)
+    if ( 0 == m_A.nonZeros() || (!m_result && 0 == m_mresult.getMappedCoefs().size()) )
+        reuse = false;
+
+    // The coefficients of the previous fit are the initial guess of a refit
+    gsMatrix<T> x;
+    if ( reuse )
+    {
+        if ( m_result )
+            x = m_result->coefs();
+        else
+            x = m_mresult.getMappedCoefs();
+        reuse = ( x.rows() == num_basis && x.cols() == dimension );
+    }
+
     // Wipe out previous result
     if ( m_result )
         delete m_result;
+    m_result = nullptr;
 
-    const int num_basis = m_basis->size();
-    const short_t dimension = m_points.cols();
-    
-    //left side matrix
-    //gsMatrix<T> A_mat(num_basis,num_basis);
-    gsSparseMatrix<T> A_mat(num_basis + m_constraintsLHS.rows(), num_basis + m_constraintsLHS.rows());
-    //gsMatrix<T>A_mat(num_basis,num_basis);
-    //To optimize sparse matrix an estimation of nonzero elements per
-    //column can be given here
-    int nonZerosPerCol = 1;
-    for (int i = 0; i < m_basis->domainDim(); ++i) // to do: improve
-        // nonZerosPerCol *= m_basis->degree(i) + 1;
-        nonZerosPerCol *= ( 2 * m_basis->basis(0).degree(i) + 1 ) * 4;
-    // TODO: improve by taking constraints nonzeros into account.
-    A_mat.reservePerColumn( nonZerosPerCol );
+    // A refit keeps the sparsity pattern and reassembles the values
+    // in place. The solver refers to m_A, therefore it sees the new
+    // values while keeping the incomplete LU factors of the previous
+    // fit.
+    if ( !reuse || m_A.rows() != num_rows || 0 == m_A.nonZeros() )
+    {
+        initSystemPattern(m_A);
+        reuse = false;
+    }
+    else
+        m_A.coeffs().setZero();
+    const index_t nnz = m_A.nonZeros();
 
     //right side vector (more dimensional!)
-    gsMatrix<T> m_B(num_basis + m_constraintsRHS.rows(), dimension);
+    gsMatrix<T> m_B(num_rows, dimension);
     m_B.setZero();  // enusure that all entries are zero in the beginning
 
     // building the matrix A and the vector b of the system of linear
     // equations A*x==b
 
-    assembleSystem(A_mat, m_B);
-
+    assembleSystem(m_A, m_B);
 
     // --- Smoothing matrix computation
     //test degree >=3
     if(lambda > 0)
-      applySmoothing(lambda, A_mat);
+      applySmoothing(lambda, m_A);
 
     if(m_constraintsLHS.rows() > 0)
-	extendSystem(A_mat, m_B);
+	extendSystem(m_A, m_B);
 
-    //Solving the system of linear equations A*x=b (works directly for a right side which has a dimension with higher than 1)
-
-    //gsDebugVar( A_mat.nonZerosPerCol().maxCoeff() );
-    //gsDebugVar( A_mat.nonZerosPerCol().minCoeff() );
-    A_mat.makeCompressed();
-
-    typename gsSparseSolver<T>::BiCGSTABILUT solver( A_mat );
+    // If entries outside of the pattern were added, the matrix was
+    // reallocated: the solver has to analyze the new pattern
+    if ( !m_A.isCompressed() || m_A.nonZeros() != nnz )
+    {
+        m_A.makeCompressed();
+        reuse = false;
+    }
 
-    if ( solver.preconditioner().info() != gsEigen::Success )
+    //Solving the system of linear equations A*x=b (works directly for a right side which has a dimension with higher than 1)
+    if ( reuse )
     {
-        gsWarn<<  "The preconditioner failed. Aborting.\n";
-        
-        return;
+        // The Lagrange multipliers of the constraints start from zero
+        x.conservativeResize(num_rows, gsEigen::NoChange);
+        x.bottomRows(num_rows - num_basis).setZero();
+
+        // Fall back to a new preconditioner if the old one needs
+        // clearly more iterations than it did for its own matrix
+        m_solver.setMaxIterations( 2 * m_solverIterations + 10 );
+        const gsMatrix<T> guess = give(x);
+        x = m_solver.solveWithGuess(m_B, guess);
+        reuse = ( m_solver.info() == gsEigen::Success );
     }
-    // Solves for many right hand side  columns
-    gsMatrix<T> x;
 
-    x = solver.solve(m_B); //toDense()
+    if ( !reuse )
+    {
+        m_solver.setMaxIterations( 2 * num_rows );
+        m_solver.compute( m_A );
+
+        if ( m_solver.preconditioner().info() != gsEigen::Success )
+        {
+            gsWarn<<  "The preconditioner failed. Aborting.\n";
+            m_A.resize(0,0);
+            return;
+        }
+        // Solves for many right hand side  columns
+        x = m_solver.solve(m_B); //toDense()
+        m_solverIterations = m_solver.iterations();
+    }
 
     // If there were constraints, we obtained too many coefficients.
     x.conservativeResize(num_basis, gsEigen::NoChange);
 
-    //gsMatrix<T> x (m_B.rows(), m_B.cols());
-    //x=A_mat.fullPivHouseholderQr().solve( m_B);
-    // Solves for many right hand side  columns
     // finally generate the B-spline curve
 
     if (const gsBasis<T> * bb = dynamic_cast<const gsBasis<T> *>(m_basis))
@@ -140,6 +191,22 @@ void gsFitting<T>::compute(T lambda)
         m_mresult = gsMappedSpline<2,T> ( *static_cast<gsMappedBasis<2,T>*>(m_basis),give(x));
 }
 
+template<class T>
+void gsFitting<T>::iterativeCompute(T const & tolerance, unsigned const & num_iters)
+{
+    if ( !m_result )
+        compute(m_last_lambda);
+    if ( !m_result ) // failed or not a gsBasis
+        return;
+
+    computeMaxNormErrors();
+    for (unsigned it = 0; it < num_iters && m_max_error > tolerance; ++it)
+    {
+        parameterCorrection(1e-8, 1);
+        computeMaxNormErrors();
+    }
+}
+
 template <class T>
 void gsFitting<T>::parameterCorrection(T accuracy,
                                        index_t maxIter,
@@ -211,7 +278,7 @@ void gsFitting<T>::parameterCorrection(T accuracy,
         }
 
         // refit
-        compute(m_last_lambda);
+        refit();
     }
 }
 
@@ -220,40 +287,178 @@ template <class T>
 void gsFitting<T>::assembleSystem(gsSparseMatrix<T>& A_mat,
                                   gsMatrix<T>& m_B)
 {
+    if ( 0 == A_mat.nonZeros() )
+        initSystemPattern(A_mat);
+    A_mat.makeCompressed();
+
     const int num_patches ( m_basis->nPieces() ); //initialize
+    const index_t blockSize = 256; // points evaluated at once
+    const index_t nnz = A_mat.nonZeros();
+    const index_t * outer = A_mat.outerIndexPtr();
+    const index_t * inner = A_mat.innerIndexPtr();
 
-    //for computing the value of the basis function
-    gsMatrix<T> value, curr_point;
-    gsMatrix<index_t> actives;    
+    // Thread-local values of the matrix, in the order of its pattern,
+    // and of the right-hand side
+    util::gsThreaded<gsMatrix<T> > localA, localB;
+    gsSparseEntries<T> extra; // entries outside of the pattern
 
-    for (index_t h = 0; h < num_patches; h++ )
+#   pragma omp parallel
     {
-        auto & basis = m_basis->basis(h);
+        gsMatrix<T> & valA = localA.mine();
+        gsMatrix<T> & valB = localB.mine();
+        valA.setZero(nnz, 1);
+        valB.setZero(m_B.rows(), m_B.cols());
+        gsSparseEntries<T> myExtra;
 
-//#   pragma omp parallel for default(shared) private(curr_point,actives,value)
-        for (index_t k = m_offset[h]; k < m_offset[h+1]; ++k)
+        //for computing the value of the basis function
+        gsMatrix<T> values;
+        gsMatrix<index_t> actives;
+
+        for (index_t h = 0; h < num_patches; h++ )
         {
-            curr_point = m_param_values.col(k);
+            auto & basis = m_basis->basis(h);
+            const index_t first = m_offset[h];
+            const index_t numPts = m_offset[h+1] - first;
+            const index_t numBlocks = (numPts + blockSize - 1) / blockSize;
+
+#           pragma omp for schedule(dynamic)
+            for (index_t b = 0; b < numBlocks; ++b)
+            {
+                const index_t k0 = first + b * blockSize;
+                const index_t nk = math::min(blockSize, first + numPts - k0);
 
-            //computing the values of the basis functions at the current point
-            basis.eval_into(curr_point, value);
+                //computing the values of the basis functions at the points
+                basis.eval_into(m_param_values.middleCols(k0, nk), values);
 
-            // which functions have been computed i.e. which are active
-            basis.active_into(curr_point, actives);
+                // which functions have been computed i.e. which are active
+                basis.active_into(m_param_values.middleCols(k0, nk), actives);
 
-            const index_t numActive = actives.rows();
+                const index_t numActive = actives.rows();
 
-            for (index_t i = 0; i != numActive; ++i)
+                for (index_t k = 0; k != nk; ++k)
+                    for (index_t i = 0; i != numActive; ++i)
+                    {
+                        const T vi = values(i, k);
+                        if ( 0 == vi ) continue; // also skips padded actives
+                        const index_t ii = actives(i, k);
+                        valB.row(ii) += vi * m_points.row(k0 + k);
+                        for (index_t j = 0; j != numActive; ++j)
+                        {
+                            const T vj = values(j, k);
+                            if ( 0 == vj ) continue;
+                            const index_t jj = actives(j, k);
+                            // position of (ii,jj) in the pattern
+                            const index_t * beg = inner + outer[jj];
+                            const index_t * end = inner + outer[jj+1];
+                            const index_t * pos = std::lower_bound(beg, end, ii);
+                            if ( pos != end && *pos == ii )
+                                valA.at(pos - inner) += vi * vj;
+                            else
+                                myExtra.add(ii, jj, vi * vj);
+                        }
+                    }
+            }
+        }
+
+        if ( !myExtra.empty() )
+        {
+#           pragma omp critical (gsFitting_assembleSystem)
+            extra.insert(extra.end(), myExtra.begin(), myExtra.end());
+        }
+
+        // Pairwise reduction of the thread-local values
+        localA.combine();
+        localB.combine();
+    }
+
+    A_mat.coeffs() += localA[0].array();
+    m_B += localB[0];
+
+    // Should not happen for a pattern from initSystemPattern(); the
+    // pattern of A_mat changes in this case
+    if ( !extra.empty() )
+    {
+        gsSparseMatrix<T> E(A_mat.rows(), A_mat.cols());
+        E.setFrom(extra);
+        A_mat += E;
+    }
+}
+
+template <class T>
+void gsFitting<T>::initSystemPattern(gsSparseMatrix<T>& A_mat) const
+{
+    const index_t num_basis = m_basis->size();
+    const index_t num_cons  = m_constraintsLHS.rows();
+    const int num_patches ( m_basis->nPieces() );
+
+    // Active functions of every element
+    std::vector<index_t> elActives, elStart(1, 0);
+    gsMatrix<index_t> actives;
+    for (index_t h = 0; h < num_patches; h++ )
+    {
+        auto & basis = m_basis->basis(h);
+        typename gsBasis<T>::domainIter domIt = basis.makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+        {
+            basis.active_into(domIt->center, actives);
+            elActives.insert(elActives.end(), actives.data(), actives.data() + actives.size());
+            elStart.push_back(elActives.size());
+        }
+    }
+    const index_t num_elements = elStart.size() - 1;
+
+    // Elements in the support of every function
+    std::vector<index_t> fnElements(elActives.size()), fnStart(num_basis + 1, 0);
+    for (size_t k = 0; k != elActives.size(); ++k)
+        ++fnStart[elActives[k] + 1];
+    for (index_t i = 0; i != num_basis; ++i)
+        fnStart[i + 1] += fnStart[i];
+    std::vector<index_t> pos(fnStart.begin(), fnStart.end() - 1);
+    for (index_t e = 0; e != num_elements; ++e)
+        for (index_t k = elStart[e]; k != elStart[e + 1]; ++k)
+            fnElements[pos[elActives[k]]++] = e;
+
+    // Rows of every column: the functions active on an element of
+    // its support, then the constraints it appears in
+    const gsSparseMatrix<T> lhsT = m_constraintsLHS.transpose();
+    std::vector<std::vector<index_t> > rows(num_basis + num_cons);
+#   pragma omp parallel
+    {
+        std::vector<index_t> mark(num_basis, -1);
+#       pragma omp for schedule(dynamic, 64)
+        for (index_t j = 0; j < num_basis; ++j)
+        {
+            std::vector<index_t> & col = rows[j];
+            for (index_t k = fnStart[j]; k != fnStart[j + 1]; ++k)
             {
-                const index_t ii = actives.at(i);
-//#           pragma omp critical (acc_m_B)
-                m_B.row(ii) += value.at(i) * m_points.row(k);
-                for (index_t j = 0; j != numActive; ++j)
-//#               pragma omp critical (acc_A_mat)
-                    A_mat(ii, actives.at(j)) += value.at(i) * value.at(j);
+                const index_t e = fnElements[k];
+                for (index_t l = elStart[e]; l != elStart[e + 1]; ++l)
+                    if ( mark[elActives[l]] != j )
+                    {
+                        mark[elActives[l]] = j;
+                        col.push_back(elActives[l]);
+                    }
             }
+            std::sort(col.begin(), col.end());
+            if ( num_cons > 0 )
+                for (typename gsSparseMatrix<T>::InnerIterator it(m_constraintsLHS, j); it; ++it)
+                    col.push_back(num_basis + it.row());
         }
     }
+    for (index_t r = 0; r < num_cons; ++r)
+        for (typename gsSparseMatrix<T>::InnerIterator it(lhsT, r); it; ++it)
+            rows[num_basis + r].push_back(it.row());
+
+    gsVector<index_t> nnz(num_basis + num_cons);
+    for (index_t j = 0; j != nnz.size(); ++j)
+        nnz[j] = rows[j].size();
+
+    A_mat.resize(num_basis + num_cons, num_basis + num_cons);
+    A_mat.reserve(nnz);
+    for (index_t j = 0; j != nnz.size(); ++j)
+        for (size_t k = 0; k != rows[j].size(); ++k)
+            A_mat.insert(rows[j][k], j) = 0;
+    A_mat.makeCompressed();
 }
 
 template <class T>
@@ -241,9 +241,9 @@ protected:
          * @brief Get lambdas
          * The lambdas are returned.
          *
-         * @return lambdas
+         * @return lambdas, stored sparsely over all vertices of the mesh
          */
-        const std::vector<T> &getLambdas() const;
+        const gsSparseVector<T> &getLambdas() const;
 
     private:
         /**
@@ -256,7 +256,7 @@ protected:
         void calculateLambdas(const size_t N, VectorType& points);
 
         size_t m_vertexIndex; ///< vertex index
-        std::vector<T> m_lambdas; ///< lambdas
+        gsSparseVector<T> m_lambdas; ///< lambdas, nonzero only for the neighbours
 
     };
 
@@ -308,9 +308,9 @@ protected:
          *
          * This method returns a vector that stores the lambdas.
          *
-         * @return vector of lambdas
+         * @return sparse vector of lambdas
          */
-        const std::vector<T> &getLambdas(const size_t i) const;
+        const gsSparseVector<T> &getLambdas(const size_t i) const;
 
         /**
          * @brief Get boundary corners depending on the method
@@ -369,6 +369,19 @@ protected:
     */
     void constructAndSolveEquationSystem(const Neighbourhood &neighbourhood, const size_t n, const size_t N);
 
+    /**
+    * @brief Solves the sparse system A X = B for both parameter coordinates at once
+    *
+    * The option "solver" selects the sparse solver. For "BiCGSTABILUT" the
+    * iteration starts from the given \a X (warm start) and stops at the
+    * tolerance "precision"; any other name is passed to gsSparseSolver::get.
+    *
+    * @param[in] A sparse system matrix
+    * @param[in] B right-hand side, one column per parameter coordinate
+    * @param[in,out] X initial guess on input, solution on output
+    */
+    void solveSystem(const gsSparseMatrix<T> &A, const gsMatrix<T> &B, gsMatrix<T> &X) const;
+
     std::vector<size_t> indices(const gsMatrix<T>& vertices) const
     {
         std::vector<size_t> result;
@@ -42,11 +42,13 @@ gsOptionList gsParametrization<T>::defaultOptions()
     opt.addReal("range", "in case of restrict or opposite", 0.1);
     opt.addInt("number", "number of corners, in case of corners", 4);
     opt.addReal("precision", "precision to calculate", 1E-8);
+    opt.addString("solver", "sparse solver for the parameter points: LU (direct) or BiCGSTABILUT (iterative, warm-started from the current parameter points)", "LU");
     return opt;
 }
 
 template<class T>
-gsParametrization<T>::gsParametrization(const gsMesh<T> &mesh, const gsOptionList & list) : m_mesh(mesh)
+gsParametrization<T>::gsParametrization(const gsMesh<T> &mesh, const gsOptionList & list)
+    : m_mesh(mesh), m_options(defaultOptions())
 {
     m_options.update(list, gsOptionList::addIfUnknown);
 }
@@ -123,34 +125,62 @@ void gsParametrization<T>::constructAndSolveEquationSystem(const Neighbourhood &
                                                            const size_t n,
                                                            const size_t N)
 {
-    gsMatrix<T> A;
-    A.resize(n, n);
-    std::vector<T> lambdas;
-    gsVector<T> b1(n), b2(n);
-    b1.setZero(); b2.setZero();
+    gsSparseEntries<T> entries;
+    entries.reserve(7 * n); // about six neighbours per inner vertex
+    gsMatrix<T> b(n, 2), x(n, 2);
+    b.setZero();
 
     for (size_t i = 0; i < n; i++)
     {
-        lambdas = neighbourhood.getLambdas(i);
-        for (size_t j = 0; j < n; j++)
+        entries.add(i, i, (T)(1));
+        const gsSparseVector<T> & lambdas = neighbourhood.getLambdas(i);
+        for (typename gsSparseVector<T>::InnerIterator it(lambdas); it; ++it)
         {
-            A(i, j) = ( i==j ? (T)(1) : -lambdas[j] );
-        }
-
-        for (size_t j = n; j < N; j++)
-        {
-            b1(i) += (lambdas[j]) * (m_parameterPoints[j][0]);
-            b2(i) += (lambdas[j]) * (m_parameterPoints[j][1]);
+            const size_t j = it.index();
+            if (j < n)
+            {
+                if (j != i)
+                    entries.add(i, j, -it.value());
+            }
+            else
+                b.row(i) += it.value() * m_parameterPoints[j].transpose();
         }
+        x.row(i) = m_parameterPoints[i].transpose();
     }
 
-    gsVector<T> u(n), v(n);
-    gsEigen::PartialPivLU<typename gsMatrix<T>::Base> LU = A.partialPivLu();
-    u = LU.solve(b1);
-    v = LU.solve(b2);
+    gsSparseMatrix<T> A(n, n);
+    A.setFrom(entries);
+    A.makeCompressed();
+    solveSystem(A, b, x);
 
     for (size_t i = 0; i < n; i++)
-        m_parameterPoints[i] << u(i), v(i);
+        m_parameterPoints[i] << x(i, 0), x(i, 1);
+}
+
+template<class T>
+void gsParametrization<T>::solveSystem(const gsSparseMatrix<T> &A,
+                                       const gsMatrix<T> &B,
+                                       gsMatrix<T> &X) const
+{
+    const std::string slv = m_options.getString("solver");
+    if (slv == "BiCGSTABILUT")
+    {
+        typename gsSparseSolver<T>::BiCGSTABILUT solver;
+        solver.setTolerance(m_options.getReal("precision"));
+        solver.compute(A);
+        gsMatrix<T> guess = X;
+        X = solver.solveWithGuess(B, guess);
+        if (solver.info() != gsEigen::Success)
+            gsWarn << "gsParametrization: BiCGSTAB did not converge, error "
+                   << solver.error() << " after " << solver.iterations() << " iterations.\n";
+    }
+    else
+    {
+        typename gsSparseSolver<T>::uPtr solver = gsSparseSolver<T>::get(slv);
+        solver->compute(A);
+        GISMO_ENSURE(solver->succeed(), "gsParametrization: factorization with " << slv << " failed.");
+        X = solver->solve(B);
+    }
 }
 
 template<class T>
@@ -276,7 +306,7 @@ gsParametrization<T>::Neighbourhood::Neighbourhood(const gsHalfEdgeMesh<T> & mes
 }
 
 template<class T>
-const std::vector<T>& gsParametrization<T>::Neighbourhood::getLambdas(const size_t i) const
+const gsSparseVector<T>& gsParametrization<T>::Neighbourhood::getLambdas(const size_t i) const
 {
     return m_localParametrizations[i].getLambdas();
 }
@@ -563,14 +593,11 @@ gsParametrization<T>::LocalParametrization::LocalParametrization(const gsHalfEdg
         }
             break;
         case 2:
-            m_lambdas.reserve(meshInfo.getNumberOfVertices());
-            for(size_t j=1; j <= meshInfo.getNumberOfVertices(); j++)
-            {
-                m_lambdas.push_back(0); // Lambda(m_vertexIndex, j, 0)
-            }
+            m_lambdas.resize(meshInfo.getNumberOfVertices());
+            m_lambdas.reserve(d);
             while(!indices.empty())
             {
-                m_lambdas[indices.front()-1] += (1./d);
+                m_lambdas.coeffRef(indices.front()-1) += (1./d);
                 indices.pop_front();
             }
             break;
@@ -583,14 +610,11 @@ gsParametrization<T>::LocalParametrization::LocalParametrization(const gsHalfEdg
                 sumOfDistances += *it;
             }
             T sumOfDistancesInv = 1./sumOfDistances;
-            m_lambdas.reserve(meshInfo.getNumberOfVertices());
-            for(size_t j=1; j <= meshInfo.getNumberOfVertices(); j++)
-            {
-                m_lambdas.push_back(0); //Lambda(m_vertexIndex, j, 0)
-            }
+            m_lambdas.resize(meshInfo.getNumberOfVertices());
+            m_lambdas.reserve(neighbourDistances.size());
             for(typename std::list<T>::iterator it = neighbourDistances.begin(); it != neighbourDistances.end(); it++)
             {
-                m_lambdas[indices.front()-1] += ((*it)*sumOfDistancesInv);
+                m_lambdas.coeffRef(indices.front()-1) += ((*it)*sumOfDistancesInv);
                 indices.pop_front();
             }
         }
@@ -601,7 +625,7 @@ gsParametrization<T>::LocalParametrization::LocalParametrization(const gsHalfEdg
 }
 
 template<class T>
-const std::vector<T>& gsParametrization<T>::LocalParametrization::getLambdas() const
+const gsSparseVector<T>& gsParametrization<T>::LocalParametrization::getLambdas() const
 {
     return m_lambdas;
 }
@@ -615,13 +639,10 @@ const std::vector<T>& gsParametrization<T>::LocalParametrization::getLambdas() c
 template<class T>
 void gsParametrization<T>::LocalParametrization::calculateLambdas(const size_t N, VectorType& points)
 {
-    m_lambdas.reserve(N);
-    for(size_t j=1; j <= N; j++)
-    {
-        m_lambdas.push_back(0); //Lambda(m_vertexIndex, j, 0)
-    }
     Point2D p(0, 0, 0);
     size_t d = points.size();
+    m_lambdas.resize(N);
+    m_lambdas.reserve(d);
     std::vector<T> my(d, 0);
     size_t l=1;
     size_t steps = 0;
@@ -657,19 +678,17 @@ void gsParametrization<T>::LocalParametrization::calculateLambdas(const size_t N
         }
         for(size_t k = 1; k <= d; k++)
         {
-            m_lambdas[points[k-1].getVertexIndex()-1] += (my[k-1]);
+            if (my[k-1] != 0)
+                m_lambdas.coeffRef(points[k-1].getVertexIndex()-1) += (my[k-1]);
         }
         std::fill(my.begin(), my.end(), 0);
         l++;
     }
-    for(typename std::vector<T>::iterator it=m_lambdas.begin(); it != m_lambdas.end(); it++)
-    {
-        *it /= d;
-    }
-    for(typename std::vector<T>::iterator it=m_lambdas.begin(); it != m_lambdas.end(); it++)
+    m_lambdas /= (T)(d);
+    for(typename gsSparseVector<T>::InnerIterator it(m_lambdas); it; ++it)
     {
-        if(*it < 0)
-            gsInfo << *it << "\n";
+        if(it.value() < 0)
+            gsInfo << it.value() << "\n";
     }
 }
 
@@ -156,7 +156,7 @@ protected:
      * the current vertex
      * @param vertex the id of the current vertex
      */
-    void updateLambdasWithTwins(std::vector<T>& lambdas,
+    void updateLambdasWithTwins(gsSparseVector<T>& lambdas,
                                 size_t vertexId) const;
 
     // From here on the visualisation functions.
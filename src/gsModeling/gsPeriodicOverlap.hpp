@@ -104,27 +104,28 @@ void gsPeriodicOverlap<T>::constructAndSolveEquationSystem(const Neighbourhood &
                                                            const size_t N)
 {
     size_t numTwins = m_twins.size();
-    gsMatrix<T> LHS(N + numTwins, N + numTwins);
-    gsMatrix<T> RHS(N + numTwins, 2);
-    // prevent Valgrind warnings
-    LHS.setZero();
+    gsSparseEntries<T> entries;
+    entries.reserve(7 * n + (N - n) + 2 * numTwins);
+    gsMatrix<T> RHS(N + numTwins, 2), sol(N + numTwins, 2);
     RHS.setZero();
-    std::vector<T> lambdas;
+    sol.setZero();
 
     // interior points
     for (size_t i = 0; i < n; i++)
     {
-        lambdas = neighbourhood.getLambdas(i);
+        gsSparseVector<T> lambdas = neighbourhood.getLambdas(i);
         updateLambdasWithTwins(lambdas, i+1);
 
-        for (size_t j = 0; j < N + numTwins; j++)
-            LHS(i, j) = ( i==j ? (T)(1) : -lambdas[j] );
+        entries.add(i, i, (T)(1));
+        for (typename gsSparseVector<T>::InnerIterator it(lambdas); it; ++it)
+            if (static_cast<size_t>(it.index()) != i)
+                entries.add(i, it.index(), -it.value());
     }
 
     // points on the lower and upper boundary
     for (size_t i=n; i<N; i++)
     {
-        LHS(i, i)  = (T)(1);
+        entries.add(i, i, (T)(1));
         RHS.row(i) = this->m_parameterPoints[i];
     }
 
@@ -134,15 +135,21 @@ void gsPeriodicOverlap<T>::constructAndSolveEquationSystem(const Neighbourhood &
         size_t first   = m_twins[i-N].first-1;
         size_t second  = m_twins[i-N].second-1;
 
-        LHS(i, first)  = (T)( 1);
-        LHS(i, second) = (T)(-1);
+        entries.add(i, first , (T)( 1));
+        entries.add(i, second, (T)(-1));
 
         RHS(i, 0)      = (T)(-1);
         RHS(i, 1)      = (T)( 0);
     }
 
-    gsEigen::PartialPivLU<typename gsMatrix<T>::Base> LU = LHS.partialPivLu();
-    gsMatrix<T> sol = LU.solve(RHS);
+    // warm start from the current parameter points
+    for (size_t i = 0; i < N && i < this->m_parameterPoints.size(); i++)
+        sol.row(i) = this->m_parameterPoints[i].transpose();
+
+    gsSparseMatrix<T> LHS(N + numTwins, N + numTwins);
+    LHS.setFrom(entries);
+    LHS.makeCompressed();
+    this->solveSystem(LHS, RHS, sol);
     for (size_t i = 0; i < N; i++)
     {
         this->m_parameterPoints[i] << sol(i, 0), sol(i, 1);
@@ -150,12 +157,10 @@ void gsPeriodicOverlap<T>::constructAndSolveEquationSystem(const Neighbourhood &
 }
 
 template <class T>
-void gsPeriodicOverlap<T>::updateLambdasWithTwins(std::vector<T>& lambdas,
+void gsPeriodicOverlap<T>::updateLambdasWithTwins(gsSparseVector<T>& lambdas,
                                                   size_t vertexId) const
 {
-    lambdas.reserve(lambdas.size() + m_twins.size());
-    for(size_t i=0; i<m_twins.size(); i++)
-        lambdas.push_back(0);
+    lambdas.conservativeResize(lambdas.size() + m_twins.size());
 
     // Determine, whether vertexId is on the left or right side of the overlap.
     bool isLeft  = false;
@@ -175,6 +180,9 @@ void gsPeriodicOverlap<T>::updateLambdasWithTwins(std::vector<T>& lambdas,
         }
     }
 
+    // Nothing happens to vertices that are not on the overlap.
+    if(!isLeft && !isRight)
+        return;
 
     for(size_t i=0; i<m_twins.size(); i++)
     {
@@ -182,19 +190,21 @@ void gsPeriodicOverlap<T>::updateLambdasWithTwins(std::vector<T>& lambdas,
         size_t second=m_twins[i].second-1;
 
         // Left vertex swaps all its right neighbours.
-        if(isRight && first > second && lambdas[second] != 0)
+        if(isRight && first > second && lambdas.coeff(second) != 0)
         {
-            lambdas[first] = lambdas[second];
-            lambdas[second] = 0;
+            const T lambda = lambdas.coeff(second);
+            lambdas.coeffRef(first) = lambda;
+            lambdas.coeffRef(second) = 0;
         }
         // Right vertex swaps all its left neighbours
-        else if(isLeft && first < second && lambdas[first] != 0)
+        else if(isLeft && first < second && lambdas.coeff(first) != 0)
         {
-            lambdas[second] = lambdas[first];
-            lambdas[first] = 0;
+            const T lambda = lambdas.coeff(first);
+            lambdas.coeffRef(second) = lambda;
+            lambdas.coeffRef(first) = 0;
         }
-        // Nothing happens to vertices that are not on the overlap.         
     }
+    lambdas.prune((T)(0));
 }
 
 template<class T>
@@ -219,9 +219,15 @@ void gsPeriodicParametrization<T>::initParameterPoints()
     size_t n = this->m_mesh.getNumberOfInnerVertices();
     size_t N = this->m_mesh.getNumberOfVertices();
 
-    this->m_parameterPoints.reserve(N);
-    for (size_t i = 1; i <= n; i++)
-        this->m_parameterPoints.push_back(Point2D(0, 0, i));
+    // The inner points of a previous solution are kept as the initial
+    // guess of an iterative solver.
+    if (this->m_parameterPoints.size() != N)
+    {
+        this->m_parameterPoints.clear();
+        this->m_parameterPoints.reserve(N);
+        for (size_t i = 1; i <= n; i++)
+            this->m_parameterPoints.push_back(Point2D(0, 0, i));
+    }
 
     // Save the sizes as size_t to compare without warnings.
     size_t v0size = m_paramsV0.cols();
@@ -129,42 +129,48 @@ void gsPeriodicStitch<T>::constructAndSolveEquationSystem(const Neighbourhood &n
                                                                          const size_t n,
                                                                          const size_t N)
 {
-    std::vector<T> lambdas;
-    gsMatrix<T> LHS(N, N);
-    gsMatrix<T> RHS(N, 2);
-
-    // prevent Valgrind warnings
-    LHS.setZero();
+    gsSparseEntries<T> entries;
+    entries.reserve(7 * n + (N - n));
+    gsMatrix<T> RHS(N, 2), sol(N, 2);
     RHS.setZero();
 
     // interior points
     for (size_t i = 0; i < n; i++)
     {
-        lambdas = neighbourhood.getLambdas(i);
-        for (size_t j = 0; j < N; j++)
+        entries.add(i, i, (T)(1));
+        const gsSparseVector<T> & lambdas = neighbourhood.getLambdas(i);
+        for (typename gsSparseVector<T>::InnerIterator it(lambdas); it; ++it)
         {
-            LHS(i, j) = ( i==j ? (T)(1) : -lambdas[j] );
+            const size_t j = it.index();
+            if (j != i)
+                entries.add(i, j, -it.value());
 
             // If your neighbour is across the stitch, its contributions appear
             // on the right hand-side multiplied by +1 or -1. Write the equations
             // down if it is unclear. (-;
             if(m_corrections(i, j) == 1)
-                RHS(i, 0) -= lambdas[j];
+                RHS(i, 0) -= it.value();
             else if(m_corrections(i, j) == -1)
-                RHS(i, 0) += lambdas[j];
+                RHS(i, 0) += it.value();
         }
     }
 
     // points on the lower and upper boundary
     for (size_t i=n; i<N; i++)
     {
-        LHS(i, i) = (T)(1);
+        entries.add(i, i, (T)(1));
         RHS.row(i) = this->m_parameterPoints[i];
     }
 
+    // warm start from the current parameter points
+    for (size_t i = 0; i < N; i++)
+        sol.row(i) = this->m_parameterPoints[i].transpose();
+
     // Solve the system and save the results.
-    gsEigen::PartialPivLU<typename gsMatrix<T>::Base> LU = LHS.partialPivLu();
-    gsMatrix<T> sol = LU.solve(RHS);
+    gsSparseMatrix<T> LHS(N, N);
+    LHS.setFrom(entries);
+    LHS.makeCompressed();
+    this->solveSystem(LHS, RHS, sol);
     for (size_t i = 0; i < n; i++)
     {
         this->m_parameterPoints[i] << sol(i, 0), sol(i, 1);
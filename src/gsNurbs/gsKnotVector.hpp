@@ -66,10 +66,19 @@ public:
         }
 
         // Case: mode: none/default
-        std::istringstream str;
-        str.str( node->value() );
-        for (T knot; gsGetReal(str, knot);)
-            knotValues.push_back(knot);
+        gsXmlAttribute * sz = node->first_attribute("size");
+        if ( sz ) // binary data
+        {
+            knotValues.resize( atoi(sz->value()) );
+            GISMO_ENSURE( getArrayFromXml(node, knotValues.data(), knotValues.size()),
+                          "Encoding of binary knot-vector data is missing (encoding attribute).");
+        }
+        else
+        {
+            const char * str = node->value();
+            for (T knot; gsReadValue(str, knot);)
+                knotValues.push_back(knot);
+        }
 
         result = gsKnotVector<T>(give(knotValues), p);
     }
@@ -78,16 +87,20 @@ public:
     {
         // Write the knot values (for now WITH multiplicities)
         std::ostringstream str;
-        str << std::setprecision(REAL_DIG+1);
-
-        for ( typename gsKnotVector<T>::iterator it = obj.begin();
-              it != obj.end(); ++it )
+        gsXmlNode * tmp = internal::makeNode("KnotVector", data);
+        if ( putArrayToXml(obj.data(), obj.size(), tmp, data) )
+            tmp->append_attribute( makeAttribute("size", obj.size(), data) );
+        else
         {
-            str << *it <<" ";
+            str << std::setprecision(REAL_DIG+1);
+            for ( typename gsKnotVector<T>::iterator it = obj.begin();
+                  it != obj.end(); ++it )
+            {
+                str << *it <<" ";
+            }
+            tmp->value( makeValue(str.str(), data) );
         }
 
-        // Make a new XML KnotVector node
-        gsXmlNode * tmp = internal::makeNode("KnotVector", str.str(), data);
         // Append the degree attribure
         str.str(std::string());// clean the ostream
         str<< obj.m_deg;
@@ -44,6 +44,12 @@ namespace gismo
 ///
 /// but much faster.
 ///
+/// If OpenMP is enabled and there are several operators whose total
+/// size (the sum of their rows times the number of columns of the
+/// input) reaches parallelThreshold, the operators \f$ A_i \f$ are
+/// applied concurrently, the largest ones first. Thus, distinct
+/// operators must not share any mutable state.
+///
 /// @ingroup Solvers
 
 template<class T>
@@ -65,7 +71,7 @@ public:
     typedef memory::unique_ptr<gsAdditiveOp> uPtr;
 
     /// Default Constructor
-    gsAdditiveOp() : m_transfers(), m_ops() {}
+    gsAdditiveOp() : m_transfers(), m_ops(), m_work(0), m_parallelThreshold(defaultParallelThreshold) {}
 
     /// @brief Constructor
     ///
@@ -74,12 +80,13 @@ public:
     /// @param transfers  transfer matrices \f$ T_i \f$
     /// @param ops        local operators \f$ A_i \f$
     gsAdditiveOp(TransferContainer transfers, OpContainer ops)
-    : m_transfers(), m_ops(give(ops))
+    : m_transfers(), m_ops(give(ops)), m_parallelThreshold(defaultParallelThreshold)
     {
         const size_t sz = transfers.size();
         m_transfers.reserve(sz);
         for (size_t i=0; i<sz; ++i)
             m_transfers.push_back( transfers[i].moveToPtr() );
+        initOrder();
 #ifndef NDEBUG
         GISMO_ASSERT( m_transfers.size() == m_ops.size(), "Sizes do not agree" );
         for (size_t i=0; i<sz; ++i)
@@ -99,8 +106,9 @@ public:
     /// @param transfers  transfer matrices \f$ T_i \f$
     /// @param ops        local operators \f$ A_i \f$
     gsAdditiveOp(TransferPtrContainer transfers, OpContainer ops)
-    : m_transfers(give(transfers)), m_ops(give(ops))
+    : m_transfers(give(transfers)), m_ops(give(ops)), m_parallelThreshold(defaultParallelThreshold)
     {
+        initOrder();
 #ifndef NDEBUG
         GISMO_ASSERT( m_transfers.size() == m_ops.size(), "Sizes do not agree" );
         const size_t sz = m_transfers.size();
@@ -147,6 +155,7 @@ public:
     {
         m_transfers.push_back(transfer.moveToPtr());
         m_ops.push_back(give(op));
+        insertOrder();
         GISMO_ASSERT ( m_transfers.back()->rows()==m_transfers[0]->rows()
                        && m_transfers.back()->cols() == m_ops.back()->rows()
                        && m_ops.back()->cols() == m_ops.back()->rows(),
@@ -161,6 +170,7 @@ public:
     {
         m_transfers.push_back(give(transfer));
         m_ops.push_back(give(op));
+        insertOrder();
         GISMO_ASSERT ( m_transfers.back()->rows()==m_transfers[0]->rows()
                        && m_transfers.back()->cols() == m_ops.back()->rows()
                        && m_ops.back()->cols() == m_ops.back()->rows(),
@@ -181,9 +191,31 @@ public:
         return m_transfers[0]->rows();
     }
 
+    /// Default for parallelThreshold()
+    static const index_t defaultParallelThreshold = 2000;
+
+    /// Total size of the operators (sum of their rows times the number
+    /// of columns of the input) from which on they are applied by
+    /// several threads
+    index_t parallelThreshold() const { return m_parallelThreshold; }
+
+    /// Sets parallelThreshold(); a value of zero applies any two or
+    /// more operators concurrently
+    void setParallelThreshold(index_t threshold) { m_parallelThreshold = threshold; }
+
+private:
+    /// Sorts the operators by decreasing size into m_order
+    void initOrder();
+
+    /// Inserts the last operator into m_order
+    void insertOrder();
+
 protected:
     TransferPtrContainer m_transfers;   ///< Transfer matrices
     OpContainer m_ops;                  ///< Operators to be applied in the subspaces
+    std::vector<index_t> m_order;       ///< Operators by decreasing size
+    index_t m_work;                     ///< Sum of the rows of the operators
+    index_t m_parallelThreshold;        ///< See parallelThreshold()
 
 };
 
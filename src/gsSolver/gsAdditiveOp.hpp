@@ -11,6 +11,8 @@
     Author(s): S. Takacs
 */
 
+#include <gsUtils/gsThreaded.h>
+
 namespace gismo
 {
 
@@ -19,17 +21,77 @@ void gsAdditiveOp<T>::apply(const gsMatrix<T>& input, gsMatrix<T>& x) const
 {
     GISMO_ASSERT( this->rows() == input.rows(), "The dimensions do not fit." );
 
-    x.setZero( input.rows(), input.cols() );
-
     const index_t n = m_ops.size();
-    gsMatrix<T> res_local, corr_local;
 
+#   ifdef _OPENMP
+    const bool parallel = n > 1 && m_work * input.cols() >= m_parallelThreshold
+        && omp_get_max_threads() > 1 && !omp_in_parallel();
+#   else
+    const bool parallel = false;
+#   endif
+
+    if ( !parallel ) // little work is not worth the threads
+    {
+        gsMatrix<T> res_local, corr_local;
+        x.setZero( input.rows(), input.cols() );
+        for (index_t i=0; i<n; ++i)
+        {
+            res_local.noalias() = m_transfers[i]->transpose()*input;
+            m_ops[i]->apply(res_local, corr_local);
+            x.noalias() += *(m_transfers[i])*corr_local;
+        }
+        return;
+    }
+
+    // The operators are dealt out to the threads, the largest ones
+    // first. The static schedule and the pairwise reduction of the
+    // thread-local results make the summation order independent of
+    // the timing of the threads.
+    util::gsThreaded<gsMatrix<T> > buf;
+#   pragma omp parallel
+    {
+        gsMatrix<T> res_local, corr_local;
+        gsMatrix<T> & x_local = buf.mine();
+        x_local.setZero( input.rows(), input.cols() );
+
+#       pragma omp for schedule(static,1)
+        for (index_t j=0; j<n; ++j)
+        {
+            const index_t i = m_order[j];
+            res_local.noalias() = m_transfers[i]->transpose()*input;
+            m_ops[i]->apply(res_local, corr_local);
+            x_local.noalias() += *(m_transfers[i])*corr_local;
+        }
+
+        gsMatrix<T> & all = buf.combine();
+#       pragma omp master
+        x.swap(all);
+    }
+}
+
+template<typename T>
+void gsAdditiveOp<T>::initOrder()
+{
+    const index_t n = m_ops.size();
+    m_order.resize(n);
+    m_work = 0;
     for (index_t i=0; i<n; ++i)
     {
-        res_local.noalias() = m_transfers[i]->transpose()*input;
-        m_ops[i]->apply(res_local, corr_local);
-        x.noalias() += *(m_transfers[i])*corr_local;
+        m_order[i] = i;
+        m_work += m_ops[i]->rows();
     }
+    std::stable_sort(m_order.begin(), m_order.end(),
+        [this](index_t a, index_t b) { return m_ops[a]->rows() > m_ops[b]->rows(); });
+}
+
+template<typename T>
+void gsAdditiveOp<T>::insertOrder()
+{
+    const index_t i = m_ops.size() - 1;
+    const index_t sz = m_ops[i]->rows();
+    m_work += sz;
+    m_order.insert(std::upper_bound(m_order.begin(), m_order.end(), sz,
+        [this](index_t a, index_t b) { return a > m_ops[b]->rows(); }), i);
 }
 
 } // namespace gismo
@@ -23,6 +23,15 @@ namespace gismo
 ///
 /// where \f$ A \otimes B = ( a_{11} B \  a_{12} B \ ... ;  a_{21} B \  a_{22} B \ ... ; ... ) \f$.
 ///
+/// The operator is applied as a sequence of mode products, where the
+/// factors are applied to the columns of the reshaped tensor without
+/// transposing it. Factors which are given as gsMatrixOp of a gsMatrix
+/// or a gsSparseMatrix are multiplied blockwise and in parallel (OpenMP);
+/// other factors are applied to a transposed copy of the data.
+/// The intermediate results are kept in a workspace, so applying the
+/// operator repeatedly does not allocate memory. Due to the workspace,
+/// the same object must not be applied by several threads simultaneously.
+///
 /// \ingroup Solver
 template <class T>
 class gsKroneckerOp GISMO_FINAL : public gsLinearOperator<T>
@@ -81,8 +90,13 @@ public:
     /// Apply provided linear operators without the need of creating an object
     static void apply(const std::vector<BasePtr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x);
 
+    /// Apply provided linear operators, using (and keeping) the buffers in \a work
+    static void apply(const std::vector<BasePtr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x,
+                      std::vector< gsMatrix<T> > & work);
+
 private:
     std::vector<BasePtr> m_ops;
+    mutable std::vector< gsMatrix<T> > m_work; ///< Workspace for apply
 };
 
 }
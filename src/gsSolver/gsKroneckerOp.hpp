@@ -11,12 +11,92 @@
     Author(s): C. Hofreither, S. Takacs
 */
 
+#include <gsSolver/gsMatrixOp.h>
+
 namespace gismo
 {
 
 /// @cond
+namespace internal
+{
+
+// Number of rows (or columns) of the blocks processed at once, such
+// that a block of the input and of the output fit into the cache
+inline index_t kroneckerBlockSize(index_t c, index_t r)
+{ return math::max<index_t>(8, 32768 / (c + r)); }
+
+// Applies the matrix A (of size r x c) to mode of extent c of the
+// tensor src, which is stored as R consecutive slices of size L x c
+// (column-major). The result is written to dst as R slices of size
+// L x r, ie. dst_s = src_s * A^T for every slice s. For L == 1 this is
+// the product dst = A * src with src of size c x R.
+template <typename T, typename MatrixType>
+void kroneckerModeProduct(const MatrixType & A, const T * src, T * dst,
+                          index_t L, index_t R)
+{
+    typedef gsEigen::Matrix<T, Dynamic, Dynamic, ColMajor> Dense;
+    typedef gsEigen::Map<const Dense, 0, gsEigen::OuterStride<> > ConstMap;
+    typedef gsEigen::Map<Dense, 0, gsEigen::OuterStride<> > Map;
+
+    const index_t c = A.cols(), r = A.rows();
+    const index_t bs = kroneckerBlockSize(c, r);
+
+    if (1 == L)
+    {
+        const index_t nb = (R + bs - 1) / bs;
+#       pragma omp parallel for schedule(static) if (nb > 1)
+        for (index_t k = 0; k < nb; ++k)
+        {
+            const index_t j0 = k * bs, m = math::min(bs, R - j0);
+            Map(dst + j0 * r, r, m, gsEigen::OuterStride<>(r)).noalias() =
+                A * ConstMap(src + j0 * c, c, m, gsEigen::OuterStride<>(c));
+        }
+    }
+    else
+    {
+        const index_t nbL = (L + bs - 1) / bs, nb = nbL * R;
+#       pragma omp parallel for schedule(static) if (nb > 1)
+        for (index_t k = 0; k < nb; ++k)
+        {
+            const index_t s = k / nbL, l0 = (k % nbL) * bs, m = math::min(bs, L - l0);
+            Map(dst + s * L * r + l0, m, r, gsEigen::OuterStride<>(L)).noalias() =
+                ConstMap(src + s * L * c + l0, m, c, gsEigen::OuterStride<>(L)) * A.transpose();
+        }
+    }
+}
+
+// Transposes each of the R consecutive slices of src of size L x c
+// (column-major), ie. dst_s = src_s^T, blockwise and in parallel
+template <typename T>
+void kroneckerTransposeSlices(const T * src, T * dst, index_t L, index_t c, index_t R)
+{
+    typedef gsEigen::Matrix<T, Dynamic, Dynamic, ColMajor> Dense;
+    typedef gsEigen::Map<const Dense, 0, gsEigen::OuterStride<> > ConstMap;
+    typedef gsEigen::Map<Dense, 0, gsEigen::OuterStride<> > Map;
+
+    const index_t bs = kroneckerBlockSize(c, c);
+    const index_t nbL = (L + bs - 1) / bs, nb = nbL * R;
+#   pragma omp parallel for schedule(static) if (nb > 1)
+    for (index_t k = 0; k < nb; ++k)
+    {
+        const index_t s = k / nbL, l0 = (k % nbL) * bs, m = math::min(bs, L - l0);
+        Map(dst + s * L * c + l0 * c, c, m, gsEigen::OuterStride<>(c)) =
+            ConstMap(src + s * L * c + l0, m, c, gsEigen::OuterStride<>(L)).transpose();
+    }
+}
+
+} // namespace internal
+
 template <typename T>
 void gsKroneckerOp<T>::apply(const std::vector<typename gsLinearOperator<T>::Ptr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x)
+{
+    std::vector< gsMatrix<T> > work;
+    apply(ops, input, x, work);
+}
+
+template <typename T>
+void gsKroneckerOp<T>::apply(const std::vector<typename gsLinearOperator<T>::Ptr> & ops, const gsMatrix<T> & input, gsMatrix<T> & x,
+                             std::vector< gsMatrix<T> > & work)
 {
     GISMO_ASSERT( !ops.empty(), "Zero-term Kronecker product" );
     const index_t nrOps = ops.size();
@@ -27,65 +107,80 @@ void gsKroneckerOp<T>::apply(const std::vector<typename gsLinearOperator<T>::Ptr
         return;
     }
 
-    //index_t rows = 1; // we don't compute rows as we do not need it
     index_t sz = 1;
-
     for (index_t i = 0; i < nrOps; ++i)
-    {
-        //rows *= ops[i]->rows();
         sz *= ops[i]->cols();
-    }
 
     GISMO_ASSERT (sz == input.rows(), "The input matrix has wrong size.");
     const index_t n = input.cols();
 
-    // Note: algorithm relies on col-major matrices
-    gsMatrix<T, Dynamic, Dynamic, ColMajor> q0, q1;
-    gsMatrix<T> temp;
+    // Two buffers for the intermediate results (used alternately) and
+    // two for the factors which are not matrices
+    work.resize(4);
 
-    // size: sz x n
-    q0 = input;
+    // The tensor is stored column-major, the last operator acts on the
+    // fastest index and the columns of the input form the slowest index.
+    // Before applying operator i, it is of size L x cols_i x R, where
+    // L = rows_{i+1} * ... * rows_{nrOps-1} and R = cols_0 * ... * cols_{i-1} * n.
+    const T * src = input.data();
+    index_t L = 1, R = sz * n;
+    index_t cur = 0;
 
     for (index_t i = nrOps - 1; i >= 0; --i)
     {
+        const typename gsLinearOperator<T>::Ptr & op = ops[i];
+        const index_t c = op->cols();
+        const index_t r = op->rows();
+        R /= c;
 
-        const index_t cols_i = ops[i]->cols();
-        const index_t rows_i = ops[i]->rows();
-        const index_t r_i  = sz / cols_i;
-
-        // Re-order right-hand sides
-        q0.resize(cols_i, n * r_i);
-
-        // Apply operator
-        ops[i]->apply(q0, temp);
-        GISMO_ASSERT (temp.rows() == rows_i && temp.cols() == n * r_i, "The linear operator returned a matrix with unexpected size.");
+        gsMatrix<T> & dst = work[cur];
 
-        // Transpose solution component-wise
-        if (n == 1)
-            q1 = temp.transpose();
+        if ( const gsMatrixOp< gsMatrix<T> > * mop = dynamic_cast<const gsMatrixOp< gsMatrix<T> > *>(op.get()) )
+        {
+            dst.resize(L * r, R);
+            internal::kroneckerModeProduct(mop->matrix(), src, dst.data(), L, R);
+        }
+        else if ( const gsMatrixOp< gsSparseMatrix<T> > * sop = dynamic_cast<const gsMatrixOp< gsSparseMatrix<T> > *>(op.get()) )
+        {
+            dst.resize(L * r, R);
+            internal::kroneckerModeProduct(sop->matrix(), src, dst.data(), L, R);
+        }
+        else if (1 == L)
+        {
+            // The fibers are the columns already
+            gsMatrix<T> & in = work[2];
+            in = gsAsConstMatrix<T>(src, c, R);
+            op->apply(in, dst);
+            GISMO_ASSERT (dst.rows() == r && dst.cols() == R, "The linear operator returned a matrix with unexpected size.");
+        }
         else
         {
-            q1.resize(r_i, n * rows_i);
-            for (index_t k = 0; k != n; ++k)
-                q1.middleCols(k*rows_i, rows_i) = temp.middleCols(k*r_i, r_i).transpose();
+            // Move the fibers to the columns, apply and move them back
+            gsMatrix<T> & in = work[2], & out = work[3];
+            in.resize(c, L * R);
+            internal::kroneckerTransposeSlices(src, in.data(), L, c, R);
+            op->apply(in, out);
+            GISMO_ASSERT (out.rows() == r && out.cols() == L * R, "The linear operator returned a matrix with unexpected size.");
+            dst.resize(L * r, R);
+            internal::kroneckerTransposeSlices(out.data(), dst.data(), r, L, R);
         }
 
-        q1.swap( q0 ); // move solution as next right-hand side
-        sz = ( sz / cols_i) * rows_i; // update now the dimensionality such that in the end sz = rows
-        //sz % cols_i == 0, since sz *= ops[i]->cols();
+        src = dst.data();
+        L *= r;
+        cur = 1 - cur;
     }
 
-    //GISMO_ASSERT (sz == rows, "Internal error."); // see one above
+    GISMO_ASSERT (R == n, "Internal error.");
 
-    q0.resize(sz, n);
-    x.swap( q0 );
+    x.swap( work[1 - cur] );
+    x.resize(L, n);
 }
 /// @endcond
 
 template <typename T>
 void gsKroneckerOp<T>::apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
 {
-    apply(m_ops, input, x);
+    apply(m_ops, input, x, m_work);
 }
 
 template <typename T>
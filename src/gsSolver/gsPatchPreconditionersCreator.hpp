@@ -337,11 +337,11 @@ typename gsPatchPreconditionersCreator<T>::OpUPtr gsPatchPreconditionersCreator<
         // Finally, we store the eigenvectors
         ev.swap(const_cast<evMatrix&>(ges.eigenvectors()));
 
-        // These are the operators representing the eigenvectors
-        typename gsMatrixOp< gsMatrix<T> >::Ptr matrOp = makeMatrixOp( ev.moveToPtr() );
-        Qop [i] = matrOp;
-        // Here we are safe as long as we do not want to apply QTop after Qop got destroyed.
-        QTop[i] = makeMatrixOp( matrOp->matrix().transpose() );
+        // These are the operators representing the eigenvectors. The transpose is stored
+        // explicitly such that gsKroneckerOp can use its fast path for dense matrices.
+        gsMatrix<T> evTr = ev.transpose();
+        Qop [i] = makeMatrixOp( ev.moveToPtr() );
+        QTop[i] = makeMatrixOp( evTr.moveToPtr() );
     }
 
     GISMO_ASSERT( glob == 1,
@@ -14,6 +14,7 @@
 
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsSolver/gsPreconditioner.h>
+#include <gsSolver/gsMatrixOp.h>
 
 namespace gismo
 {
@@ -24,6 +25,16 @@ template<typename T>
 void gaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const gsMatrix<T>& f);
 template<typename T>
 void reverseGaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const gsMatrix<T>& f);
+template<typename T>
+void multicolorOrdering(const gsSparseMatrix<T> & A, std::vector<index_t> & colorStart, std::vector<index_t> & rows);
+template<typename T>
+void multicolorGaussSeidelSweep(const gsSparseMatrix<T> & A, const std::vector<index_t> & colorStart,
+                                const std::vector<index_t> & rows, gsMatrix<T>& x, const gsMatrix<T>& f, bool reverse);
+template<typename T>
+void chebyshevSweep(const gsSparseMatrix<T> & A, const gsMatrix<T> & invDiag, T lower, T upper,
+                    index_t degree, gsMatrix<T>& x, const gsMatrix<T>& f);
+template<typename T>
+T estimateMaxEigenvalueJacobi(const gsSparseMatrix<T> & A, index_t steps);
 } // namespace internal
 
 /// @brief Richardson preconditioner
@@ -388,6 +399,253 @@ template <class Derived>
 typename gsGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
 { return gsGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat); }
 
+/// @brief Multicolor Gauss-Seidel preconditioner
+///
+/// The unknowns are grouped into colors such that unknowns of the same
+/// color are not coupled by the matrix (greedy coloring of the matrix
+/// graph). A sweep updates the colors one after the other; the
+/// unknowns of one color are updated in parallel (OpenMP). The result
+/// depends on the coloring, but not on the number of threads.
+///
+/// `ordering` can be `gsGaussSeidel::forward`, `gsGaussSeidel::reverse` or `gsGaussSeidel::symmetric`,
+/// referring to the order of the colors.
+///
+/// The matrix is supposed to be symmetric.
+///
+/// \ingroup Solver
+template <typename MatrixType, gsGaussSeidel::ordering ordering = gsGaussSeidel::forward>
+class gsMulticolorGaussSeidelOp GISMO_FINAL : public gsPreconditionerOp<typename MatrixType::Scalar>
+{
+    typedef memory::shared_ptr<MatrixType>          MatrixPtr;
+    typedef typename MatrixType::Nested             NestedMatrix;
+
+public:
+    /// Scalar type
+    typedef typename MatrixType::Scalar T;
+
+    /// Shared pointer for gsMulticolorGaussSeidelOp
+    typedef memory::shared_ptr< gsMulticolorGaussSeidelOp > Ptr;
+
+    /// Unique pointer for gsMulticolorGaussSeidelOp
+    typedef memory::unique_ptr< gsMulticolorGaussSeidelOp > uPtr;
+
+    /// Base class
+    typedef gsPreconditionerOp<T> Base;
+
+    /// Constructor with given matrix
+    explicit gsMulticolorGaussSeidelOp(const MatrixType& mat)
+    : m_mat(), m_expr(mat.derived())
+    { internal::multicolorOrdering<T>(m_expr, m_colorStart, m_rows); }
+
+    /// Constructor with shared pointer to matrix
+    explicit gsMulticolorGaussSeidelOp(const MatrixPtr& mat)
+    : m_mat(mat), m_expr(m_mat->derived())
+    { internal::multicolorOrdering<T>(m_expr, m_colorStart, m_rows); }
+
+    static uPtr make(const MatrixType& mat)
+    { return memory::make_unique( new gsMulticolorGaussSeidelOp(mat) ); }
+
+    static uPtr make(const MatrixPtr& mat)
+    { return memory::make_unique( new gsMulticolorGaussSeidelOp(mat) ); }
+
+    void step(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        if ( ordering != gsGaussSeidel::reverse )
+            internal::multicolorGaussSeidelSweep<T>(m_expr,m_colorStart,m_rows,x,rhs,false);
+        if ( ordering != gsGaussSeidel::forward )
+            internal::multicolorGaussSeidelSweep<T>(m_expr,m_colorStart,m_rows,x,rhs,true);
+    }
+
+    void stepT(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        if ( ordering != gsGaussSeidel::forward )
+            internal::multicolorGaussSeidelSweep<T>(m_expr,m_colorStart,m_rows,x,rhs,false);
+        if ( ordering != gsGaussSeidel::reverse )
+            internal::multicolorGaussSeidelSweep<T>(m_expr,m_colorStart,m_rows,x,rhs,true);
+    }
+
+    index_t rows() const {return m_expr.rows();}
+    index_t cols() const {return m_expr.cols();}
+
+    /// Returns the number of colors
+    index_t numColors() const { return m_colorStart.size()-1; }
+
+    /// Returns the matrix
+    NestedMatrix matrix() const { return m_expr; }
+
+    /// Returns a shared pinter to the matrix
+    MatrixPtr    matrixPtr() const {
+        GISMO_ENSURE( m_mat, "A shared pointer is only available if it was provided to gsMulticolorGaussSeidelOp." );
+        return m_mat;
+    }
+
+    typename gsLinearOperator<T>::Ptr underlyingOp() const { return makeMatrixOp(m_mat); }
+
+private:
+    const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
+    NestedMatrix    m_expr; ///< Nested Eigen expression
+    std::vector<index_t> m_colorStart; ///< Start of each color in m_rows
+    std::vector<index_t> m_rows;       ///< Unknowns, ordered by color
+};
+
+/// @brief Returns a smart pointer to a multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMulticolorGaussSeidelOp
+template <class Derived>
+typename gsMulticolorGaussSeidelOp<Derived>::uPtr makeMulticolorGaussSeidelOp(const gsEigen::EigenBase<Derived>& mat)
+{ return gsMulticolorGaussSeidelOp<Derived>::make(mat.derived()); }
+
+/// @brief Returns a smart pointer to a multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMulticolorGaussSeidelOp
+template <class Derived>
+typename gsMulticolorGaussSeidelOp<Derived>::uPtr makeMulticolorGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
+{ return gsMulticolorGaussSeidelOp<Derived>::make(mat); }
+
+/// @brief Returns a smart pointer to a symmetric multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMulticolorGaussSeidelOp
+template <class Derived>
+typename gsMulticolorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricMulticolorGaussSeidelOp(const gsEigen::EigenBase<Derived>& mat)
+{ return gsMulticolorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat.derived()); }
+
+/// @brief Returns a smart pointer to a symmetric multicolor Gauss-Seidel operator referring on \a mat
+/// \relates gsMulticolorGaussSeidelOp
+template <class Derived>
+typename gsMulticolorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::uPtr makeSymmetricMulticolorGaussSeidelOp(const memory::shared_ptr<Derived>& mat)
+{ return gsMulticolorGaussSeidelOp<Derived,gsGaussSeidel::symmetric>::make(mat); }
+
+/// @brief Chebyshev polynomial smoother
+///
+/// One step applies the Chebyshev iteration of the given degree to the
+/// Jacobi preconditioned system \f$ D^{-1}A \f$, which damps the
+/// eigencomponents in the interval [upper/SmoothingRange, upper]. The
+/// upper bound is the largest eigenvalue of \f$ D^{-1}A \f$, estimated
+/// by the Lanczos process of gsConjugateGradient when the operator is
+/// set up, times a safety factor.
+/// The matrix-vector products are computed in parallel (OpenMP).
+///
+/// The matrix is supposed to be symmetric and positive definite.
+///
+/// \ingroup Solver
+template <typename MatrixType>
+class gsChebyshevOp GISMO_FINAL : public gsPreconditionerOp<typename MatrixType::Scalar>
+{
+    typedef memory::shared_ptr<MatrixType>          MatrixPtr;
+    typedef typename MatrixType::Nested             NestedMatrix;
+
+public:
+    /// Scalar type
+    typedef typename MatrixType::Scalar T;
+
+    /// Shared pointer for gsChebyshevOp
+    typedef memory::shared_ptr< gsChebyshevOp > Ptr;
+
+    /// Unique pointer for gsChebyshevOp
+    typedef memory::unique_ptr< gsChebyshevOp > uPtr;
+
+    /// Base class
+    typedef gsPreconditionerOp<T> Base;
+
+    /// Constructor with given matrix
+    explicit gsChebyshevOp(const MatrixType& mat, index_t degree = 2)
+    : m_mat(), m_expr(mat.derived()), m_degree(degree)
+    { init(); }
+
+    /// Constructor with shared pointer to matrix
+    explicit gsChebyshevOp(const MatrixPtr& mat, index_t degree = 2)
+    : m_mat(mat), m_expr(m_mat->derived()), m_degree(degree)
+    { init(); }
+
+    static uPtr make(const MatrixType& mat, index_t degree = 2)
+    { return memory::make_unique( new gsChebyshevOp(mat, degree) ); }
+
+    static uPtr make(const MatrixPtr& mat, index_t degree = 2)
+    { return memory::make_unique( new gsChebyshevOp(mat, degree) ); }
+
+    void step(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    {
+        const T upper = m_safety * m_maxEig;
+        internal::chebyshevSweep<T>(m_expr, m_invDiag, upper / m_range, upper,
+                                    m_degree, x, rhs);
+    }
+
+    index_t rows() const {return m_expr.rows();}
+    index_t cols() const {return m_expr.cols();}
+
+    /// Sets the largest eigenvalue of \f$ D^{-1}A \f$, if known, instead of the estimate
+    void setMaxEigenvalue(const T lambda) { m_maxEig = lambda; }
+
+    /// Returns the (estimated) largest eigenvalue of \f$ D^{-1}A \f$
+    T maxEigenvalue() const { return m_maxEig; }
+
+    /// Get the default options as gsOptionList object
+    static gsOptionList defaultOptions()
+    {
+        gsOptionList opt = Base::defaultOptions();
+        opt.addInt ( "Degree", "Degree of the Chebyshev polynomial", 2 );
+        opt.addReal( "SmoothingRange", "Ratio of the upper and the lower end of the damped eigenvalue interval", 30 );
+        opt.addReal( "EigSafety", "Safety factor for the estimated largest eigenvalue", 1.1 );
+        opt.addInt ( "EigSteps", "Number of Lanczos steps for estimating the largest eigenvalue", 10 );
+        return opt;
+    }
+
+    /// Set options based on a gsOptionList object
+    virtual void setOptions(const gsOptionList & opt)
+    {
+        Base::setOptions(opt);
+        m_degree = opt.askInt ( "Degree", m_degree );
+        m_range  = opt.askReal( "SmoothingRange", m_range );
+        m_safety = opt.askReal( "EigSafety", m_safety );
+        const index_t steps = opt.askInt( "EigSteps", m_eigSteps );
+        if (steps != m_eigSteps)
+        {
+            m_eigSteps = steps;
+            m_maxEig = internal::estimateMaxEigenvalueJacobi<T>(m_expr, m_eigSteps);
+        }
+    }
+
+    /// Returns the matrix
+    NestedMatrix matrix() const { return m_expr; }
+
+    /// Returns a shared pinter to the matrix
+    MatrixPtr    matrixPtr() const {
+        GISMO_ENSURE( m_mat, "A shared pointer is only available if it was provided to gsChebyshevOp." );
+        return m_mat;
+    }
+
+    typename gsLinearOperator<T>::Ptr underlyingOp() const { return makeMatrixOp(m_mat); }
+
+private:
+    void init()
+    {
+        m_invDiag = m_expr.diagonal().cwiseInverse();
+        m_range = 30;
+        m_safety = (T)(1.1);
+        m_eigSteps = 10;
+        m_maxEig = internal::estimateMaxEigenvalueJacobi<T>(m_expr, m_eigSteps);
+    }
+
+private:
+    const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
+    NestedMatrix    m_expr; ///< Nested Eigen expression
+    gsMatrix<T>     m_invDiag; ///< Inverse of the diagonal
+    index_t m_degree;   ///< Degree of the polynomial
+    T m_range;          ///< Ratio of upper and lower bound
+    T m_safety;         ///< Safety factor for the largest eigenvalue
+    index_t m_eigSteps; ///< Number of Lanczos steps
+    T m_maxEig;         ///< (Estimated) largest eigenvalue of D^{-1}A
+};
+
+/// @brief Returns a smart pointer to a Chebyshev smoother referring on \a mat
+/// \relates gsChebyshevOp
+template <class Derived>
+typename gsChebyshevOp<Derived>::uPtr makeChebyshevOp(const gsEigen::EigenBase<Derived>& mat, index_t degree = 2)
+{ return gsChebyshevOp<Derived>::make(mat.derived(), degree); }
+
+/// @brief Returns a smart pointer to a Chebyshev smoother referring on \a mat
+/// \relates gsChebyshevOp
+template <class Derived>
+typename gsChebyshevOp<Derived>::uPtr makeChebyshevOp(const memory::shared_ptr<Derived>& mat, index_t degree = 2)
+{ return gsChebyshevOp<Derived>::make(mat, degree); }
+
 /// @brief  Incomplete LU with thresholding preconditioner
 ///
 /// \ingroup Solvers
@@ -11,6 +11,8 @@
     Author(s): C. Hofreither
 */
 
+#include <gsSolver/gsConjugateGradient.h>
+
 namespace gismo
 {
 
@@ -67,6 +69,152 @@ void reverseGaussSeidelSweep(const gsSparseMatrix<T> & A, gsMatrix<T>& x, const
     }
 }
 
+template<typename T>
+void multicolorOrdering(const gsSparseMatrix<T> & A, std::vector<index_t> & colorStart, std::vector<index_t> & rows)
+{
+    GISMO_ASSERT( A.cols() == A.rows(), "The matrix is not square." );
+
+    // Greedy coloring of the matrix graph: every unknown gets the
+    // smallest color which is not used by its (already colored) neighbors
+    const index_t n = A.outerSize();
+    std::vector<index_t> color(n, -1), mark;
+    index_t numColors = 0;
+    for (index_t i = 0; i < n; ++i)
+    {
+        for (typename gsSparseMatrix<T>::InnerIterator it(A,i); it; ++it)
+        {
+            const index_t c = color[it.index()];
+            if (-1 != c) mark[c] = i;
+        }
+        index_t c = 0;
+        while (c < numColors && mark[c] == i) ++c;
+        if (c == numColors)
+        {
+            ++numColors;
+            mark.push_back(-1);
+        }
+        color[i] = c;
+    }
+
+    // Sort the unknowns by color (counting sort)
+    colorStart.assign(numColors+1, 0);
+    for (index_t i = 0; i < n; ++i)
+        ++colorStart[color[i]+1];
+    for (index_t c = 0; c < numColors; ++c)
+        colorStart[c+1] += colorStart[c];
+    rows.resize(n);
+    std::vector<index_t> pos(colorStart.begin(), colorStart.end()-1);
+    for (index_t i = 0; i < n; ++i)
+        rows[pos[color[i]]++] = i;
+}
+
+template<typename T>
+void multicolorGaussSeidelSweep(const gsSparseMatrix<T> & A, const std::vector<index_t> & colorStart,
+                                const std::vector<index_t> & rows, gsMatrix<T>& x, const gsMatrix<T>& f, bool reverse)
+{
+    GISMO_ASSERT( A.rows() == x.rows() && x.rows() == f.rows() && A.cols() == A.rows() && x.cols() == f.cols(),
+        "Dimensions do not match.");
+
+    GISMO_ASSERT( f.cols() == 1, "This operator is only implemented for a single right-hand side." );
+
+    const index_t numColors = colorStart.size() - 1;
+
+#   pragma omp parallel
+    for (index_t k = 0; k < numColors; ++k)
+    {
+        const index_t c = reverse ? numColors - 1 - k : k;
+        // The unknowns of one color are not coupled, so they can be
+        // updated independently. The implicit barrier at the end of
+        // the loop separates the colors.
+#       pragma omp for schedule(static)
+        for (index_t r = colorStart[c]; r < colorStart[c+1]; ++r)
+        {
+            const index_t i = rows[r];
+            T diag = 0;
+            T sum  = 0;
+
+            // A is supposed to be symmetric, so it doesn't matter if it's stored in row- or column-major order
+            for (typename gsSparseMatrix<T>::InnerIterator it(A,i); it; ++it)
+            {
+                sum += it.value() * x( it.index() );        // compute A.x
+                if (it.index() == i)
+                    diag = it.value();
+            }
+
+            x(i) += (f(i) - sum) / diag;
+        }
+    }
+}
+
+template<typename T>
+void chebyshevSweep(const gsSparseMatrix<T> & A, const gsMatrix<T> & invDiag, T lower, T upper,
+                    index_t degree, gsMatrix<T>& x, const gsMatrix<T>& f)
+{
+    GISMO_ASSERT( A.rows() == x.rows() && x.rows() == f.rows() && A.cols() == A.rows() && x.cols() == f.cols(),
+        "Dimensions do not match.");
+
+    GISMO_ASSERT( f.cols() == 1, "This operator is only implemented for a single right-hand side." );
+
+    GISMO_ASSERT( 0 < lower && lower < upper, "Invalid eigenvalue interval." );
+
+    // Chebyshev iteration for D^{-1}A on [lower, upper], see
+    // Y. Saad, Iterative methods for sparse linear systems, Alg. 12.1
+    const index_t n = A.outerSize();
+    const T theta = (upper + lower) / 2;
+    const T delta = (upper - lower) / 2;
+    const T sigma = theta / delta;
+    gsMatrix<T> r(n,1), d(n,1);
+
+#   pragma omp parallel
+{
+    T rho = 1 / sigma; // identical on all threads
+    for (index_t k = 0; k < degree; ++k)
+    {
+        // Preconditioned residual r = D^{-1}(f-Ax); A is supposed to
+        // be symmetric, so it doesn't matter if it's stored in row- or
+        // column-major order
+#       pragma omp for schedule(static)
+        for (index_t i = 0; i < n; ++i)
+        {
+            T sum = 0;
+            for (typename gsSparseMatrix<T>::InnerIterator it(A,i); it; ++it)
+                sum += it.value() * x( it.index() );
+            r(i) = invDiag(i) * ( f(i) - sum );
+        }
+
+        const T rhoNew = 1 / (2*sigma - rho);
+#       pragma omp for schedule(static)
+        for (index_t i = 0; i < n; ++i)
+        {
+            d(i) = ( 0 == k ? r(i) / theta
+                            : rhoNew * rho * d(i) + 2 * rhoNew / delta * r(i) );
+            x(i) += d(i);
+        }
+
+        if (0 != k) rho = rhoNew;
+    }
+}//omp parallel
+}
+
+template<typename T>
+T estimateMaxEigenvalueJacobi(const gsSparseMatrix<T> & A, index_t steps)
+{
+    // Lanczos process of the Jacobi preconditioned CG method
+    gsConjugateGradient<T> cg(A, makeJacobiOp(A));
+    cg.setCalcEigenvalues(true);
+    cg.setMaxIterations(math::min(steps, static_cast<index_t>(A.rows())));
+    cg.setTolerance(1e-10);
+
+    // The start vector is fixed, so that the estimate (and the
+    // smoother) is reproducible
+    gsMatrix<T> rhs, x, eigs;
+    rhs.setOnes(A.rows(), 1);
+    x.setZero(A.rows(), 1);
+    cg.solve(rhs, x);
+    cg.getEigenvalues(eigs);
+    return eigs.maxCoeff();
+}
+
 } // namespace internal
 
 } // namespace gismo
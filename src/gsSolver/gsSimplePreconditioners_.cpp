@@ -9,6 +9,12 @@ namespace internal
 
 TEMPLATE_INST void gaussSeidelSweep(const gsSparseMatrix<real_t> & A, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
 TEMPLATE_INST void reverseGaussSeidelSweep(const gsSparseMatrix<real_t> & A, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
+TEMPLATE_INST void multicolorOrdering(const gsSparseMatrix<real_t> & A, std::vector<index_t> & colorStart, std::vector<index_t> & rows);
+TEMPLATE_INST void multicolorGaussSeidelSweep(const gsSparseMatrix<real_t> & A, const std::vector<index_t> & colorStart,
+                                              const std::vector<index_t> & rows, gsMatrix<real_t>& x, const gsMatrix<real_t>& f, bool reverse);
+TEMPLATE_INST void chebyshevSweep(const gsSparseMatrix<real_t> & A, const gsMatrix<real_t> & invDiag, real_t lower, real_t upper,
+                                  index_t degree, gsMatrix<real_t>& x, const gsMatrix<real_t>& f);
+TEMPLATE_INST real_t estimateMaxEigenvalueJacobi(const gsSparseMatrix<real_t> & A, index_t steps);
 
 } // namespace internal
 
@@ -264,7 +264,58 @@ public:
     // Evaluates the second derivatives of the non-zero basis functions at value u.
     virtual void deriv2_into(const gsMatrix<T> & u, gsMatrix<T>& result ) const;
 
+    // see gsBasis for doxygen documentation
+    virtual void evalFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    // see gsBasis for doxygen documentation
+    virtual void derivFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    // see gsBasis for doxygen documentation
+    virtual void deriv2Func_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    // see gsBasis for doxygen documentation
+    virtual void evalAllDersFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs,
+                                      const unsigned n, std::vector<gsMatrix<T> >& result) const;
+
+    /// @brief Evaluates the nonzero basis functions and their
+    /// derivatives up to order \a n on a tensor grid of points, given
+    /// in tensor form (d coordinate-wise row vectors \a grid).
+    ///
+    /// The points are ordered lexicographically, the first coordinate
+    /// running fastest, as the nodes of a tensor quadrature rule. The
+    /// format of \a result is the one of evalAllDers_into. Every value
+    /// is obtained by one multiplication in a Kronecker product of the
+    /// univariate values.
+    void evalAllDersGrid_into(const std::vector<gsMatrix<T> > & grid, int n,
+                              std::vector<gsMatrix<T> >& result) const;
+
+    /// @brief Evaluates the function given by \a coefs and its
+    /// derivatives up to order \a n on a tensor grid of points, see
+    /// evalAllDersGrid_into.
+    ///
+    /// If all points lie in one element the local coefficients are
+    /// contracted one direction at a time (sum factorization), which
+    /// costs O(d p^{d+1}) per point instead of O(p^{2d}) for degree p
+    /// and about p+1 points per direction.
+    void evalAllDersFuncGrid_into(const std::vector<gsMatrix<T> > & grid,
+                                  const gsMatrix<T> & coefs, int n,
+                                  std::vector<gsMatrix<T> >& result) const;
+
+    /// Returns true if the columns of \a u form a tensor grid of
+    /// points (see evalAllDersGrid_into), whose coordinate-wise vectors
+    /// are then stored in \a grid
+    static bool isGrid(const gsMatrix<T> & u, std::vector<gsMatrix<T> > & grid);
+
 private:
+    // Structured evaluation on the grid: derivatives of order \a n
+    // (and all lower orders if \a all is true) of the basis
+    // functions, or of the function given by \a coefs if it is not
+    // null. Returns false if the function cannot be evaluated by sum
+    // factorization, ie. the points are in several elements.
+    bool evalGrid_into(const std::vector<gsMatrix<T> > & grid,
+                       const gsMatrix<T> * coefs, int n, bool all,
+                       std::vector<gsMatrix<T> >& result) const;
+
     // Internal function
     //
     // values: array of std::vectors of gsMatrix<T>
@@ -30,6 +30,79 @@
 namespace gismo
 {
 
+namespace internal
+{
+
+// Orders of differentiation in every direction (columns of result)
+// of the partial derivatives of order k, as in evalAllDers_into
+template<short_t d>
+void tensorDerivOrders(int k, gsMatrix<index_t> & result)
+{
+    gsVector<index_t> cc;
+    if (2 == k) // pure derivatives first, then the mixed ones in lex order
+    {
+        result.setZero(d, (d * (d + 1)) / 2);
+        index_t c = d;
+        for (short_t i = 0; i < d; ++i)
+        {
+            result(i, i) = 2;
+            for (short_t j = i + 1; j < d; ++j, ++c)
+                result(i, c) = result(j, c) = 1;
+        }
+        return;
+    }
+    result.resize(d, numCompositions(k, d));
+    index_t c = 0;
+    firstComposition(k, d, cc);
+    do { result.col(c++) = cc; } while (nextComposition(cc));
+}
+
+// Kronecker product of the univariate derivatives of orders ord[i],
+// i=0,..,d-1 (first direction fastest): one row per tensor basis
+// function and one column per grid point
+template<class T>
+void tensorGridProduct(const std::vector<gsMatrix<T> > values[], const short_t d,
+                       const index_t * ord, gsMatrix<T> & result, gsMatrix<T> & tmp)
+{
+    result = values[0][ord[0]];
+    for (short_t i = 1; i < d; ++i)
+    {
+        const gsMatrix<T> & ev = values[i][ord[i]];
+        const index_t r0 = result.rows(), c0 = result.cols();
+        tmp.resize(ev.rows() * r0, ev.cols() * c0);
+        for (index_t c = 0; c != ev.cols(); ++c)
+            for (index_t r = 0; r != ev.rows(); ++r)
+                tmp.block(r * r0, c * c0, r0, c0).noalias() = ev(r, c) * result;
+        result.swap(tmp);
+    }
+}
+
+// Sum factorization: contracts the local coefficients lc (one row per
+// tensor basis function) with the univariate derivatives of orders
+// ord[i], one direction at a time. On output result has one row per
+// column of lc and one column per grid point.
+template<class T>
+void tensorGridContract(const std::vector<gsMatrix<T> > values[], const short_t d,
+                        const index_t * ord, const gsMatrix<T> & lc,
+                        gsMatrix<T> & result, gsMatrix<T> & tmp)
+{
+    // The leading index of result is contracted and the new grid
+    // index is appended, so that the indices rotate
+    result = lc;
+    for (short_t i = 0; i < d; ++i)
+    {
+        const gsMatrix<T> & ev = values[i][ord[i]];
+        tmp.noalias() = gsAsConstMatrix<T>(result.data(), ev.rows(),
+                                           result.size() / ev.rows()).transpose() * ev;
+        result.swap(tmp);
+    }
+    tmp = gsAsConstMatrix<T>(result.data(), lc.cols(), result.size() / lc.cols());
+    result.swap(tmp);
+}
+
+} // namespace internal
+
+
 template<short_t d, class T>
 gsTensorBasis<d,T>::gsTensorBasis( Basis_t* x,  Basis_t* y)
 {
@@ -505,7 +578,13 @@ void gsTensorBasis<d,T>::eval_into(const gsMatrix<T> & u,
     GISMO_ASSERT( u.rows() == d, 
                   "Attempted to evaluate the tensor-basis on points with the wrong dimension" );
 
-    /// \todo more efficient ?
+    std::vector<gsMatrix<T> > grid, ev_grid;
+    if ( u.cols() > 1 && isGrid(u, grid) )
+    {
+        evalGrid_into(grid, NULL, 0, false, ev_grid);
+        result.swap(ev_grid.front());
+        return;
+    }
 
     gsMatrix<T> ev[d];
     gsVector<unsigned, d> v, size;
@@ -541,52 +620,190 @@ void gsTensorBasis<d,T>::eval_into(const gsMatrix<T> & u,
                                          gsMatrix<T> & result ) const
 {
 
-#if (0)
-    //~ version using the tensor structure; uses more memory, check
-    result.resize( coefs.cols(), u.cols() ) ;
+    this->evalFunc_into(u, coefs, result);
+}
+
+template<short_t d, class T>
+void gsTensorBasis<d,T>::evalFunc_into(const gsMatrix<T> & u,
+                                       const gsMatrix<T> & coefs,
+                                       gsMatrix<T>& result) const
+{
+    std::vector<gsMatrix<T> > grid, ev;
+    if ( u.cols() > 1 && isGrid(u, grid) && evalGrid_into(grid, &coefs, 0, false, ev) )
+        result.swap(ev.front());
+    else
+        gsBasis<T>::evalFunc_into(u, coefs, result);
+}
 
-    unsigned sz = this->size()/m_bases[0]->size();
-    unsigned n  = coefs.cols();
-    gsAsMatrix<T> cc(coefs.data(), m_bases[0]->size(),  n * sz);
-    gsMatrix<T> e0,e1; 
+template<short_t d, class T>
+void gsTensorBasis<d,T>::derivFunc_into(const gsMatrix<T> & u,
+                                        const gsMatrix<T> & coefs,
+                                        gsMatrix<T>& result) const
+{
+    std::vector<gsMatrix<T> > grid, ev;
+    if ( u.cols() > 1 && isGrid(u, grid) && evalGrid_into(grid, &coefs, 1, false, ev) )
+        result.swap(ev.back());
+    else
+        gsBasis<T>::derivFunc_into(u, coefs, result);
+}
 
-    for ( index_t j=0; j< u.cols() ; j++ ) // for all points (columns of u)
-    { // to try:: all points at once instead
-        gsMatrix<T> uu = u.col(j);
-        //gsDebug<< "uu : \n"<< uu <<std::endl;
-        //gsDebug<< "coefs: \n"<< cc <<std::endl;
-        
-        m_bases[0]->eval_into(uu.row(0), cc, e0);
-        
-        for ( short_t i=1; i< d ; ++i )
+template<short_t d, class T>
+void gsTensorBasis<d,T>::deriv2Func_into(const gsMatrix<T> & u,
+                                         const gsMatrix<T> & coefs,
+                                         gsMatrix<T>& result) const
+{
+    std::vector<gsMatrix<T> > grid, ev;
+    if ( u.cols() > 1 && isGrid(u, grid) && evalGrid_into(grid, &coefs, 2, false, ev) )
+        result.swap(ev.back());
+    else
+        gsBasis<T>::deriv2Func_into(u, coefs, result);
+}
+
+template<short_t d, class T>
+void gsTensorBasis<d,T>::evalAllDersFunc_into(const gsMatrix<T> & u,
+                                              const gsMatrix<T> & coefs,
+                                              const unsigned n,
+                                              std::vector<gsMatrix<T> >& result) const
+{
+    std::vector<gsMatrix<T> > grid;
+    if ( !(u.cols() > 1 && isGrid(u, grid) && evalGrid_into(grid, &coefs, n, true, result)) )
+        gsBasis<T>::evalAllDersFunc_into(u, coefs, n, result);
+}
+
+template<short_t d, class T>
+void gsTensorBasis<d,T>::evalAllDersGrid_into(const std::vector<gsMatrix<T> > & grid, int n,
+                                              std::vector<gsMatrix<T> >& result) const
+{
+    evalGrid_into(grid, NULL, n, true, result);
+}
+
+template<short_t d, class T>
+void gsTensorBasis<d,T>::evalAllDersFuncGrid_into(const std::vector<gsMatrix<T> > & grid,
+                                                  const gsMatrix<T> & coefs, int n,
+                                                  std::vector<gsMatrix<T> >& result) const
+{
+    if ( evalGrid_into(grid, &coefs, n, true, result) ) return;
+
+    // The points are in several elements, evaluate point-wise
+    gsVector<index_t, d> v, npt;
+    for (short_t i = 0; i < d; ++i)
+        npt[i] = grid[i].cols();
+    gsMatrix<T> u(d, npt.prod());
+    v.setZero();
+    index_t c = 0;
+    do
+    {
+        for (short_t i = 0; i < d; ++i)
+            u(i, c) = grid[i](0, v[i]);
+        ++c;
+    } while (nextLexicographic(v, npt));
+    gsBasis<T>::evalAllDersFunc_into(u, coefs, n, result);
+}
+
+template<short_t d, class T>
+bool gsTensorBasis<d,T>::isGrid(const gsMatrix<T> & u, std::vector<gsMatrix<T> > & grid)
+{
+    const index_t np = u.cols();
+    if ( u.rows() != d || 0 == np )
+        return false;
+
+    // Coordinates in direction i repeat with period q_i*stride_i
+    gsVector<index_t, d> q;
+    grid.resize(d);
+    index_t stride = 1;
+    for (short_t i = 0; i < d; ++i)
+    {
+        index_t k = 1;
+        if (i + 1 == d)
+            k = np / stride;
+        else
+            while ( k * stride < np && u(i, k * stride) != u(i, 0) ) ++k;
+        q[i] = k;
+        grid[i].resize(1, k);
+        for (index_t j = 0; j != k; ++j)
+            grid[i](0, j) = u(i, j * stride);
+        stride *= k;
+    }
+    if ( stride != np )
+        return false;
+
+    // Check all points
+    for (index_t j = 0; j != np; ++j)
+        for (index_t i = 0, r = j; i != d; r /= q[i], ++i)
+            if ( u(i, j) != grid[i](0, r % q[i]) )
+                return false;
+    return true;
+}
+
+template<short_t d, class T>
+bool gsTensorBasis<d,T>::evalGrid_into(const std::vector<gsMatrix<T> > & grid,
+                                       const gsMatrix<T> * coefs, int n, bool all,
+                                       std::vector<gsMatrix<T> >& result) const
+{
+    GISMO_ASSERT( static_cast<short_t>(grid.size()) == d, "Invalid grid dimension");
+
+    // Univariate derivatives at the grid coordinates
+    std::vector<gsMatrix<T> > values[d];
+    gsVector<index_t, d> nb_cwise, v;
+    index_t npts = 1;
+    for (short_t i = 0; i < d; ++i)
+    {
+        m_bases[i]->evalAllDers_into(grid[i], n, values[i]);
+        nb_cwise[i] = values[i].front().rows();
+        npts       *= grid[i].cols();
+    }
+    const index_t nb = nb_cwise.prod();
+
+    // Coefficients of the basis functions which are active on the points
+    gsMatrix<T> lc;
+    if (coefs)
+    {
+        gsVector<index_t, d> first, str;
+        gsMatrix<index_t> act;
+        for (short_t i = 0; i < d; ++i)
         {
-            sz /= m_bases[i]->size();
-            e0.resize( m_bases[i]->size(),  n * sz );
-            //gsDebug<< "e0 : \n"<< e0  <<"\n";
-            m_bases[i]->eval(uu.row(i), e0, e1);
-            //gsDebug<< "e1 : \n"<< e1 <<"\n";
-            std::swap(e0, e1);
+            m_bases[i]->active_into(grid[i], act);
+            first[i] = act(0, 0);
+            if ( (act.row(0).array() != first[i]).any() )
+                return false; // points in more than one element
+            str[i] = (0 == i ? 1 : str[i - 1] * m_bases[i - 1]->size());
         }
-        result->col(j) = e0;
+
+        lc.resize(nb, coefs->cols());
+        v.setZero();
+        index_t r = 0;
+        do {
+            lc.row(r++) = coefs->row( (first + v).dot(str) );
+        } while (nextLexicographic(v, nb_cwise));
     }
-    //gsDebug<< "final: \n"<< *result  <<std::endl;
-#endif
-  
-    // Default version - linear combination of basis functions
-    // Basis_t:: eval_into(u,coefs,result);
-    result.resize( coefs.cols(), u.cols() ) ;
-    gsMatrix<T> B ;
-    gsMatrix<index_t> ind;
-    
-    this->eval_into(u, B);   // col j = nonzero basis functions at column point u(..,j)
-    this->active_into(u,ind);// col j = indices of active functions at column point u(..,j)
-    
-    for ( index_t j=0; j< u.cols() ; j++ ) // for all points (columns of u)
+
+    gsMatrix<index_t> ords;
+    gsMatrix<T> tmp, buf;
+    result.resize(n + 1);
+    for (int k = (all ? 0 : n); k <= n; ++k)
     {
-        result.col(j) = coefs.row( ind(0,j) ) * B(0,j);
-        for ( index_t i = 1; i < ind.rows(); ++i ) // for all non-zero basis functions
-            result.col(j) += coefs.row( ind(i,j) ) * B(i,j); 
+        internal::tensorDerivOrders<d>(k, ords);
+        const index_t s = ords.cols(); // number of derivatives of order k
+        gsMatrix<T> & res = result[k];
+        res.resize(s * (coefs ? coefs->cols() : nb), npts);
+
+        for (index_t c = 0; c != s; ++c)
+        {
+            if (coefs)
+            {
+                internal::tensorGridContract<T>(values, d, ords.col(c).data(), lc, tmp, buf);
+                for (index_t j = 0; j != lc.cols(); ++j)
+                    res.row(j * s + c) = tmp.row(j);
+            }
+            else
+            {
+                internal::tensorGridProduct<T>(values, d, ords.col(c).data(), tmp, buf);
+                for (index_t r = 0; r != nb; ++r)
+                    res.row(r * s + c) = tmp.row(r);
+            }
+        }
     }
+    return true;
 }
 
 
@@ -594,6 +811,14 @@ template<short_t d, class T>
 void gsTensorBasis<d,T>::deriv_into(const gsMatrix<T> & u,
                                           gsMatrix<T>& result) const
 {
+    std::vector<gsMatrix<T> > grid, ev_grid;
+    if ( u.cols() > 1 && isGrid(u, grid) )
+    {
+        evalGrid_into(grid, NULL, 1, false, ev_grid);
+        result.swap(ev_grid.back());
+        return;
+    }
+
     std::vector<gsMatrix<T> > values[d];
 
     gsVector<unsigned, d> v, size;
@@ -641,6 +866,13 @@ void gsTensorBasis<d,T>::evalAllDers_into(const gsMatrix<T> & u, int n,
         return;
     }
 
+    std::vector<gsMatrix<T> > grid;
+    if ( u.cols() > 1 && isGrid(u, grid) )
+    {
+        evalGrid_into(grid, NULL, n, true, result);
+        return;
+    }
+
     std::vector< gsMatrix<T> >values[d];
     gsVector<unsigned, d> v, nb_cwise;
     result.resize(n+1);
@@ -730,6 +962,14 @@ template<short_t d, class T>
 void gsTensorBasis<d,T>::deriv2_into(const gsMatrix<T> & u,
                                            gsMatrix<T> & result ) const
 {
+    std::vector<gsMatrix<T> > grid, ev_grid;
+    if ( u.cols() > 1 && isGrid(u, grid) )
+    {
+        evalGrid_into(grid, NULL, 2, false, ev_grid);
+        result.swap(ev_grid.back());
+        return;
+    }
+
     std::vector< gsMatrix<T> >values[d];
     gsVector<unsigned, d> v, nb_cwise;
 
@@ -17,52 +17,224 @@
 #include <omp.h>
 #endif
 
+#include <gsCore/gsForwardDeclarations.h>
+#include <cstdint>
+#include <memory>
+
+/// Size (in bytes) of a cache line, used for padding per-thread data
+#define GISMO_CACHE_LINE 64
+
 namespace gismo
 {
 
 namespace util
 {
 
+/// Summation, used as the default operation in gsThreaded::reduce
+/// and gsThreaded::combine. Empty (unused) matrices are skipped.
+struct gsThreadedSum
+{
+    template<class C> void operator()(C & res, C & other) const
+    { res += other; }
+
+    template<class T, int R, int C, int O>
+    void operator()(gsMatrix<T,R,C,O> & res, gsMatrix<T,R,C,O> & other) const
+    {
+        if (0==other.size()) return;
+        if (0==res.size()) res.swap(other);
+        else res += other;
+    }
+
+    template<class T, int O, class I>
+    void operator()(gsSparseMatrix<T,O,I> & res, gsSparseMatrix<T,O,I> & other) const
+    {
+        if (0==other.size()) return;
+        if (0==res.size()) res.swap(other);
+        else res += other;
+    }
+};
+
 // Usage:
 // gsThreaded<C> a;
 // a.mine();
+//
+// The data of each thread is allocated and value-initialized by the
+// thread itself on its first access (first touch) and is padded to
+// full cache lines, so that the threads do not share cache lines.
 template<class C, class Allocator = std::allocator<C> >
 class gsThreaded
 {
 #ifdef _OPENMP
-    std::vector<C,Allocator> m_array;
-    #else
+    // Storage of a thread, padded to (at least) one cache line
+    struct _slot
+    {
+        C c;
+        char pad[GISMO_CACHE_LINE - sizeof(C) % GISMO_CACHE_LINE];
+        _slot() : c() { }
+        explicit _slot(const C & other) : c(other) { }
+    };
+
+    typedef typename std::allocator_traits<Allocator>::template
+    rebind_alloc<char> CharAllocator;
+
+    // Raw allocations and the aligned slots within them
+    std::vector<char*>  m_raw;
+    std::vector<_slot*> m_array;
+    CharAllocator m_alloc;
+#else
     C m_c;
 #endif
 
 public:
 
 #ifdef _OPENMP
-    gsThreaded() : m_array(omp_get_max_threads()) { }
+    gsThreaded() : m_raw(omp_get_max_threads(), nullptr),
+                   m_array(omp_get_max_threads(), nullptr) { }
+
+    gsThreaded(const gsThreaded & other)
+    : m_raw(other.m_array.size(), nullptr),
+      m_array(other.m_array.size(), nullptr)
+    {
+        for (size_t i = 0; i != m_array.size(); ++i)
+            if (nullptr!=other.m_array[i])
+                create(i, other.m_array[i]->c);
+    }
+
+    gsThreaded(gsThreaded && other)
+    : m_raw(give(other.m_raw)), m_array(give(other.m_array)) { }
+
+    gsThreaded & operator=(gsThreaded other)
+    {
+        m_raw.swap(other.m_raw);
+        m_array.swap(other.m_array);
+        return *this;
+    }
+
+    ~gsThreaded() { clear(); }
 
     /// Casting to the local data
-    operator C&()             { return m_array[omp_get_thread_num()]; }
-    operator const C&() const { return m_array[omp_get_thread_num()]; }
+    operator C&()             { return mine(); }
+    operator const C&() const { return mine(); }
 
     /// Returning the local data
-    C&       mine() { return m_array[omp_get_thread_num()]; }
-    const C& mine() const { return m_array[omp_get_thread_num()]; }
+    C&       mine()       { return (*this)[omp_get_thread_num()]; }
+    const C& mine() const { return (*this)[omp_get_thread_num()]; }
 
     /// Assigning to the local data
-    C& operator = (C other) { return m_array[omp_get_thread_num()] = give(other); }
+    C& operator = (C other) { return mine() = give(other); }
+
+    /// Returns the number of thread-local copies
+    size_t size() const { return m_array.size(); }
+
+    /// Returns true if the data of thread \a i has been accessed
+    bool touched(size_t i) const { return nullptr!=m_array[i]; }
+
+    /// Returns the data of thread \a i
+    C & operator[](size_t i)
+    {
+        GISMO_ASSERT(i<m_array.size(), "Thread number exceeds the "
+                     "number of threads at construction time");
+        if (nullptr==m_array[i]) create(i);
+        return m_array[i]->c;
+    }
+    const C & operator[](size_t i) const
+    { return const_cast<gsThreaded&>(*this)[i]; }
+
+    /// Releases the data of all threads
+    void clear()
+    {
+        for (size_t i = 0; i != m_array.size(); ++i)
+            release(i);
+    }
 #else
+    gsThreaded() : m_c() { }
+
     /// Casting to the local data
     operator C&()             { return m_c; }
     operator const C&() const { return m_c; }
-    
+
     /// Returning the local data
     C&       mine() { return m_c; }
     const C& mine() const { return m_c; }
-    
+
     /// Assigning to the local data
     C& operator = (C other) { return m_c = give(other); }
+
+    size_t size() const { return 1; }
+    bool touched(size_t) const { return true; }
+    C & operator[](size_t) { return m_c; }
+    const C & operator[](size_t) const { return m_c; }
+    void clear() { m_c = C(); }
 #endif
-    
+
+    /// \brief Merges the data of all threads into \a res by calling
+    /// \a op(res, data) for each thread that accessed its data, and
+    /// releases the thread-local data. To be called outside of parallel
+    /// regions (or by a single thread).
+    template<class Op>
+    void reduce(C & res, Op op)
+    {
+        for (size_t i = 0; i != size(); ++i)
+            if (touched(i))
+                op(res, (*this)[i]);
+        clear();
+    }
+
+    void reduce(C & res) { reduce(res, gsThreadedSum()); }
+
+    /// \brief Merges the data of all threads into the data of thread 0
+    /// by a pairwise (tree) reduction using \a op(data, otherData) in
+    /// log2(number of threads) steps. Must be called by all threads of
+    /// the team inside a parallel region; the merged data is returned
+    /// on all threads.
+    template<class Op>
+    C & combine(Op op)
+    {
+#       ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+        const int nt  = omp_get_num_threads();
+        C & res = (*this)[tid];
+        for (int s = 1; s < nt; s *= 2)
+        {
+#           pragma omp barrier
+            if ( 0 == tid % (2*s) && tid + s < nt )
+            {
+                op(res, (*this)[tid+s]);
+                release(tid+s);
+            }
+        }
+#       pragma omp barrier
+#       else
+        GISMO_UNUSED(op);
+#       endif
+        return (*this)[0];
+    }
+
+    C & combine() { return combine(gsThreadedSum()); }
+
+#ifdef _OPENMP
+private:
+    // Allocates the slot of thread \a i, aligned to a cache line
+    char * allocate(size_t i)
+    {
+        m_raw[i] = m_alloc.allocate(sizeof(_slot)+GISMO_CACHE_LINE);
+        return m_raw[i] + GISMO_CACHE_LINE -
+            reinterpret_cast<std::uintptr_t>(m_raw[i]) % GISMO_CACHE_LINE;
+    }
+
+    void create(size_t i)                  { m_array[i] = new (allocate(i)) _slot(); }
+    void create(size_t i, const C & other) { m_array[i] = new (allocate(i)) _slot(other); }
+
+    void release(size_t i)
+    {
+        if (nullptr==m_array[i]) return;
+        m_array[i]->~_slot();
+        m_alloc.deallocate(m_raw[i], sizeof(_slot)+GISMO_CACHE_LINE);
+        m_array[i] = nullptr;
+        m_raw[i]   = nullptr;
+    }
+#endif
+
 };//gsThreaded
 
 }//util
@@ -15,6 +15,8 @@
 
 #include <sstream>
 #include <numeric>
+#include <functional>
+#include <type_traits>
 
 #include <gsCore/gsExport.h>
 #include <gsCore/gsDebug.h>
@@ -259,13 +261,33 @@ public:
     }
 };
 
+/// \brief Mixes the hash key \a v into the hash key \a seed
+inline void hash_combine(size_t & seed, const size_t v)
+{
+    seed ^= v + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/// \brief Hash key of the number \a v, such that equal numbers have
+/// equal keys (in particular 0 and -0). Provided for the arithmetic
+/// types; further number types may overload it and specialize
+/// has_hash_value.
+template<typename T>
+size_t hash_value(const T v)
+{
+    return std::hash<T>()( v == T(0) ? T(0) : v );
+}
+
+/// \brief True if hash_value() is available for the number type \a T
+template<typename T>
+struct has_hash_value : std::is_arithmetic<T> { };
+
 /// \brief Create hash key for a rangle of (integral) numbers
 template<typename T>
 size_t hash_range(T const * start, const T * const end)
 {
     size_t seed = end - start;
     for(; start!=end; ++start) 
-        seed ^= *start + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        hash_combine(seed, *start);
     return seed;
 }
 
@@ -0,0 +1,101 @@
+/** @file gsFitting_test.cpp
+
+    @brief Tests the least squares fitting, the (parallel) assembly of
+    its system and the reuse of the previous fit.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+    Author(s): G+Smo contributors
+**/
+
+#include "gismo_unittest.h"
+
+SUITE(gsFitting_test)
+{
+    struct inputs
+    {
+        gsTensorBSplineBasis<2,real_t> basis;
+        gsMatrix<real_t> params, points;
+
+        // Points of the surface (u, v, u^2 v), which is in the span of the basis
+        inputs() : basis(gsKnotVector<real_t>(0,1,3,4), gsKnotVector<real_t>(0,1,3,4))
+        {
+            std::srand(1);
+            params = (gsMatrix<real_t>::Random(2, 2000).array() + 1) / 2;
+            points.resize(3, params.cols());
+            points.topRows(2) = params;
+            points.row(2) = params.row(0).array().square() * params.row(1).array();
+        }
+    };
+
+    TEST(assembleSystem)
+    {
+        inputs in;
+        gsFitting<real_t> fitter(in.params, in.points, in.basis);
+
+        gsSparseMatrix<real_t> A;
+        gsMatrix<real_t> B(in.basis.size(), 3);
+        B.setZero();
+        fitter.assembleSystem(A, B); // in parallel over blocks of points
+
+        // Reference: sum of the outer products of the basis values
+        gsMatrix<real_t> refA(in.basis.size(), in.basis.size()), refB(in.basis.size(), 3);
+        refA.setZero();
+        refB.setZero();
+        gsMatrix<real_t> val;
+        gsMatrix<index_t> act;
+        for (index_t k = 0; k != in.params.cols(); ++k)
+        {
+            in.basis.eval_into(in.params.col(k), val);
+            in.basis.active_into(in.params.col(k), act);
+            for (index_t i = 0; i != act.rows(); ++i)
+            {
+                refB.row(act(i,0)) += val(i,0) * in.points.col(k).transpose();
+                for (index_t j = 0; j != act.rows(); ++j)
+                    refA(act(i,0), act(j,0)) += val(i,0) * val(j,0);
+            }
+        }
+        CHECK( A.isCompressed() );
+        CHECK_MATRIX_CLOSE(refA, A.toDense(), 1e-10);
+        CHECK_MATRIX_CLOSE(refB, B, 1e-10);
+
+        // Assembling again into the pattern only adds the values
+        const index_t nnz = A.nonZeros();
+        fitter.assembleSystem(A, B);
+        CHECK_EQUAL(nnz, A.nonZeros());
+        CHECK_MATRIX_CLOSE(2*refA, A.toDense(), 1e-10);
+    }
+
+    TEST(compute_refit)
+    {
+        inputs in;
+        gsFitting<real_t> fitter(in.params, in.points, in.basis);
+
+        // refit() without a previous fit is a fresh fit
+        fitter.refit();
+        CHECK( nullptr != fitter.result() );
+        fitter.computeMaxNormErrors();
+        CHECK( fitter.maxPointError() < 1e-8 );
+
+        // Move the parameters: the refit reuses the previous fit
+        gsMatrix<real_t> & par = fitter.returnParamValues();
+        par = (par + 0.01 * gsMatrix<real_t>::Random(2, par.cols()))
+            .cwiseMax(0).cwiseMin(1);
+        fitter.refit();
+        CHECK( nullptr != fitter.result() );
+
+        gsFitting<real_t> fresh(par, in.points, in.basis);
+        fresh.compute();
+        CHECK_MATRIX_CLOSE(fresh.result()->coefs(), fitter.result()->coefs(), 1e-6);
+
+        // The smoothing weight of the last compute() is kept
+        fitter.compute(1e-4);
+        fitter.refit();
+        fresh.compute(1e-4);
+        CHECK_MATRIX_CLOSE(fresh.result()->coefs(), fitter.result()->coefs(), 1e-6);
+    }
+}
@@ -237,4 +237,30 @@ SUITE(gsParametrization_test)
         CHECK_CLOSE(-0.089105, xyz(1, 70), eps);
         CHECK_CLOSE(0.75, xyz(2, 70), eps);
     }
+    TEST_FIXTURE(inputs, gsPeriodicParametrizationIterative)
+    {
+        gsMatrix<real_t> stitch;
+        gsFileData<real_t> fd_stitch("parametrization/powerplant-stitch.xml");
+        fd_stitch.getFirst<gsMatrix<real_t> >(stitch);
+
+        gsPeriodicStitch<real_t> direct(*mesh,
+                                        verticesV0, paramsV0,
+                                        verticesV1, paramsV1,
+                                        stitch, options);
+        direct.compute();
+
+        // The iterative solver has to reproduce the direct solution,
+        // also when it is warm-started from a previous solution.
+        options.addString("solver", "solver", "BiCGSTABILUT");
+        options.addReal("precision", "precision", 1e-12);
+        gsPeriodicStitch<real_t> iterative(*mesh,
+                                           verticesV0, paramsV0,
+                                           verticesV1, paramsV1,
+                                           stitch, options);
+        for (index_t k = 0; k != 2; ++k)
+        {
+            iterative.compute();
+            CHECK( (direct.createUVmatrix() - iterative.createUVmatrix()).norm() < eps );
+        }
+    }
 }
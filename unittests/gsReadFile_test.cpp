@@ -86,6 +86,72 @@ TEST(Obj_ref_not_in_file)
     CHECK((basis.size() == 0));
 }
 
+// Numeric data written in binary encodings must be read back exactly
+TEST(binary_encoding)
+{
+    const std::string path = gsFileManager::getTempPath()
+        + gsFileManager::getNativePathSeparator() + "binary_encoding.xml";
+
+    gsKnotVector<> kv(0, 1, 3, 3);
+    gsTensorBSpline<2> geo = *gsNurbsCreator<>::BSplineSquare(1, 0, 0);
+    geo.uniformRefine(3);
+    geo.coefs().setRandom();
+    gsMatrix<> mat(3, 5);
+    mat.setRandom();
+    gsSparseMatrix<> spm(4, 6);
+    spm.insert(0, 1) = 1.0 / 3;
+    spm.insert(3, 5) = -2.5e-7;
+
+    const char * enc[3] = {"ascii", "base64", "zlib"};
+    for (int i = 0; i != 3; ++i)
+    {
+        gsFileData<> fd;
+        fd.setEncoding(enc[i]);
+        fd << kv;
+        fd << geo;
+        fd << mat;
+        fd << spm;
+        fd.save(path);
+
+        gsFileData<> fr(path);
+        gsKnotVector<> kv2;
+        fr.getFirst(kv2);
+        CHECK( kv == kv2 );
+        gsTensorBSpline<2>::uPtr geo2 = fr.getFirst< gsTensorBSpline<2> >();
+        gsMatrix<> mat2;
+        fr.getFirst(mat2);
+        gsSparseMatrix<> spm2;
+        fr.getFirst(spm2);
+
+        // text uses a precision of 16 digits
+        const real_t tol = i ? 0 : 1e-14;
+        CHECK( (geo2->coefs() - geo.coefs()).cwiseAbs().maxCoeff() <= tol );
+        CHECK( (mat2 - mat).cwiseAbs().maxCoeff() <= tol );
+        CHECK( spm2.nonZeros() == 2 );
+        CHECK( (spm2 - spm).toDense().cwiseAbs().maxCoeff() <= tol );
+    }
+    std::remove(path.c_str());
+}
+
+TEST(text_parser)
+{
+    const char * str = " 1 -2.5e3\n+0.125 1/4 12345678901234567890 1e-320 x";
+    const real_t expected[6] = {1, -2500, 0.125, 0.25, 12345678901234567890.0, 1e-320};
+    real_t val;
+    for (int i = 0; i != 6; ++i)
+    {
+        CHECK( gsReadValue(str, val) );
+        CHECK_EQUAL( expected[i], val );
+    }
+    CHECK( !gsReadValue(str, val) );
+
+    const char * istr = "7 -12";
+    index_t ival;
+    CHECK( gsReadValue(istr, ival) && 7 == ival );
+    CHECK( gsReadValue(istr, ival) && -12 == ival );
+    CHECK( !gsReadValue(istr, ival) );
+}
+
 // Tests for the constructors that take use of casts
 /*TEST(Obj_uPtr)
 {
@@ -208,4 +208,113 @@ SUITE(gsThbs_geometry_test)
 
     }
 
+    TEST(gsThbs_incremental_refinement)
+    {
+        // Many small refinement steps are applied to the basis; after
+        // each step the (incrementally updated) basis is compared with a
+        // copy which is rebuilt from scratch
+        srand(17);
+        gsKnotVector<> kv(0, 1, 7, 3, 1);
+        gsTensorBSplineBasis<2> tbasis(kv, kv);
+        gsTHBSplineBasis<2> THB(tbasis);
+
+        const gsMatrix<> para = THB.support();
+        const gsVector<> c0 = para.col(0), c1 = para.col(1);
+        gsMatrix<> pts = uniformPointGrid(c0, c1, 400);
+        std::vector<index_t> box(5), renumbering;
+        for (int step = 0; step < 20; ++step)
+        {
+            // a random box of 1 to 3 elements on level 1..3, which may
+            // extend beyond the domain (as with refinement extensions)
+            const index_t lvl = 1 + rand()%3;
+            const index_t nEl = 8 << lvl;
+            box[0] = lvl;
+            box[1] = rand()%(nEl-1);
+            box[2] = rand()%(nEl-1);
+            box[3] = box[1] + 1 + rand()%3;
+            box[4] = box[2] + 1 + rand()%3;
+
+            const gsTHBSplineBasis<2> old(THB);
+            THB.refineElements_withRenumbering(box, renumbering);
+
+            gsTHBSplineBasis<2> ref(THB);
+            ref.unrefineElements(std::vector<index_t>()); // full update
+            CHECK_EQUAL(ref.size(), THB.size());
+            if (ref.size() != THB.size()) break;
+            for (index_t i = 0; i != THB.size(); ++i)
+            {
+                CHECK_EQUAL(ref.levelOf(i), THB.levelOf(i));
+                CHECK_EQUAL(ref.flatTensorIndexOf(i), THB.flatTensorIndexOf(i));
+            }
+            CHECK_MATRIX_CLOSE(ref.eval(pts), THB.eval(pts), 1e-12);
+
+            // the kept functions are mapped to themselves
+            CHECK_EQUAL((size_t)old.size(), renumbering.size());
+            for (index_t i = 0; i != old.size(); ++i)
+            {
+                if (-1 == renumbering[i])
+                    continue;
+                CHECK_EQUAL(old.levelOf(i), THB.levelOf(renumbering[i]));
+                CHECK_EQUAL(old.flatTensorIndexOf(i),
+                            THB.flatTensorIndexOf(renumbering[i]));
+            }
+        }
+
+        // Refining by parameter boxes sinks all levels inside the box
+        gsMatrix<> pbox(2, 2);
+        for (int step = 0; step < 5; ++step)
+        {
+            pbox.col(0).setRandom();
+            pbox.col(0) = (pbox.col(0).array() + 1) / 3;
+            pbox.col(1) = pbox.col(0).array() + 0.2;
+            THB.refine(pbox);
+
+            gsTHBSplineBasis<2> ref(THB);
+            ref.unrefineElements(std::vector<index_t>()); // full update
+            CHECK_EQUAL(ref.size(), THB.size());
+            CHECK_MATRIX_CLOSE(ref.eval(pts), THB.eval(pts), 1e-12);
+        }
+    }
+
+    TEST(gsThbs_active_batched)
+    {
+        // The active functions of all quadrature nodes of an element,
+        // computed together, agree with the ones of the single nodes
+        srand(5);
+        gsKnotVector<> kv(0, 1, 7, 3, 1);
+        gsTensorBSplineBasis<2> tbasis(kv, kv);
+        gsTHBSplineBasis<2> THB(tbasis);
+        std::vector<index_t> box(5);
+        for (int step = 0; step < 10; ++step)
+        {
+            const index_t lvl = 1 + rand()%3;
+            const index_t nEl = 8 << lvl;
+            box[0] = lvl;
+            box[1] = rand()%(nEl-1);
+            box[2] = rand()%(nEl-1);
+            box[3] = box[1] + 1 + rand()%4;
+            box[4] = box[2] + 1 + rand()%4;
+            THB.refineElements(box);
+        }
+
+        gsVector<index_t> numNodes(2);
+        numNodes.setConstant(3);
+        gsGaussRule<> qr(numNodes);
+        gsMatrix<> nodes;
+        gsVector<> weights;
+        gsMatrix<index_t> actives, act;
+        gsHDomainIterator<real_t,2> domIt(THB);
+        for (; domIt.good(); domIt.next())
+        {
+            qr.mapTo(domIt.lowerCorner(), domIt.upperCorner(), nodes, weights);
+            THB.active_into(nodes, actives);
+            for (index_t p = 0; p != nodes.cols(); ++p)
+            {
+                THB.active_into(nodes.col(p), act);
+                CHECK(act.col(0) == actives.col(p).topRows(act.rows()));
+                CHECK(actives.col(p).bottomRows(actives.rows()-act.rows()).isZero());
+            }
+        }
+    }
+
 }